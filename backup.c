@@ -0,0 +1,485 @@
+#define _GNU_SOURCE
+#include "backup.h"
+#include "crc32c.h"
+#include "lz.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// copy_file_range kullanılamadığında kopyalama bu boyutta parçalarla yapılır
+#define BACKUP_COPY_SIZE (256 * 1024)
+
+// Yedeklemede her iş parçacığı için sırası gelmemiş en fazla bu kadar parça bekletilir
+#define BACKUP_WINDOW_PER_WORKER 4
+
+static uint32_t header_checksum(const BackupHeader* header) {
+    BackupHeader copy = *header;
+    copy.checksum = 0;
+    return crc32c(0, &copy, sizeof(copy));
+}
+
+static int write_all(int fd, const void* data, size_t size) {
+    const char* p = data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static int pread_all(int fd, void* buffer, size_t size, off_t offset) {
+    char* p = buffer;
+    while (size > 0) {
+        ssize_t n = pread(fd, p, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        offset += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static int pwrite_all(int fd, const void* data, size_t size, off_t offset) {
+    const char* p = data;
+    while (size > 0) {
+        ssize_t n = pwrite(fd, p, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        offset += n;
+        size -= n;
+    }
+    return 0;
+}
+
+// 'in_fd' içindeki 'in_offset' konumundan 'size' baytı 'out_fd'de 'out_offset' konumuna
+// aktar. Veri önce çekirdek içinde kopyalanmaya çalışılır; desteklenmiyorsa büyük bir
+// tamponla pread/pwrite yapılır.
+static int copy_range(int in_fd, off_t in_offset, int out_fd, off_t out_offset, size_t size) {
+    while (size > 0) {
+        ssize_t n = copy_file_range(in_fd, &in_offset, out_fd, &out_offset, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        size -= n;
+    }
+    if (size == 0) return 0;
+
+    size_t chunk = size < BACKUP_COPY_SIZE ? size : BACKUP_COPY_SIZE;
+    char* buffer = malloc(chunk);
+    if (!buffer) return -1;
+    int result = 0;
+    while (size > 0 && result == 0) {
+        size_t n = size < chunk ? size : chunk;
+        if (pread_all(in_fd, buffer, n, in_offset) < 0 || pwrite_all(out_fd, buffer, n, out_offset) < 0) result = -1;
+        in_offset += n;
+        out_offset += n;
+        size -= n;
+    }
+    free(buffer);
+    return result;
+}
+
+static bool all_zero(const uint8_t* data, size_t size) {
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        if (word) return false;
+    }
+    for (; i < size; i++) {
+        if (data[i]) return false;
+    }
+    return true;
+}
+
+// Parçaları işleyen iş parçacığı havuzu. İşler sırayla dağıtılır; 'consume' verilmişse
+// ana iş parçacığı biten işleri sırayla tüketir (yedek dosyasına yazar) ve henüz
+// tüketilmemiş iş sayısı 'window' ile sınırlanır.
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    int job_count;
+    int next_job; // Sıradaki dağıtılacak iş
+    int consumed; // Tüketilen iş sayısı
+    int window;
+    bool* finished;
+    bool failed;
+    int (*process)(void* context, int job, int worker);
+    void* context;
+} ChunkPool;
+
+typedef struct {
+    ChunkPool* pool;
+    int worker;
+} PoolWorker;
+
+static void pool_work(ChunkPool* pool, int worker) {
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (!pool->failed && pool->next_job < pool->job_count && pool->next_job >= pool->consumed + pool->window) {
+            pthread_cond_wait(&pool->changed, &pool->mutex);
+        }
+        if (pool->failed || pool->next_job >= pool->job_count) break;
+        int job = pool->next_job++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        int result = pool->process(pool->context, job, worker);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (result < 0) pool->failed = true;
+        pool->finished[job] = true;
+        pthread_cond_broadcast(&pool->changed);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static void* pool_thread(void* arg) {
+    PoolWorker* worker = arg;
+    pool_work(worker->pool, worker->worker);
+    return NULL;
+}
+
+// İş sayısına ve işlemci sayısına göre kullanılacak iş parçacığı sayısı
+static int worker_count(int job_count) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = cpus < 1 ? 1 : cpus > BACKUP_MAX_WORKERS ? BACKUP_MAX_WORKERS : (int) cpus;
+    return workers < job_count ? workers : (job_count > 0 ? job_count : 1);
+}
+
+// 'workers' iş parçacığıyla tüm işleri çalıştır. İş parçacığı oluşturulamazsa işler
+// ana iş parçacığında sırayla yapılır.
+static int pool_run(ChunkPool* pool, int workers, int (*consume)(void* context, int job)) {
+    pthread_t threads[BACKUP_MAX_WORKERS];
+    PoolWorker args[BACKUP_MAX_WORKERS];
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->changed, NULL);
+    pool->next_job = 0;
+    pool->consumed = 0;
+    pool->failed = false;
+
+    // Tüketici yoksa ana iş parçacığı da işçi olarak çalışır (0 numaralı işçi)
+    int first = consume ? 0 : 1;
+    int started = 0;
+    while (first + started < workers) {
+        args[started].pool = pool;
+        args[started].worker = first + started;
+        if (pthread_create(&threads[started], NULL, pool_thread, &args[started]) != 0) break;
+        started++;
+    }
+
+    if (!consume) {
+        pool_work(pool, 0);
+    } else if (started == 0) {
+        for (int job = 0; job < pool->job_count && !pool->failed; job++) {
+            if (pool->process(pool->context, job, 0) < 0 || consume(pool->context, job) < 0) pool->failed = true;
+        }
+    } else {
+        for (int job = 0; job < pool->job_count; job++) {
+            pthread_mutex_lock(&pool->mutex);
+            while (!pool->finished[job] && !pool->failed) pthread_cond_wait(&pool->changed, &pool->mutex);
+            bool failed = pool->failed;
+            pthread_mutex_unlock(&pool->mutex);
+            if (failed) break;
+
+            int result = consume(pool->context, job);
+
+            pthread_mutex_lock(&pool->mutex);
+            if (result < 0) pool->failed = true;
+            pool->consumed++;
+            pthread_cond_broadcast(&pool->changed);
+            pthread_mutex_unlock(&pool->mutex);
+            if (result < 0) break;
+        }
+    }
+
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    pthread_cond_destroy(&pool->changed);
+    pthread_mutex_destroy(&pool->mutex);
+    return pool->failed ? -1 : 0;
+}
+
+typedef struct {
+    BackupChunk chunk;
+    off_t offset; // Geri yüklemede parça verisinin yedek dosyasındaki konumu
+} ChunkJob;
+
+// Yedekleme durumu: her pencere yuvasında bir parçanın okunan ve sıkıştırılan verisi tutulur
+typedef struct {
+    ChunkJob* jobs;
+    int window;
+    uint8_t* inputs;
+    uint8_t* outputs;
+    const uint8_t** stored; // Yuvadaki parçanın yazılacak verisi
+    int backup_fd;
+    int disk_fd;
+    const char* map;
+    BackupHeader* header;
+} BackupWriter;
+
+// Aralıkta hiç veri yoksa (tamamı seyrek dosyanın deliği) true
+static bool range_is_hole(int fd, off_t offset, size_t bytes) {
+    off_t data = lseek(fd, offset, SEEK_DATA);
+    if (data < 0) return errno == ENXIO;
+    return data >= offset + (off_t) bytes;
+}
+
+static int compress_chunk(void* context, int job, int worker) {
+    (void) worker;
+    BackupWriter* writer = context;
+    BackupChunk* chunk = &writer->jobs[job].chunk;
+    int slot = job % writer->window;
+    size_t bytes = (size_t) chunk->length * writer->header->block_size;
+    off_t offset = (off_t) chunk->start * writer->header->block_size;
+
+    // Disk imajında delik olan parça okunmadan boş parça olarak saklanır
+    if (range_is_hole(writer->disk_fd, offset, bytes)) {
+        chunk->method = BACKUP_CHUNK_ZERO;
+        chunk->stored_bytes = 0;
+        chunk->checksum = 0;
+        return 0;
+    }
+
+    // mmap modunda veri eşlemeden okunur; aksi halde yuvanın tamponuna alınır
+    const uint8_t* data = (const uint8_t*) writer->map + offset;
+    if (!writer->map) {
+        uint8_t* input = writer->inputs + (size_t) slot * BACKUP_CHUNK_SIZE;
+        if (pread_all(writer->disk_fd, input, bytes, offset) < 0) return -1;
+        data = input;
+    }
+
+    if (all_zero(data, bytes)) {
+        chunk->method = BACKUP_CHUNK_ZERO;
+        chunk->stored_bytes = 0;
+        chunk->checksum = 0;
+        return 0;
+    }
+
+    chunk->checksum = crc32c(0, data, bytes);
+    uint8_t* output = writer->outputs + (size_t) slot * BACKUP_CHUNK_SIZE;
+    int compressed = lz_compress(data, (int) bytes, output, (int) bytes);
+    if (compressed > 0) {
+        chunk->method = BACKUP_CHUNK_LZ;
+        chunk->stored_bytes = compressed;
+        writer->stored[slot] = output;
+    } else {
+        chunk->method = BACKUP_CHUNK_RAW;
+        chunk->stored_bytes = bytes;
+        writer->stored[slot] = data;
+    }
+    return 0;
+}
+
+static int write_chunk(void* context, int job) {
+    BackupWriter* writer = context;
+    BackupChunk* chunk = &writer->jobs[job].chunk;
+    if (write_all(writer->backup_fd, chunk, sizeof(*chunk)) < 0 ||
+        (chunk->stored_bytes > 0 && write_all(writer->backup_fd, writer->stored[job % writer->window], chunk->stored_bytes) < 0)) {
+        return -1;
+    }
+    writer->header->record_count++;
+    writer->header->data_bytes += (uint64_t) chunk->length * writer->header->block_size;
+    return 0;
+}
+
+// Yedek dosyasını oluştur; başlık için yer ayrılır, asıl başlık backup_finish'te yazılır
+int backup_create(const char* path, BackupHeader* header) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) return -1;
+
+    header->magic = BACKUP_MAGIC;
+    header->version = BACKUP_VERSION;
+    header->record_count = 0;
+    header->data_bytes = 0;
+    if (lseek(fd, sizeof(BackupHeader), SEEK_SET) != (off_t) sizeof(BackupHeader)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Blok dizilerini parçalara bölüp paralel sıkıştırarak yedeğe ekle. 'map' verilmişse
+// (mmap modu) veri eşlemeden okunur.
+int backup_write(int fd, BackupHeader* header, int disk_fd, const char* map, const BackupRun* runs, int run_count) {
+    uint32_t chunk_blocks = BACKUP_CHUNK_SIZE / header->block_size;
+    if (chunk_blocks == 0) return -1;
+
+    int job_count = 0;
+    for (int i = 0; i < run_count; i++) job_count += (runs[i].length + chunk_blocks - 1) / chunk_blocks;
+    if (job_count == 0) return 0;
+
+    int workers = worker_count(job_count);
+    int window = workers * BACKUP_WINDOW_PER_WORKER;
+    if (window > job_count) window = job_count;
+
+    BackupWriter writer = {0};
+    ChunkPool pool = {0};
+    writer.jobs = calloc(job_count, sizeof(ChunkJob));
+    writer.outputs = malloc((size_t) window * BACKUP_CHUNK_SIZE);
+    writer.inputs = map ? NULL : malloc((size_t) window * BACKUP_CHUNK_SIZE);
+    writer.stored = calloc(window, sizeof(uint8_t*));
+    pool.finished = calloc(job_count, sizeof(bool));
+
+    int result = -1;
+    if (writer.jobs && writer.outputs && (map || writer.inputs) && writer.stored && pool.finished) {
+        int job = 0;
+        for (int i = 0; i < run_count; i++) {
+            for (uint32_t done = 0; done < runs[i].length; done += chunk_blocks) {
+                writer.jobs[job].chunk.start = runs[i].start + done;
+                writer.jobs[job].chunk.length = runs[i].length - done < chunk_blocks ? runs[i].length - done : chunk_blocks;
+                job++;
+            }
+        }
+
+        writer.window = window;
+        writer.backup_fd = fd;
+        writer.disk_fd = disk_fd;
+        writer.map = map;
+        writer.header = header;
+        pool.job_count = job_count;
+        pool.window = window;
+        pool.process = compress_chunk;
+        pool.context = &writer;
+        result = pool_run(&pool, workers, write_chunk);
+    }
+
+    free(pool.finished);
+    free(writer.stored);
+    free(writer.inputs);
+    free(writer.outputs);
+    free(writer.jobs);
+    return result;
+}
+
+// Başlığı yaz, yedeği diske indir ve dosyayı kapat; yedek dosyasının boyutunu döner
+int64_t backup_finish(int fd, BackupHeader* header) {
+    header->checksum = header_checksum(header);
+    off_t size = lseek(fd, 0, SEEK_END);
+    int64_t result = size;
+    if (size < 0 || pwrite(fd, header, sizeof(*header), 0) != sizeof(*header) || fdatasync(fd) != 0) result = -1;
+    close(fd);
+    return result;
+}
+
+// Başlığı oku ve doğrula: 0 = geçerli yedek, 1 = başlıksız ham disk imajı, -1 = bozuk
+int backup_read_header(int fd, BackupHeader* header) {
+    ssize_t n = pread(fd, header, sizeof(*header), 0);
+    if (n < (ssize_t) sizeof(uint32_t) || header->magic != BACKUP_MAGIC) return n < 0 ? -1 : 1;
+    if (n != sizeof(*header) || header->version < 1 || header->version > BACKUP_VERSION ||
+        header->checksum != header_checksum(header) || header->block_size == 0) {
+        return -1;
+    }
+    header->parent[BACKUP_PATH_LEN - 1] = '\0';
+    return 0;
+}
+
+// Geri yükleme durumu: her işçinin kendi okuma ve çözme tamponu vardır
+typedef struct {
+    ChunkJob* jobs;
+    uint8_t* buffers; // İşçi başına 2 * BACKUP_CHUNK_SIZE
+    int backup_fd;
+    int disk_fd;
+    uint32_t block_size;
+} BackupReader;
+
+static int restore_chunk(void* context, int job, int worker) {
+    BackupReader* reader = context;
+    const ChunkJob* item = &reader->jobs[job];
+    size_t bytes = (size_t) item->chunk.length * reader->block_size;
+    off_t offset = (off_t) item->chunk.start * reader->block_size;
+    uint8_t* stored = reader->buffers + (size_t) worker * 2 * BACKUP_CHUNK_SIZE;
+    uint8_t* data = stored + BACKUP_CHUNK_SIZE;
+
+    if (item->chunk.method == BACKUP_CHUNK_ZERO) {
+        // Dosyada delik açılabiliyorsa alan sıfır yazmadan boşaltılır
+        if (fallocate(reader->disk_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, bytes) == 0) return 0;
+        memset(data, 0, bytes);
+        return pwrite_all(reader->disk_fd, data, bytes, offset);
+    }
+
+    if (item->chunk.method == BACKUP_CHUNK_RAW) {
+        if (pread_all(reader->backup_fd, data, bytes, item->offset) < 0) return -1;
+    } else if (pread_all(reader->backup_fd, stored, item->chunk.stored_bytes, item->offset) < 0 ||
+               lz_decompress(stored, item->chunk.stored_bytes, data, (int) bytes) < 0) {
+        return -1;
+    }
+    if (crc32c(0, data, bytes) != item->chunk.checksum) return -1;
+    return pwrite_all(reader->disk_fd, data, bytes, offset);
+}
+
+// Sürüm 1: sıkıştırılmamış blok dizileri sırayla kopyalanır
+static int64_t apply_runs(int fd, const BackupHeader* header, int disk_fd) {
+    off_t position = sizeof(BackupHeader);
+    uint64_t total_blocks = header->disk_size / header->block_size;
+
+    for (uint32_t i = 0; i < header->record_count; i++) {
+        BackupRun run;
+        if (pread_all(fd, &run, sizeof(run), position) < 0) return -1;
+        position += sizeof(run);
+        if ((uint64_t) run.start + run.length > total_blocks) return -1;
+
+        size_t bytes = (size_t) run.length * header->block_size;
+        if (copy_range(fd, position, disk_fd, (off_t) run.start * header->block_size, bytes) < 0) return -1;
+        position += bytes;
+    }
+    return (int64_t) header->data_bytes;
+}
+
+// Yedekteki parçaları diske yaz; yazılan bayt sayısını döner (-1 = hata). Parça kayıtları
+// önce sırayla okunup doğrulanır, ardından parçalar paralel çözülüp yerlerine yazılır.
+int64_t backup_apply(int fd, const BackupHeader* header, int disk_fd) {
+    if (header->version == 1) return apply_runs(fd, header, disk_fd);
+
+    uint64_t total_blocks = header->disk_size / header->block_size;
+    uint32_t chunk_blocks = BACKUP_CHUNK_SIZE / header->block_size;
+    int job_count = header->record_count;
+    if (job_count == 0) return 0;
+
+    BackupReader reader = {0};
+    ChunkPool pool = {0};
+    reader.jobs = calloc(job_count, sizeof(ChunkJob));
+    pool.finished = calloc(job_count, sizeof(bool));
+    int workers = worker_count(job_count);
+    reader.buffers = malloc((size_t) workers * 2 * BACKUP_CHUNK_SIZE);
+
+    int64_t result = -1;
+    off_t position = sizeof(BackupHeader);
+    bool valid = reader.jobs && pool.finished && reader.buffers;
+    for (int i = 0; i < job_count && valid; i++) {
+        BackupChunk* chunk = &reader.jobs[i].chunk;
+        if (pread_all(fd, chunk, sizeof(*chunk), position) < 0) {
+            valid = false;
+            break;
+        }
+        uint32_t bytes = chunk->length * header->block_size;
+        valid = chunk->length > 0 && chunk->length <= chunk_blocks && (uint64_t) chunk->start + chunk->length <= total_blocks &&
+                ((chunk->method == BACKUP_CHUNK_ZERO && chunk->stored_bytes == 0) ||
+                 (chunk->method == BACKUP_CHUNK_RAW && chunk->stored_bytes == bytes) ||
+                 (chunk->method == BACKUP_CHUNK_LZ && chunk->stored_bytes > 0 && chunk->stored_bytes < bytes));
+        reader.jobs[i].offset = position + sizeof(*chunk);
+        position += sizeof(*chunk) + chunk->stored_bytes;
+    }
+
+    if (valid) {
+        reader.backup_fd = fd;
+        reader.disk_fd = disk_fd;
+        reader.block_size = header->block_size;
+        pool.job_count = job_count;
+        pool.window = job_count;
+        pool.process = restore_chunk;
+        pool.context = &reader;
+        if (pool_run(&pool, workers, NULL) == 0) result = (int64_t) header->data_bytes;
+    }
+
+    free(reader.buffers);
+    free(pool.finished);
+    free(reader.jobs);
+    return result;
+}
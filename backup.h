@@ -0,0 +1,65 @@
+#ifndef BACKUP_H
+#define BACKUP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// Yedek dosyası: başlığın ardından parçalar (chunk) gelir. Her parça en fazla
+// BACKUP_CHUNK_SIZE baytlık ardışık bir blok dizisidir; bir BackupChunk kaydı ve
+// ardından parçanın sıkıştırılmış, ham ya da (tamamı sıfırsa) boş içeriğinden oluşur.
+// Tam yedek diskteki tüm dolu blokları, artımlı yedek ise üst nesilden sonra değişen
+// blokları ve metadata alanlarını içerir. Parçalar birbirinden bağımsız sıkıştırıldığı
+// için yedekleme ve geri yükleme bir iş parçacığı havuzunda paralel yapılır.
+// Sürüm 1 yedeklerde parçalar yerine sıkıştırılmamış BackupRun dizileri bulunur.
+#define BACKUP_MAGIC 0x42534653 // "SFSB"
+#define BACKUP_VERSION 2
+#define BACKUP_PATH_LEN 256
+
+#define BACKUP_CHUNK_SIZE (64 * 1024)
+#define BACKUP_MAX_WORKERS 8
+
+// Yedek bir önceki nesli temel alır; geri yüklerken önce 'parent' uygulanmalıdır
+#define BACKUP_INCREMENTAL 0x1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t chain_id;    // Aynı tam yedekten türeyen nesiller aynı kimliği taşır
+    uint32_t generation;  // Tam yedek 1, sonraki her artımlı yedek bir fazlası
+    uint32_t flags;
+    uint64_t disk_size;
+    uint32_t block_size;
+    uint32_t record_count; // Parça (sürüm 1'de dizi) sayısı
+    uint64_t data_bytes;   // Parçalardaki toplam veri (sıkıştırılmadan önce)
+    char parent[BACKUP_PATH_LEN]; // Artımlı yedeğin üst neslinin dosya yolu
+    uint32_t checksum;    // checksum alanı 0 iken başlığın CRC32C değeri
+    uint32_t reserved;
+} BackupHeader;
+
+typedef struct {
+    uint32_t start;  // İlk blok numarası
+    uint32_t length; // Blok sayısı
+} BackupRun;
+
+// Parça içeriğinin saklanma biçimi
+#define BACKUP_CHUNK_RAW 0
+#define BACKUP_CHUNK_LZ 1
+#define BACKUP_CHUNK_ZERO 2 // İçerik tamamen sıfır, veri saklanmaz
+
+typedef struct {
+    uint32_t start;        // İlk blok numarası
+    uint32_t length;       // Blok sayısı
+    uint32_t method;
+    uint32_t stored_bytes; // Kayıttan sonra gelen veri boyutu
+    uint32_t checksum;     // Sıkıştırılmamış içeriğin CRC32C değeri
+    uint32_t reserved;
+} BackupChunk;
+
+int backup_create(const char* path, BackupHeader* header);
+int backup_write(int fd, BackupHeader* header, int disk_fd, const char* map, const BackupRun* runs, int run_count);
+int64_t backup_finish(int fd, BackupHeader* header);
+int backup_read_header(int fd, BackupHeader* header);
+int64_t backup_apply(int fd, const BackupHeader* header, int disk_fd);
+
+#endif
@@ -0,0 +1,557 @@
+#include "batch.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fs.h"
+#include "oplog.h"
+
+// Komut sonucu: başarılı, başarısız ya da betiği sonlandır
+#define BATCH_OK 0
+#define BATCH_FAILED -1
+#define BATCH_EXIT 1
+#define BATCH_USAGE -2 // Geçersiz argüman; kullanım satırı yazdırılır
+
+typedef struct {
+    const char* name;
+    int min_args;
+    int max_args; // -1: sınırsız (kalan kelimeler veri olarak birleştirilir)
+    int (*run)(int argc, char* argv[]);
+    const char* usage;
+} BatchCommand;
+
+static int failure_count = 0;
+
+// Host dosyasının tamamını belleğe oku
+static char* read_host_file(const char* path, int* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Host dosyasi acilamadi: %s\n", path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size > INT_MAX) {
+        fprintf(stderr, "Host dosyasi cok buyuk ya da okunamadi: %s\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    char* data = malloc(st.st_size > 0 ? st.st_size : 1);
+    off_t done = 0;
+    while (data && done < st.st_size) {
+        ssize_t n = read(fd, data + done, st.st_size - done);
+        if (n <= 0) break;
+        done += n;
+    }
+    close(fd);
+    if (!data || done != st.st_size) {
+        fprintf(stderr, "Host dosyasi okunamadi: %s\n", path);
+        free(data);
+        return NULL;
+    }
+    *size = (int) done;
+    return data;
+}
+
+// Sayı argümanı: yalnızca rakamlardan oluşan, int'e sığan negatif olmayan bir değer
+static bool parse_count(const char* text, int* value) {
+    char* end;
+    errno = 0;
+    long parsed = isdigit((unsigned char) text[0]) ? strtol(text, &end, 10) : -1;
+    if (parsed < 0 || errno != 0 || *end != '\0' || parsed > INT_MAX) {
+        fprintf(stderr, "Gecersiz sayi: %s\n", text);
+        return false;
+    }
+    *value = (int) parsed;
+    return true;
+}
+
+// Veri argümanı: tek kelime '@' ile başlıyorsa host dosyasının içeriği, değilse kelimeler
+// boşlukla birleştirilir. Yalnızca ilk kelimenin başındaki "@@" kaçıştır ve tek '@' olur;
+// birden fazla kelimede tek '@' ile başlayan ilk kelime olduğu gibi kalır.
+static char* load_data(int argc, char* argv[], int* size) {
+    if (argc == 1 && argv[0][0] == '@' && argv[0][1] != '@') return read_host_file(argv[0] + 1, size);
+
+    size_t length = 0;
+    for (int i = 0; i < argc; i++) length += strlen(argv[i]) + 1;
+    char* data = malloc(length);
+    if (!data) return NULL;
+    size_t used = 0;
+    for (int i = 0; i < argc; i++) {
+        const char* word = (i == 0 && argv[0][0] == '@' && argv[0][1] == '@') ? argv[0] + 1 : argv[i];
+        if (i > 0) data[used++] = ' ';
+        memcpy(data + used, word, strlen(word));
+        used += strlen(word);
+    }
+    *size = (int) used;
+    return data;
+}
+
+static int cmd_create(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_create(argv[1]);
+    log_operation(LOG_OP_CREATE, argv[1], NULL, 0, started, result);
+    return result;
+}
+
+static int cmd_delete(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_delete(argv[1]);
+    log_operation(LOG_OP_DELETE, argv[1], NULL, 0, started, result);
+    return result;
+}
+
+static int write_or_append(int argc, char* argv[], bool append) {
+    int size = 0;
+    char* data = load_data(argc - 2, argv + 2, &size);
+    if (!data) return -1;
+
+    uint64_t started = log_clock();
+    int result;
+    if (size == 0) {
+        // Boş veri dosyayı boşaltır (yazma) ya da hiçbir şey yapmaz (ekleme)
+        result = append ? (fs_exists(argv[1]) ? 0 : -1) : fs_truncate(argv[1], 0);
+    } else {
+        result = append ? fs_append(argv[1], data, size) : fs_write(argv[1], data, size);
+    }
+    log_operation(append ? LOG_OP_APPEND : LOG_OP_WRITE, argv[1], NULL, size, started, result);
+    free(data);
+    return result;
+}
+
+static int cmd_write(int argc, char* argv[]) { return write_or_append(argc, argv, false); }
+
+static int cmd_append(int argc, char* argv[]) { return write_or_append(argc, argv, true); }
+
+// Dosya içeriği olduğu gibi (sona satır sonu eklenmeden) stdout'a aktarılır
+static int cmd_cat(int argc, char* argv[]) {
+    int file_size = fs_size(argv[1]);
+    if (file_size < 0) return -1;
+
+    int offset = 0, size = file_size;
+    if (argc == 4) {
+        if (!parse_count(argv[2], &offset) || !parse_count(argv[3], &size)) return BATCH_USAGE;
+        if (offset > file_size || size > file_size - offset) {
+            fprintf(stderr, "Gecersiz okuma parametreleri!\n");
+            return -1;
+        }
+    }
+    if (size == 0) return 0;
+
+    uint64_t started = log_clock();
+    int result = fs_read_to_fd(argv[1], offset, size, STDOUT_FILENO);
+    log_operation(LOG_OP_READ, argv[1], NULL, size, started, result);
+    return result;
+}
+
+static int cmd_import(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_import(argv[1], argv[2]);
+    log_operation(LOG_OP_IMPORT, argv[2], argv[1], result > 0 ? result : 0, started, result);
+    return result;
+}
+
+static int cmd_export(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_export(argv[1], argv[2]);
+    log_operation(LOG_OP_EXPORT, argv[1], argv[2], result > 0 ? result : 0, started, result);
+    return result;
+}
+
+static int cmd_mkdir(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_mkdir(argv[1]);
+    log_operation(LOG_OP_MKDIR, argv[1], NULL, 0, started, result);
+    return result;
+}
+
+static int cmd_rmdir(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_rmdir(argv[1]);
+    log_operation(LOG_OP_RMDIR, argv[1], NULL, 0, started, result);
+    return result;
+}
+
+static int cmd_ls(int argc, char* argv[]) {
+    uint64_t started = log_clock();
+    int result = fs_ls_dir(argc > 1 ? argv[1] : "/", argc > 2 ? argv[2] : NULL);
+    log_operation(LOG_OP_LIST, argc > 1 ? argv[1] : NULL, NULL, 0, started, result);
+    return result;
+}
+
+static int cmd_size(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int size = fs_size(argv[1]);
+    log_operation(LOG_OP_SIZE, argv[1], NULL, size > 0 ? size : 0, started, size);
+    if (size < 0) return -1;
+    printf("%d\n", size);
+    return 0;
+}
+
+static int cmd_rename(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_rename(argv[1], argv[2]);
+    log_operation(LOG_OP_RENAME, argv[1], argv[2], 0, started, result);
+    return result;
+}
+
+static int cmd_move(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_mv(argv[1], argv[2]);
+    log_operation(LOG_OP_MOVE, argv[1], argv[2], 0, started, result);
+    return result;
+}
+
+static int cmd_copy(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_copy(argv[1], argv[2]);
+    log_operation(LOG_OP_COPY, argv[1], argv[2], 0, started, result);
+    return result;
+}
+
+static int cmd_truncate(int argc, char* argv[]) {
+    (void) argc;
+    int new_size;
+    if (!parse_count(argv[2], &new_size)) return BATCH_USAGE;
+    uint64_t started = log_clock();
+    int result = fs_truncate(argv[1], new_size);
+    log_operation(LOG_OP_TRUNCATE, argv[1], NULL, new_size, started, result);
+    return result;
+}
+
+static int cmd_diff(int argc, char* argv[]) {
+    bool block_summary = argc > 3;
+    if (block_summary && strcmp(argv[3], "-b") != 0) {
+        fprintf(stderr, "Gecersiz secenek: %s\n", argv[3]);
+        return -1;
+    }
+    uint64_t started = log_clock();
+    int result = fs_diff_ex(argv[1], argv[2], block_summary, NULL);
+    log_operation(LOG_OP_DIFF, argv[1], argv[2], 0, started, result);
+    // Dosyaların farklı olması (1) hata değildir ve BATCH_EXIT ile karışmamalıdır
+    return result < 0 ? -1 : 0;
+}
+
+// Boyut argümanı: bayt sayısı, isteğe bağlı K, M ya da G son ekiyle (1024'ün kuvvetleri)
+static bool parse_size(const char* text, uint64_t* size) {
+    char* end = (char*) text;
+    errno = 0;
+    uint64_t value = isdigit((unsigned char) text[0]) ? strtoull(text, &end, 10) : 0;
+    const char* units = "KMG";
+    char suffix = (char) (*end & ~0x20);
+    const char* unit = end != text && suffix ? strchr(units, suffix) : NULL;
+    if (unit) {
+        for (const char* u = units; u <= unit; u++) {
+            if (value > UINT64_MAX / 1024) errno = ERANGE;
+            value *= 1024;
+        }
+        end++;
+    }
+    if (end == text || errno != 0 || *end != '\0') {
+        fprintf(stderr, "Gecersiz boyut: %s\n", text);
+        return false;
+    }
+    *size = value;
+    return true;
+}
+
+// format [KAPASITE [DISK_BOYUTU [BLOK_BOYUTU]]]; 0 verilen değer mevcut haliyle korunur
+static int cmd_format(int argc, char* argv[]) {
+    int max_files = 0;
+    uint64_t disk_size = 0, block_size = 0;
+    if ((argc >= 2 && !parse_count(argv[1], &max_files)) || (argc >= 3 && !parse_size(argv[2], &disk_size)) ||
+        (argc >= 4 && !parse_size(argv[3], &block_size))) {
+        return BATCH_USAGE;
+    }
+    uint64_t started = log_clock();
+    int result = fs_format_geometry(max_files, disk_size, block_size > INT_MAX ? INT_MAX : (int) block_size);
+    log_operation(LOG_OP_FORMAT, NULL, NULL, 0, started, result);
+    return result;
+}
+
+static int cmd_defrag(int argc, char* argv[]) {
+    (void) argc;
+    (void) argv;
+    uint64_t started = log_clock();
+    int result = fs_defragment();
+    log_operation(LOG_OP_DEFRAG, NULL, NULL, 0, started, result);
+    return result;
+}
+
+static int cmd_backup(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_backup(argv[1]);
+    log_operation(LOG_OP_BACKUP, argv[1], NULL, 0, started, result);
+    return result;
+}
+
+static int cmd_backup_incremental(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_backup_incremental(argv[1]);
+    log_operation(LOG_OP_BACKUP_INCREMENTAL, argv[1], NULL, 0, started, result);
+    return result;
+}
+
+static int cmd_restore(int argc, char* argv[]) {
+    (void) argc;
+    uint64_t started = log_clock();
+    int result = fs_restore(argv[1]);
+    log_operation(LOG_OP_RESTORE, argv[1], NULL, 0, started, result);
+    return result;
+}
+
+// Bütünlük denetimi ve tarama bulunan hata sayısını döner; sıfırdan farklıysa başarısızdır
+static int cmd_check(int argc, char* argv[]) {
+    int errors = argc == 2 ? fs_check_integrity_report(argv[1]) : fs_check_integrity();
+    return errors == 0 ? 0 : -1;
+}
+
+static int cmd_scrub(int argc, char* argv[]) {
+    (void) argc;
+    (void) argv;
+    return fs_scrub() == 0 ? 0 : -1;
+}
+
+static int cmd_sync(int argc, char* argv[]) {
+    (void) argc;
+    (void) argv;
+    return fs_sync();
+}
+
+static int cmd_log(int argc, char* argv[]) {
+    (void) argc;
+    (void) argv;
+    return fs_log();
+}
+
+static int cmd_exit(int argc, char* argv[]) {
+    (void) argc;
+    (void) argv;
+    return BATCH_EXIT;
+}
+
+static int cmd_help(int argc, char* argv[]);
+
+static const BatchCommand commands[] = {
+    {"create", 1, 1, cmd_create, "create DOSYA"},
+    {"rm", 1, 1, cmd_delete, "rm DOSYA"},
+    {"write", 1, -1, cmd_write, "write DOSYA VERI... | @HOST_DOSYASI"},
+    {"append", 1, -1, cmd_append, "append DOSYA VERI... | @HOST_DOSYASI"},
+    {"cat", 1, 3, cmd_cat, "cat DOSYA [OFFSET BOYUT]"},
+    {"import", 2, 2, cmd_import, "import HOST_DOSYASI DOSYA"},
+    {"export", 2, 2, cmd_export, "export DOSYA HOST_DOSYASI"},
+    {"mkdir", 1, 1, cmd_mkdir, "mkdir DIZIN"},
+    {"rmdir", 1, 1, cmd_rmdir, "rmdir DIZIN"},
+    {"ls", 0, 2, cmd_ls, "ls [DIZIN [ONEK]]"},
+    {"size", 1, 1, cmd_size, "size DOSYA"},
+    {"rename", 2, 2, cmd_rename, "rename ESKI YENI"},
+    {"mv", 2, 2, cmd_move, "mv KAYNAK HEDEF"},
+    {"cp", 2, 2, cmd_copy, "cp KAYNAK HEDEF"},
+    {"truncate", 2, 2, cmd_truncate, "truncate DOSYA BOYUT"},
+    {"diff", 2, 3, cmd_diff, "diff DOSYA1 DOSYA2 [-b]"},
+    {"format", 0, 3, cmd_format, "format [DOSYA_TABLOSU_KAPASITESI [DISK_BOYUTU [BLOK_BOYUTU]]]"},
+    {"defrag", 0, 0, cmd_defrag, "defrag"},
+    {"backup", 1, 1, cmd_backup, "backup YEDEK"},
+    {"backup-inc", 1, 1, cmd_backup_incremental, "backup-inc YEDEK"},
+    {"restore", 1, 1, cmd_restore, "restore YEDEK"},
+    {"check", 0, 1, cmd_check, "check [JSON_RAPORU]"},
+    {"scrub", 0, 0, cmd_scrub, "scrub"},
+    {"sync", 0, 0, cmd_sync, "sync"},
+    {"log", 0, 0, cmd_log, "log"},
+    {"exit", 0, 0, cmd_exit, "exit"},
+    {"help", 0, 0, cmd_help, "help"},
+};
+
+#define COMMAND_COUNT ((int) (sizeof(commands) / sizeof(commands[0])))
+
+static int cmd_help(int argc, char* argv[]) {
+    (void) argc;
+    (void) argv;
+    printf("Komutlar (';' ya da satir sonuyla ayrilir):\n");
+    for (int i = 0; i < COMMAND_COUNT; i++) printf("  %s\n", commands[i].usage);
+    return 0;
+}
+
+// Tek bir komutu çalıştır; hata olursa kaynağı ve satırıyla birlikte bildir
+static int run_command(int argc, char* argv[], const char* source, long line) {
+    const BatchCommand* command = NULL;
+    for (int i = 0; i < COMMAND_COUNT; i++) {
+        if (strcmp(argv[0], commands[i].name) == 0) {
+            command = &commands[i];
+            break;
+        }
+    }
+    if (!command) {
+        fprintf(stderr, "%s:%ld: bilinmeyen komut: %s\n", source, line, argv[0]);
+        failure_count++;
+        return BATCH_FAILED;
+    }
+    if (argc - 1 < command->min_args || (command->max_args >= 0 && argc - 1 > command->max_args) ||
+        (command->run == cmd_cat && argc == 3)) {
+        fprintf(stderr, "%s:%ld: kullanim: %s\n", source, line, command->usage);
+        failure_count++;
+        return BATCH_FAILED;
+    }
+
+    // Dosya sistemi çıktısı doğrudan stdout'a yazılır; sıranın korunması için tampon boşaltılır
+    fflush(stdout);
+    int result = command->run(argc, argv);
+    if (result == BATCH_EXIT) return BATCH_EXIT;
+    if (result == BATCH_USAGE) {
+        fprintf(stderr, "%s:%ld: kullanim: %s\n", source, line, command->usage);
+        failure_count++;
+        return BATCH_FAILED;
+    }
+    if (result < 0) {
+        fflush(stdout);
+        fprintf(stderr, "%s:%ld: %s basarisiz oldu\n", source, line, argv[0]);
+        failure_count++;
+        return BATCH_FAILED;
+    }
+    return BATCH_OK;
+}
+
+// Metni kelimelere ayırıp komutları çalıştır. Kelimeler boşlukla ayrılır; "..." içinde
+// \n, \t, \" ve \\ kaçışları, '...' içinde düz metin kullanılır. Tırnak dışında '\' bir
+// sonraki karakteri kelimeye katar, '#' satırın kalanını yorum yapar.
+static int run_text(const char* text, const char* source, long line) {
+    char* buffer = malloc(strlen(text) + 1);
+    if (!buffer) return BATCH_FAILED;
+    char* words[BATCH_MAX_ARGS];
+    int count = 0;
+    char* out = buffer;
+    const char* p = text;
+    int status = BATCH_OK;
+
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+        if (*p == '#') {
+            while (*p && *p != '\n') p++;
+        }
+
+        // Komut sonu: ';', satır sonu ya da metin sonu
+        if (*p == ';' || *p == '\n' || *p == '\0') {
+            if (count > 0) {
+                status = run_command(count, words, source, line);
+                count = 0;
+                out = buffer;
+                if (status == BATCH_EXIT) break;
+            }
+            if (*p == '\0') break;
+            if (*p == '\n') line++;
+            p++;
+            continue;
+        }
+
+        if (count == BATCH_MAX_ARGS) {
+            fprintf(stderr, "%s:%ld: cok fazla arguman (en fazla %d)\n", source, line, BATCH_MAX_ARGS);
+            failure_count++;
+            while (*p && *p != ';' && *p != '\n') p++;
+            count = 0;
+            out = buffer;
+            continue;
+        }
+
+        // Bir kelime oku
+        words[count] = out;
+        long word_line = line;
+        bool bad_quote = false;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != ';' && *p != '\n') {
+            if (*p == '\'') {
+                p++;
+                while (*p && *p != '\'') *out++ = *p++;
+                if (*p != '\'') bad_quote = true;
+                else p++;
+            } else if (*p == '"') {
+                p++;
+                while (*p && *p != '"') {
+                    if (*p == '\\' && p[1]) {
+                        p++;
+                        *out++ = *p == 'n' ? '\n' : *p == 't' ? '\t' : *p;
+                        p++;
+                    } else {
+                        if (*p == '\n') line++;
+                        *out++ = *p++;
+                    }
+                }
+                if (*p != '"') bad_quote = true;
+                else p++;
+            } else if (*p == '\\' && p[1]) {
+                p++;
+                *out++ = *p++;
+            } else {
+                *out++ = *p++;
+            }
+        }
+        *out++ = '\0';
+        if (bad_quote) {
+            fprintf(stderr, "%s:%ld: kapanmamis tirnak\n", source, word_line);
+            failure_count++;
+            count = 0;
+            out = buffer;
+            continue;
+        }
+        count++;
+    }
+
+    free(buffer);
+    return status;
+}
+
+int batch_run_args(int argc, char* argv[]) {
+    char* words[BATCH_MAX_ARGS];
+    int count = 0;
+    for (int i = 0; i < argc; i++) {
+        size_t length = strlen(argv[i]);
+        bool ends_command = length > 0 && argv[i][length - 1] == ';';
+        if (ends_command) argv[i][length - 1] = '\0';
+        if (argv[i][0] != '\0') {
+            if (count == BATCH_MAX_ARGS) {
+                fprintf(stderr, "argv: cok fazla arguman (en fazla %d)\n", BATCH_MAX_ARGS);
+                return 1;
+            }
+            words[count++] = argv[i];
+        }
+        if ((ends_command || i == argc - 1) && count > 0) {
+            if (run_command(count, words, "argv", i + 1) == BATCH_EXIT) break;
+            count = 0;
+        }
+    }
+    fflush(stdout);
+    return failure_count > 0;
+}
+
+int batch_run_text(const char* text, const char* source) {
+    run_text(text, source, 1);
+    fflush(stdout);
+    return failure_count > 0;
+}
+
+int batch_run_stream(FILE* input, const char* source) {
+    char* line = NULL;
+    size_t capacity = 0;
+    long number = 0;
+    while (getline(&line, &capacity, input) != -1) {
+        if (run_text(line, source, ++number) == BATCH_EXIT) break;
+    }
+    free(line);
+    fflush(stdout);
+    return failure_count > 0;
+}
@@ -0,0 +1,23 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+
+// Betik kipi: işlemler menü, ekran temizleme ve tuş beklemesi olmadan sırayla çalıştırılır.
+// Komutlar ';' ya da satır sonuyla ayrılır. Komut çıktısı stdout'a, hatalar stderr'e yazılır;
+// bir komut başarısız olursa sonrakiler yine çalıştırılır ve dönüş değeri 1 olur.
+//
+//   simplefs create a \; write a @host.txt \; cat a
+//   simplefs -c 'create a; write a "merhaba dunya"; cat a'
+//   simplefs - < komutlar.txt
+
+#define BATCH_MAX_ARGS 16
+
+// argv'deki kelimeleri komut olarak çalıştır (';' ya da ';' ile biten kelime komutu bitirir)
+int batch_run_args(int argc, char* argv[]);
+// Metni betik olarak çalıştır (tırnak ve '#' yorumları desteklenir)
+int batch_run_text(const char* text, const char* source);
+// Akıştan satır satır komut oku ve çalıştır
+int batch_run_stream(FILE* input, const char* source);
+
+#endif
@@ -0,0 +1,580 @@
+#define _GNU_SOURCE // mkdtemp için
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "crc32c.h"
+#include "memdiff.h"
+#include "fs.h"
+
+// fs_* işlemleri için mikro ölçüm aracı. Her işlem farklı dosya sayısı ve boyutlarıyla
+// çalıştırılır; ısınma turlarından sonra her çağrının süresi ayrı ayrı ölçülür ve
+// saniyedeki işlem sayısı ile p50/p99/p999 gecikmeleri JSON olarak yazılır.
+// Ölçüm geçici bir dizinde yapılır; çalışma dizinindeki disk.sim'e dokunulmaz.
+//
+//   fsbench [-r TUR] [-w ISINMA] [-f ISLEM] [-d DISK_MB] [-b BLOK] [-o CIKTI.json]
+
+#define DEFAULT_ROUNDS 10
+#define DEFAULT_WARMUP_ROUNDS 2
+#define BENCH_BACKUP_FILE "bench.bak"
+#define BENCH_INCREMENTAL_FILE "bench.inc.bak" // Artımlı yedek üst yedeğin üzerine yazılamaz
+#define BENCH_HOST_FILE "bench.host"
+#define BENCH_MAX_READERS 8
+
+static const int file_counts[] = {1, 16, 64};
+static const int file_sizes[] = {512, 4096, 32768};
+
+typedef struct {
+    int files;
+    int size;
+    char* data;
+    char* buffer;
+    char* reader_buffers[BENCH_MAX_READERS]; // Eşzamanlı okuyucuların tamponları
+} BenchCase;
+
+typedef struct {
+    const char* name;
+    bool once;                                  // Turda bir kez mi, yoksa her dosya için mi çalışır
+    int (*prepare)(BenchCase* bench);           // Her turdan önce (ölçülmez)
+    int (*run)(BenchCase* bench, int index);    // Ölçülen çağrı
+} BenchOp;
+
+typedef struct {
+    double* samples; // ns
+    int count;
+    int capacity;
+    int errors;
+    double total_ns;
+} Samples;
+
+static void file_name(char* out, char prefix, int index) { snprintf(out, FILENAME_LEN, "%c%d", prefix, index); }
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Hazırlık adımları: boş disk, oluşturulmuş dosyalar, veri yazılmış dosyalar
+static int prepare_empty(BenchCase* bench) {
+    (void) bench;
+    return fs_format();
+}
+
+static int prepare_created(BenchCase* bench) {
+    if (fs_format() < 0) return -1;
+    char name[FILENAME_LEN];
+    for (int i = 0; i < bench->files; i++) {
+        file_name(name, 'f', i);
+        if (fs_create(name) < 0) return -1;
+    }
+    return 0;
+}
+
+static int prepare_written(BenchCase* bench) {
+    if (prepare_created(bench) < 0) return -1;
+    char name[FILENAME_LEN];
+    for (int i = 0; i < bench->files; i++) {
+        file_name(name, 'f', i);
+        if (fs_write(name, bench->data, bench->size) < 0) return -1;
+    }
+    return fs_sync();
+}
+
+// Dosyaların yarısı silinerek boş alan parçalanır
+static int prepare_fragmented(BenchCase* bench) {
+    if (prepare_written(bench) < 0) return -1;
+    char name[FILENAME_LEN];
+    for (int i = 0; i < bench->files; i += 2) {
+        file_name(name, 'f', i);
+        if (fs_delete(name) < 0) return -1;
+    }
+    return fs_sync();
+}
+
+static int prepare_backed_up(BenchCase* bench) {
+    if (prepare_written(bench) < 0 || fs_backup(BENCH_BACKUP_FILE) < 0) return -1;
+    // Artımlı yedekte kopyalanacak bir değişiklik bırakılır
+    return fs_write("f0", bench->data, bench->size / 2 > 0 ? bench->size / 2 : 1);
+}
+
+// Günlüğü kirli bırak: disk kapatılır, çocuk süreç diski bağlayıp her dosyayı ayrı
+// işlemlerle yeniden yazar ve kapatmadan çıkar. Ölçülen çağrı yeniden bağlanmadır.
+static int prepare_dirty_journal(BenchCase* bench) {
+    if (prepare_written(bench) < 0) return -1;
+    fs_close();
+
+    pid_t child = fork();
+    if (child == 0) {
+        fs_set_group_commit(1, 0);
+        bool ok = fs_init();
+        char name[FILENAME_LEN];
+        for (int i = 0; ok && i < bench->files; i++) {
+            file_name(name, 'f', i);
+            ok = fs_write(name, bench->data, bench->size) >= 0 && fs_append(name, bench->data, bench->size) >= 0;
+        }
+        _exit(ok && fs_sync() == 0 ? 0 : 1);
+    }
+
+    int status = 0;
+    bool dirty = child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (!dirty) {
+        fs_init();
+        return -1;
+    }
+    return 0;
+}
+
+static int prepare_host_file(BenchCase* bench) {
+    int fd = open(BENCH_HOST_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    int written = (int) write(fd, bench->data, bench->size);
+    close(fd);
+    return written == bench->size ? prepare_empty(bench) : -1;
+}
+
+static int run_create(BenchCase* bench, int index) {
+    (void) bench;
+    char name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    return fs_create(name);
+}
+
+static int run_delete(BenchCase* bench, int index) {
+    (void) bench;
+    char name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    return fs_delete(name);
+}
+
+static int run_write(BenchCase* bench, int index) {
+    char name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    return fs_write(name, bench->data, bench->size);
+}
+
+static int run_append(BenchCase* bench, int index) {
+    char name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    return fs_append(name, bench->data, bench->size);
+}
+
+static int run_read(BenchCase* bench, int index) {
+    char name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    return fs_read(name, 0, bench->size, bench->buffer);
+}
+
+static int run_size(BenchCase* bench, int index) {
+    (void) bench;
+    char name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    return fs_size(name);
+}
+
+static int run_truncate(BenchCase* bench, int index) {
+    char name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    return fs_truncate(name, bench->size / 2);
+}
+
+static int run_rename(BenchCase* bench, int index) {
+    (void) bench;
+    char name[FILENAME_LEN], new_name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    file_name(new_name, 'r', index);
+    return fs_rename(name, new_name);
+}
+
+static int run_copy(BenchCase* bench, int index) {
+    (void) bench;
+    char name[FILENAME_LEN], copy[FILENAME_LEN];
+    file_name(name, 'f', index);
+    file_name(copy, 'c', index);
+    return fs_copy(name, copy);
+}
+
+static int run_diff(BenchCase* bench, int index) {
+    (void) bench;
+    char name[FILENAME_LEN], other[FILENAME_LEN];
+    file_name(name, 'f', index);
+    file_name(other, 'f', (index + 1) % bench->files);
+    return fs_diff(name, other);
+}
+
+static int run_import(BenchCase* bench, int index) {
+    (void) bench;
+    char name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    return fs_import(BENCH_HOST_FILE, name);
+}
+
+static int run_export(BenchCase* bench, int index) {
+    (void) bench;
+    char name[FILENAME_LEN];
+    file_name(name, 'f', index);
+    return fs_export(name, BENCH_HOST_FILE);
+}
+
+// Eşzamanlı okuyucular: her iş parçacığı tüm dosyaları okur ve ölçülen süre hepsinin
+// bitmesidir. Okuma kilitleri ölçeklendikçe iş parçacığı sayısı artarken süre sabit kalır.
+typedef struct {
+    BenchCase* bench;
+    char* buffer;
+    int result;
+} ReaderTask;
+
+static void* reader_thread(void* arg) {
+    ReaderTask* task = arg;
+    char name[FILENAME_LEN];
+    task->result = 0;
+    for (int i = 0; i < task->bench->files; i++) {
+        file_name(name, 'f', i);
+        if (fs_read(name, 0, task->bench->size, task->buffer) < 0) task->result = -1;
+    }
+    return NULL;
+}
+
+static int read_parallel(BenchCase* bench, int threads) {
+    ReaderTask tasks[BENCH_MAX_READERS];
+    pthread_t ids[BENCH_MAX_READERS];
+    int started = 0;
+    int result = 0;
+    for (; started < threads; started++) {
+        tasks[started].bench = bench;
+        tasks[started].buffer = bench->reader_buffers[started];
+        if (pthread_create(&ids[started], NULL, reader_thread, &tasks[started]) != 0) {
+            result = -1;
+            break;
+        }
+    }
+    for (int k = 0; k < started; k++) {
+        pthread_join(ids[k], NULL);
+        if (tasks[k].result < 0) result = -1;
+    }
+    return result;
+}
+
+static int run_read_parallel_1(BenchCase* bench, int index) {
+    (void) index;
+    return read_parallel(bench, 1);
+}
+
+static int run_read_parallel_2(BenchCase* bench, int index) {
+    (void) index;
+    return read_parallel(bench, 2);
+}
+
+static int run_read_parallel_4(BenchCase* bench, int index) {
+    (void) index;
+    return read_parallel(bench, 4);
+}
+
+static int run_read_parallel_8(BenchCase* bench, int index) {
+    (void) index;
+    return read_parallel(bench, 8);
+}
+
+// Kök dizini sayfa sayfa baştan sona oku; çıktı üretilmediğinden terminal maliyeti ölçülmez
+#define BENCH_LIST_PAGE 256
+
+static int list_all(const char* prefix) {
+    FsDirEntry entries[BENCH_LIST_PAGE];
+    FsListCursor cursor = {0};
+    int count;
+    do {
+        count = fs_list("/", prefix, &cursor, entries, BENCH_LIST_PAGE);
+    } while (count > 0);
+    return count;
+}
+
+static int run_list(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return list_all(NULL);
+}
+
+static int run_list_prefix(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return list_all("f1");
+}
+
+static int run_defragment(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return fs_defragment();
+}
+
+static int run_backup(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return fs_backup(BENCH_BACKUP_FILE);
+}
+
+static int run_backup_incremental(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return fs_backup_incremental(BENCH_INCREMENTAL_FILE);
+}
+
+static int run_restore(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return fs_restore(BENCH_BACKUP_FILE);
+}
+
+static int run_check(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return fs_check_integrity() == 0 ? 0 : -1;
+}
+
+static int run_scrub(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return fs_scrub() == 0 ? 0 : -1;
+}
+
+static int run_sync(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return fs_sync();
+}
+
+// Kirli günlükle bağlanma: günlüğün tekrarı ve kirli kapanış kurtarması
+static int run_remount(BenchCase* bench, int index) {
+    (void) bench;
+    (void) index;
+    return fs_init() ? 0 : -1;
+}
+
+static const BenchOp operations[] = {
+    {"create", false, prepare_empty, run_create},
+    {"delete", false, prepare_written, run_delete},
+    {"write", false, prepare_created, run_write},
+    {"append", false, prepare_created, run_append},
+    {"read", false, prepare_written, run_read},
+    {"read_parallel_1", true, prepare_written, run_read_parallel_1},
+    {"read_parallel_2", true, prepare_written, run_read_parallel_2},
+    {"read_parallel_4", true, prepare_written, run_read_parallel_4},
+    {"read_parallel_8", true, prepare_written, run_read_parallel_8},
+    {"size", false, prepare_written, run_size},
+    {"truncate", false, prepare_written, run_truncate},
+    {"rename", false, prepare_written, run_rename},
+    {"copy", false, prepare_written, run_copy},
+    {"diff", false, prepare_written, run_diff},
+    {"import", false, prepare_host_file, run_import},
+    {"export", false, prepare_written, run_export},
+    {"list", true, prepare_written, run_list},
+    {"list_prefix", true, prepare_written, run_list_prefix},
+    {"defragment", true, prepare_fragmented, run_defragment},
+    {"backup", true, prepare_written, run_backup},
+    {"backup_incremental", true, prepare_backed_up, run_backup_incremental},
+    {"restore", true, prepare_backed_up, run_restore},
+    {"check_integrity", true, prepare_written, run_check},
+    {"scrub", true, prepare_written, run_scrub},
+    {"sync", true, prepare_written, run_sync},
+    {"journal_replay", true, prepare_dirty_journal, run_remount},
+};
+
+#define OPERATION_COUNT ((int) (sizeof(operations) / sizeof(operations[0])))
+
+static int add_sample(Samples* s, double ns) {
+    if (s->count == s->capacity) {
+        int capacity = s->capacity ? s->capacity * 2 : 256;
+        double* grown = realloc(s->samples, capacity * sizeof(double));
+        if (!grown) return -1;
+        s->samples = grown;
+        s->capacity = capacity;
+    }
+    s->samples[s->count++] = ns;
+    s->total_ns += ns;
+    return 0;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+// Sıralı örneklerde p. yüzdelik (en yakın sıra yöntemi)
+static double percentile(const double* sorted, int count, double p) {
+    int rank = (int) (p * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+// Bir işlemi bir durum için çalıştır: ısınma turları ölçülmez, sonraki turlarda her çağrı ölçülür
+static int run_case(const BenchOp* op, BenchCase* bench, int warmup, int rounds, Samples* s) {
+    int calls = op->once ? 1 : bench->files;
+    for (int round = 0; round < warmup + rounds; round++) {
+        if (op->prepare(bench) < 0) return -1;
+        for (int i = 0; i < calls; i++) {
+            uint64_t started = now_ns();
+            int result = op->run(bench, i);
+            uint64_t elapsed = now_ns() - started;
+            if (round < warmup) continue;
+            if (result < 0) s->errors++;
+            if (add_sample(s, (double) elapsed) < 0) return -1;
+        }
+    }
+    return 0;
+}
+
+static void print_result(FILE* out, bool first, const BenchOp* op, const BenchCase* bench, Samples* s) {
+    qsort(s->samples, s->count, sizeof(double), compare_double);
+    fprintf(out, "%s    {\"op\": \"%s\", \"files\": %d, \"size\": %d, \"samples\": %d, \"errors\": %d, ", first ? "" : ",\n",
+            op->name, bench->files, bench->size, s->count, s->errors);
+    fprintf(out, "\"ops_per_sec\": %.1f, \"mean_us\": %.3f, \"p50_us\": %.3f, \"p99_us\": %.3f, \"p999_us\": %.3f, \"max_us\": %.3f}",
+            s->total_ns > 0 ? s->count / (s->total_ns / 1e9) : 0.0, s->total_ns / s->count / 1000.0,
+            percentile(s->samples, s->count, 0.50) / 1000.0, percentile(s->samples, s->count, 0.99) / 1000.0,
+            percentile(s->samples, s->count, 0.999) / 1000.0, s->samples[s->count - 1] / 1000.0);
+}
+
+// Geçici dizindeki dosyaları ve dizinin kendisini sil
+static void remove_directory(const char* path) {
+    DIR* dir = opendir(path);
+    if (dir) {
+        struct dirent* entry;
+        char file[4096];
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+            unlink(file);
+        }
+        closedir(dir);
+    }
+    rmdir(path);
+}
+
+int main(int argc, char* argv[]) {
+    int rounds = DEFAULT_ROUNDS;
+    int warmup = DEFAULT_WARMUP_ROUNDS;
+    const char* filter = NULL;
+    const char* output = NULL;
+    uint64_t disk_size = 0; // 0 = varsayılan geometri
+    int block_size = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:w:f:d:b:o:h")) != -1) {
+        switch (opt) {
+            case 'r':
+                rounds = atoi(optarg);
+                break;
+            case 'w':
+                warmup = atoi(optarg);
+                break;
+            case 'f':
+                filter = optarg;
+                break;
+            case 'd':
+                disk_size = strtoull(optarg, NULL, 10) * 1024 * 1024;
+                break;
+            case 'b':
+                block_size = atoi(optarg);
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            default:
+                fprintf(stderr, "Kullanim: fsbench [-r TUR] [-w ISINMA] [-f ISLEM] [-d DISK_MB] [-b BLOK] [-o CIKTI.json]\n");
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (rounds <= 0 || warmup < 0) {
+        fprintf(stderr, "Gecersiz tur sayisi.\n");
+        return 1;
+    }
+
+    // Çıktı dosyası geçici dizine geçmeden açılır
+    FILE* out = output ? fopen(output, "w") : fdopen(dup(STDOUT_FILENO), "w");
+    if (!out) {
+        fprintf(stderr, "Cikti dosyasi acilamadi: %s\n", output ? output : "stdout");
+        return 1;
+    }
+
+    char directory[] = "/tmp/simplefs-bench-XXXXXX";
+    if (!mkdtemp(directory) || chdir(directory) != 0) {
+        fprintf(stderr, "Gecici dizin olusturulamadi.\n");
+        return 1;
+    }
+
+    // Dosya sisteminin mesajları ölçümü ve JSON çıktısını bozmasın diye stdout kapatılır
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+        fflush(stdout);
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+
+    if (!fs_init() || ((disk_size || block_size) && fs_format_geometry(0, disk_size, block_size) < 0)) {
+        fprintf(stderr, "Disk baslatilamadi veya geometri gecersiz.\n");
+        remove_directory(directory);
+        return 1;
+    }
+    disk_size = fs_disk_size();
+    block_size = fs_block_size();
+
+    int max_size = file_sizes[sizeof(file_sizes) / sizeof(file_sizes[0]) - 1];
+    BenchCase bench;
+    bench.data = malloc(max_size);
+    bench.buffer = malloc(max_size);
+    for (int k = 0; k < BENCH_MAX_READERS; k++) bench.reader_buffers[k] = malloc(max_size);
+    for (int i = 0; i < max_size; i++) bench.data[i] = (char) ('a' + (i * 7 + i / 13) % 26);
+
+    time_t now = time(NULL);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    fprintf(out, "{\n  \"date\": \"%s\",\n  \"disk_size\": %llu,\n  \"block_size\": %d,\n", date,
+            (unsigned long long) disk_size, block_size);
+    fprintf(out, "  \"io_mode\": \"%s\",\n  \"crc32c\": \"%s\",\n  \"memdiff\": \"%s\",\n  \"rounds\": %d,\n  \"warmup_rounds\": %d,\n",
+            DEFAULT_IO_MODE == FS_IO_MMAP ? "mmap" : "fd", crc32c_impl(), memdiff_impl(), rounds, warmup);
+    fprintf(out, "  \"results\": [\n");
+
+    bool first = true;
+    int failed = 0;
+    for (int k = 0; k < OPERATION_COUNT; k++) {
+        const BenchOp* op = &operations[k];
+        if (filter && strcmp(filter, op->name) != 0) continue;
+        for (size_t c = 0; c < sizeof(file_counts) / sizeof(file_counts[0]); c++) {
+            for (size_t z = 0; z < sizeof(file_sizes) / sizeof(file_sizes[0]); z++) {
+                bench.files = file_counts[c];
+                bench.size = file_sizes[z];
+                // Kopyalama ve yedek geri yüklemesi için yarım disk boş kalmalı
+                if ((uint64_t) bench.files * bench.size * 2 > disk_size / 2) continue;
+
+                Samples samples = {0};
+                fprintf(stderr, "%-20s dosya=%-3d boyut=%-6d ", op->name, bench.files, bench.size);
+                if (run_case(op, &bench, warmup, rounds, &samples) < 0 || samples.count == 0) {
+                    fprintf(stderr, "HAZIRLIK BASARISIZ\n");
+                    failed++;
+                } else {
+                    print_result(out, first, op, &bench, &samples);
+                    first = false;
+                    fprintf(stderr, "%d olcum\n", samples.count);
+                }
+                free(samples.samples);
+            }
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (filter && first && failed == 0) {
+        fprintf(stderr, "Bilinmeyen islem: %s\n", filter);
+        failed++;
+    }
+    fclose(out);
+
+    fs_close();
+    free(bench.data);
+    free(bench.buffer);
+    for (int k = 0; k < BENCH_MAX_READERS; k++) free(bench.reader_buffers[k]);
+    remove_directory(directory);
+    return failed > 0;
+}
@@ -0,0 +1,101 @@
+#include "crc32c.h"
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+#define CRC32C_POLY 0x82F63B78 // Castagnoli polinomu (ters çevrilmiş)
+
+// Dilimleme (slicing-by-8) tabloları: tablo i, 8 baytlık kelimenin i. baytı içindir
+static uint32_t crc_table[8][256];
+static pthread_once_t table_once = PTHREAD_ONCE_INIT;
+static uint32_t (*crc_update)(uint32_t crc, const unsigned char* bytes, size_t length);
+
+// Yazılımla hesaplama: her adımda 8 bayt işlenir
+static uint32_t crc_update_table(uint32_t crc, const unsigned char* bytes, size_t length) {
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, bytes, sizeof(word));
+        word ^= crc;
+        crc = crc_table[7][word & 0xFF] ^ crc_table[6][(word >> 8) & 0xFF] ^ crc_table[5][(word >> 16) & 0xFF] ^
+              crc_table[4][(word >> 24) & 0xFF] ^ crc_table[3][(word >> 32) & 0xFF] ^ crc_table[2][(word >> 40) & 0xFF] ^
+              crc_table[1][(word >> 48) & 0xFF] ^ crc_table[0][word >> 56];
+        bytes += 8;
+        length -= 8;
+    }
+    while (length-- > 0) crc = crc_table[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#if defined(__x86_64__)
+// SSE4.2 CRC32 komutu (Castagnoli polinomunu kullanır)
+__attribute__((target("sse4.2"))) static uint32_t crc_update_sse42(uint32_t crc, const unsigned char* bytes, size_t length) {
+    uint64_t crc64 = crc;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, bytes, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        bytes += 8;
+        length -= 8;
+    }
+    crc = (uint32_t) crc64;
+    while (length-- > 0) crc = _mm_crc32_u8(crc, *bytes++);
+    return crc;
+}
+#elif defined(__aarch64__)
+// ARMv8 CRC32C komutları
+__attribute__((target("+crc"))) static uint32_t crc_update_armv8(uint32_t crc, const unsigned char* bytes, size_t length) {
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, bytes, sizeof(word));
+        crc = __crc32cd(crc, word);
+        bytes += 8;
+        length -= 8;
+    }
+    while (length-- > 0) crc = __crc32cb(crc, *bytes++);
+    return crc;
+}
+#endif
+
+// Tablolar ilk kullanımda oluşturulur ve işlemcinin desteklediği en hızlı yol seçilir
+// (yedekleme ve tarama iş parçacıkları aynı anda çağırabilir)
+static void build_table() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        crc_table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) crc_table[k][i] = crc_table[0][crc_table[k - 1][i] & 0xFF] ^ (crc_table[k - 1][i] >> 8);
+    }
+
+    crc_update = crc_update_table;
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("sse4.2")) crc_update = crc_update_sse42;
+#elif defined(__aarch64__)
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32) crc_update = crc_update_armv8;
+#endif
+}
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t length) {
+    pthread_once(&table_once, build_table);
+    return ~crc_update(~crc, data, length);
+}
+
+const char* crc32c_impl() {
+    pthread_once(&table_once, build_table);
+#if defined(__x86_64__)
+    if (crc_update == crc_update_sse42) return "sse4.2";
+#elif defined(__aarch64__)
+    if (crc_update == crc_update_armv8) return "armv8";
+#endif
+    return "table";
+}
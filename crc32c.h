@@ -0,0 +1,15 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC32C (Castagnoli) sağlama toplamı. crc ilk çağrıda 0 verilir,
+// parçalı hesaplamada önceki çağrının sonucu verilerek devam edilir.
+// Destekleniyorsa SSE4.2 (x86-64) ya da ARMv8 CRC komutları, aksi halde tablo kullanılır.
+uint32_t crc32c(uint32_t crc, const void* data, size_t length);
+
+// Seçilen hesaplama yolunun adı ("sse4.2", "armv8" ya da "table")
+const char* crc32c_impl();
+
+#endif
@@ -0,0 +1,358 @@
+#include "dirtree.h"
+#include <string.h>
+
+_Static_assert(sizeof(DirNode) == 1376, "DirNode boyutu disk bicimiyle uyumlu olmali");
+
+// Anahtarları önce üst dizine, sonra ada göre karşılaştır
+static int compare_key(int32_t parent, const char* name, const DirKey* key) {
+    if (parent != key->parent) return parent < key->parent ? -1 : 1;
+    return strncmp(name, key->name, FILENAME_LEN);
+}
+
+// Adı anahtara kopyala; ad en fazla FILENAME_LEN - 1 bayt alınır ve her zaman sonlandırılır
+static void set_key_name(DirKey* key, const char* name) {
+    size_t length = strnlen(name, FILENAME_LEN - 1);
+    memcpy(key->name, name, length);
+    key->name[length] = '\0';
+}
+
+static bool is_leaf(const DirNode* node) { return node->flags & DIR_NODE_LEAF; }
+
+// Düğümde anahtardan küçük olmayan ilk konum (ikili arama); eşit anahtar varsa *found true olur
+static int lower_bound(const DirNode* node, int32_t parent, const char* name, bool* found) {
+    int low = 0, high = node->count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (compare_key(parent, name, &node->keys[mid]) > 0) low = mid + 1;
+        else high = mid;
+    }
+    *found = low < (int) node->count && compare_key(parent, name, &node->keys[low]) == 0;
+    return low;
+}
+
+// Düğümün 'count' konumundan sonraki anahtar ve çocukları temizle; silinen adlar diskte kalmasın
+static void clear_tail(DirNode* node) {
+    memset(&node->keys[node->count], 0, (DIR_NODE_KEYS - node->count) * sizeof(DirKey));
+    memset(&node->children[node->count + 1], 0, (DIR_NODE_KEYS - node->count) * sizeof(int32_t));
+}
+
+int dirtree_create(DirTree* tree) {
+    int root = tree->alloc_node(tree);
+    if (root < 0) return -1;
+    tree->nodes[root].flags |= DIR_NODE_LEAF;
+    tree->mark_dirty(tree, root);
+    tree->root = root;
+    return 0;
+}
+
+int dirtree_find(const DirTree* tree, int32_t parent, const char* name) {
+    int index = tree->root;
+    while (index >= 0) {
+        const DirNode* node = &tree->nodes[index];
+        bool found;
+        int i = lower_bound(node, parent, name, &found);
+        if (found) return node->keys[i].slot;
+        if (is_leaf(node)) return -1;
+        index = node->children[i];
+    }
+    return -1;
+}
+
+// 'index' düğümünün dolu i. çocuğunu ikiye böl; ortanca anahtar 'index' düğümüne çıkar
+static int split_child(DirTree* tree, int index, int i) {
+    int sibling = tree->alloc_node(tree);
+    if (sibling < 0) return -1;
+
+    const int t = DIR_TREE_ORDER;
+    DirNode* node = &tree->nodes[index];
+    int child_index = node->children[i];
+    DirNode* child = &tree->nodes[child_index];
+    DirNode* right = &tree->nodes[sibling];
+
+    right->flags |= child->flags & DIR_NODE_LEAF;
+    right->count = t - 1;
+    memcpy(right->keys, &child->keys[t], (t - 1) * sizeof(DirKey));
+    if (!is_leaf(child)) memcpy(right->children, &child->children[t], t * sizeof(int32_t));
+
+    memmove(&node->children[i + 2], &node->children[i + 1], (node->count - i) * sizeof(int32_t));
+    node->children[i + 1] = sibling;
+    memmove(&node->keys[i + 1], &node->keys[i], (node->count - i) * sizeof(DirKey));
+    node->keys[i] = child->keys[t - 1];
+    node->count++;
+
+    child->count = t - 1;
+    clear_tail(child);
+    tree->mark_dirty(tree, index);
+    tree->mark_dirty(tree, child_index);
+    tree->mark_dirty(tree, sibling);
+    return 0;
+}
+
+// Ekleme tek geçişte yapılır: inilen dolu düğümler önceden bölünür, böylece yaprakta her zaman yer vardır
+int dirtree_insert(DirTree* tree, int32_t parent, const char* name, int32_t slot) {
+    if (tree->nodes[tree->root].count == DIR_NODE_KEYS) {
+        int new_root = tree->alloc_node(tree);
+        if (new_root < 0) return -1;
+        tree->nodes[new_root].children[0] = tree->root;
+        if (split_child(tree, new_root, 0) < 0) {
+            tree->free_node(tree, new_root);
+            return -1;
+        }
+        tree->root = new_root;
+    }
+
+    int index = tree->root;
+    bool found;
+    while (!is_leaf(&tree->nodes[index])) {
+        int i = lower_bound(&tree->nodes[index], parent, name, &found);
+        int child = tree->nodes[index].children[i];
+        if (tree->nodes[child].count == DIR_NODE_KEYS) {
+            if (split_child(tree, index, i) < 0) return -1;
+            if (compare_key(parent, name, &tree->nodes[index].keys[i]) > 0) i++;
+            child = tree->nodes[index].children[i];
+        }
+        index = child;
+    }
+
+    DirNode* leaf = &tree->nodes[index];
+    int i = lower_bound(leaf, parent, name, &found);
+    memmove(&leaf->keys[i + 1], &leaf->keys[i], (leaf->count - i) * sizeof(DirKey));
+    memset(&leaf->keys[i], 0, sizeof(DirKey));
+    leaf->keys[i].parent = parent;
+    leaf->keys[i].slot = slot;
+    set_key_name(&leaf->keys[i], name);
+    leaf->count++;
+    tree->mark_dirty(tree, index);
+    return 0;
+}
+
+// i. anahtarı ve (i+1). çocuğu i. çocukla birleştir
+static void merge_children(DirTree* tree, int index, int i) {
+    DirNode* node = &tree->nodes[index];
+    int left_index = node->children[i];
+    int right_index = node->children[i + 1];
+    DirNode* left = &tree->nodes[left_index];
+    DirNode* right = &tree->nodes[right_index];
+
+    left->keys[left->count] = node->keys[i];
+    memcpy(&left->keys[left->count + 1], right->keys, right->count * sizeof(DirKey));
+    if (!is_leaf(left)) memcpy(&left->children[left->count + 1], right->children, (right->count + 1) * sizeof(int32_t));
+    left->count += right->count + 1;
+
+    memmove(&node->keys[i], &node->keys[i + 1], (node->count - i - 1) * sizeof(DirKey));
+    memmove(&node->children[i + 1], &node->children[i + 2], (node->count - i - 1) * sizeof(int32_t));
+    node->count--;
+    clear_tail(node);
+
+    tree->mark_dirty(tree, index);
+    tree->mark_dirty(tree, left_index);
+    tree->free_node(tree, right_index);
+}
+
+// i. çocuğa sol kardeşinden üst düğüm üzerinden bir anahtar aktar
+static void borrow_from_left(DirTree* tree, int index, int i) {
+    DirNode* node = &tree->nodes[index];
+    DirNode* child = &tree->nodes[node->children[i]];
+    DirNode* left = &tree->nodes[node->children[i - 1]];
+
+    memmove(&child->keys[1], child->keys, child->count * sizeof(DirKey));
+    if (!is_leaf(child)) memmove(&child->children[1], child->children, (child->count + 1) * sizeof(int32_t));
+    child->keys[0] = node->keys[i - 1];
+    if (!is_leaf(child)) child->children[0] = left->children[left->count];
+    child->count++;
+
+    node->keys[i - 1] = left->keys[left->count - 1];
+    left->count--;
+    clear_tail(left);
+
+    tree->mark_dirty(tree, index);
+    tree->mark_dirty(tree, node->children[i]);
+    tree->mark_dirty(tree, node->children[i - 1]);
+}
+
+// i. çocuğa sağ kardeşinden üst düğüm üzerinden bir anahtar aktar
+static void borrow_from_right(DirTree* tree, int index, int i) {
+    DirNode* node = &tree->nodes[index];
+    DirNode* child = &tree->nodes[node->children[i]];
+    DirNode* right = &tree->nodes[node->children[i + 1]];
+
+    child->keys[child->count] = node->keys[i];
+    if (!is_leaf(child)) child->children[child->count + 1] = right->children[0];
+    child->count++;
+
+    node->keys[i] = right->keys[0];
+    memmove(right->keys, &right->keys[1], (right->count - 1) * sizeof(DirKey));
+    if (!is_leaf(right)) memmove(right->children, &right->children[1], right->count * sizeof(int32_t));
+    right->count--;
+    clear_tail(right);
+
+    tree->mark_dirty(tree, index);
+    tree->mark_dirty(tree, node->children[i]);
+    tree->mark_dirty(tree, node->children[i + 1]);
+}
+
+// Alt ağaçtaki en küçük ya da en büyük anahtar
+static DirKey edge_key(const DirTree* tree, int index, bool largest) {
+    while (!is_leaf(&tree->nodes[index])) {
+        const DirNode* node = &tree->nodes[index];
+        index = node->children[largest ? node->count : 0];
+    }
+    const DirNode* leaf = &tree->nodes[index];
+    return leaf->keys[largest ? leaf->count - 1 : 0];
+}
+
+// Silme de tek geçişte yapılır: inilen her düğümde en az t anahtar olması, gerekirse
+// kardeşten anahtar alınarak ya da kardeşle birleştirilerek sağlanır
+int dirtree_remove(DirTree* tree, int32_t parent, const char* name) {
+    const int t = DIR_TREE_ORDER;
+    DirKey target;
+    memset(&target, 0, sizeof(target));
+    target.parent = parent;
+    set_key_name(&target, name);
+
+    int index = tree->root;
+    int result = -1;
+    for (;;) {
+        DirNode* node = &tree->nodes[index];
+        bool found;
+        int i = lower_bound(node, target.parent, target.name, &found);
+
+        if (found && is_leaf(node)) {
+            memmove(&node->keys[i], &node->keys[i + 1], (node->count - i - 1) * sizeof(DirKey));
+            node->count--;
+            clear_tail(node);
+            tree->mark_dirty(tree, index);
+            result = 0;
+            break;
+        }
+        if (found) {
+            // İç düğümdeki anahtar, yeterince dolu komşu alt ağaçtaki öncülü ya da ardılıyla
+            // değiştirilir ve o anahtar alt ağaçtan silinir; ikisi de azsa birleştirilir
+            int left = node->children[i];
+            int right = node->children[i + 1];
+            if ((int) tree->nodes[left].count >= t) {
+                node->keys[i] = edge_key(tree, left, true);
+                target = node->keys[i];
+                tree->mark_dirty(tree, index);
+                index = left;
+            } else if ((int) tree->nodes[right].count >= t) {
+                node->keys[i] = edge_key(tree, right, false);
+                target = node->keys[i];
+                tree->mark_dirty(tree, index);
+                index = right;
+            } else {
+                merge_children(tree, index, i);
+                index = left;
+            }
+            continue;
+        }
+        if (is_leaf(node)) break;
+
+        int child = node->children[i];
+        if ((int) tree->nodes[child].count < t) {
+            if (i > 0 && (int) tree->nodes[node->children[i - 1]].count >= t) {
+                borrow_from_left(tree, index, i);
+            } else if (i < (int) node->count && (int) tree->nodes[node->children[i + 1]].count >= t) {
+                borrow_from_right(tree, index, i);
+            } else if (i < (int) node->count) {
+                merge_children(tree, index, i);
+            } else {
+                merge_children(tree, index, i - 1);
+                child = node->children[i - 1];
+            }
+        }
+        index = child;
+    }
+
+    // Birleştirme kökü boşaltmışsa ağaç bir seviye alçalır
+    DirNode* root = &tree->nodes[tree->root];
+    if (root->count == 0 && !is_leaf(root)) {
+        int old_root = tree->root;
+        tree->root = root->children[0];
+        tree->free_node(tree, old_root);
+    }
+    return result;
+}
+
+typedef struct {
+    int32_t parent;
+    const char* start;  // Taramanın alt sınırı
+    bool inclusive;     // Alt sınıra eşit anahtar da döndürülür
+    const char* prefix;
+    size_t prefix_length;
+    DirKey* out;
+    int max;
+    int count;
+    bool done;
+} ScanState;
+
+// Alt ağacı sıralı gez; alt sınırdan küçük anahtarların bulunduğu çocuklara inilmez
+static void scan_node(const DirTree* tree, int index, ScanState* state) {
+    const DirNode* node = &tree->nodes[index];
+    bool found;
+    int i = lower_bound(node, state->parent, state->start, &found);
+    if (found && !state->inclusive) i++;
+
+    for (; i <= (int) node->count && !state->done; i++) {
+        if (!is_leaf(node)) scan_node(tree, node->children[i], state);
+        if (state->done || i == (int) node->count) break;
+        const DirKey* key = &node->keys[i];
+        if (key->parent != state->parent || strncmp(key->name, state->prefix, state->prefix_length) != 0) {
+            state->done = true;
+            break;
+        }
+        state->out[state->count++] = *key;
+        if (state->count == state->max) state->done = true;
+    }
+}
+
+int dirtree_scan(const DirTree* tree, int32_t parent, const char* after, const char* prefix, DirKey* out, int max) {
+    if (max <= 0) return 0;
+    if (!after) after = "";
+    if (!prefix) prefix = "";
+
+    // Önekten küçük bir konumdan devam ediliyorsa tarama önekin kendisinden başlar
+    ScanState state = {parent, after, false, prefix, strlen(prefix), out, max, 0, false};
+    if (strncmp(after, prefix, FILENAME_LEN) < 0) {
+        state.start = prefix;
+        state.inclusive = true;
+    }
+    scan_node(tree, tree->root, &state);
+    return state.count;
+}
+
+// Alt ağacı doğrula; anahtarlar (low, high) aralığında olmalı (NULL = sınırsız)
+static int64_t verify_node(const DirTree* tree, int index, int depth, int* leaf_depth, const DirKey* low, const DirKey* high,
+                           void (*visit)(const DirKey* key, void* context), void* context) {
+    if (index < 0 || index >= (int) tree->capacity || depth > DIR_TREE_MAX_DEPTH) return -1;
+    const DirNode* node = &tree->nodes[index];
+    if (!(node->flags & DIR_NODE_USED) || node->count > DIR_NODE_KEYS) return -1;
+    if (index != tree->root && (int) node->count < DIR_TREE_ORDER - 1) return -1;
+    if (!is_leaf(node) && node->count == 0) return -1;
+
+    for (int i = 0; i < (int) node->count; i++) {
+        const DirKey* key = &node->keys[i];
+        const DirKey* previous = i > 0 ? &node->keys[i - 1] : low;
+        if (previous && compare_key(key->parent, key->name, previous) <= 0) return -1;
+        if (high && compare_key(key->parent, key->name, high) >= 0) return -1;
+        if (visit) visit(key, context);
+    }
+
+    int64_t total = node->count;
+    if (is_leaf(node)) {
+        if (*leaf_depth < 0) *leaf_depth = depth;
+        return *leaf_depth == depth ? total : -1;
+    }
+    for (int i = 0; i <= (int) node->count; i++) {
+        int64_t keys = verify_node(tree, node->children[i], depth + 1, leaf_depth, i > 0 ? &node->keys[i - 1] : low,
+                                   i < (int) node->count ? &node->keys[i] : high, visit, context);
+        if (keys < 0) return -1;
+        total += keys;
+    }
+    return total;
+}
+
+int64_t dirtree_verify(const DirTree* tree, void (*visit)(const DirKey* key, void* context), void* context) {
+    int leaf_depth = -1;
+    return verify_node(tree, tree->root, 0, &leaf_depth, NULL, NULL, visit, context);
+}
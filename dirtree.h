@@ -0,0 +1,59 @@
+#ifndef DIRTREE_H
+#define DIRTREE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fs.h"
+
+// Dizin girdileri disk.sim içinde tek bir B-ağacında tutulur. Anahtar (üst dizin, ad)
+// çiftidir; böylece bir dizinin girdileri ağaçta ada göre sıralı ve ardışık durur.
+// Düğümler sabit boyutludur ve fs.c'nin yönettiği büyütülebilir düğüm tablosunda
+// indeksle gösterilir; bu modül yalnızca ağaç algoritmalarını içerir.
+#define DIR_TREE_ORDER 16 // En küçük derece (t): kök dışındaki düğümlerde t-1..2t-1 anahtar
+#define DIR_NODE_KEYS (2 * DIR_TREE_ORDER - 1)
+#define DIR_TREE_MAX_DEPTH 32 // Doğrulamada bozuk (döngülü) ağaçları yakalamak için
+
+#define DIR_NODE_USED 0x1 // Düğüm tablodaki kayıt kullanımda
+#define DIR_NODE_LEAF 0x2
+
+typedef struct {
+    int32_t parent; // Girdinin bulunduğu dizinin tablo indeksi (FS_ROOT_DIR = kök)
+    int32_t slot;   // Girdinin dosya tablosundaki indeksi
+    char name[FILENAME_LEN];
+} DirKey;
+
+typedef struct {
+    uint32_t flags;
+    uint32_t count; // Anahtar sayısı; yaprak olmayan düğümde count + 1 çocuk vardır
+    DirKey keys[DIR_NODE_KEYS];
+    int32_t children[DIR_NODE_KEYS + 1];
+} DirNode;
+
+// Düğüm tablosuna erişim. Düğüm ayırmak tabloyu büyütüp 'nodes'u değiştirebileceği için
+// ağaç kodu düğümleri her zaman indeksle tutar.
+typedef struct DirTree {
+    DirNode* nodes;
+    uint32_t capacity;
+    int32_t root;
+    int (*alloc_node)(struct DirTree* tree); // Sıfırlanmış, kullanımda işaretli düğüm (-1 = yer yok)
+    void (*free_node)(struct DirTree* tree, int index);
+    void (*mark_dirty)(struct DirTree* tree, int index); // Düğüm diske yazılmalı
+} DirTree;
+
+// Boş bir kök düğümü oluştur
+int dirtree_create(DirTree* tree);
+// Girdinin dosya tablosu indeksi; yoksa -1
+int dirtree_find(const DirTree* tree, int32_t parent, const char* name);
+// Anahtar ağaçta olmamalı. Düğüm ayrılamazsa -1 döner; ağaç yine de geçerli kalır.
+int dirtree_insert(DirTree* tree, int32_t parent, const char* name, int32_t slot);
+// Anahtar yoksa -1
+int dirtree_remove(DirTree* tree, int32_t parent, const char* name);
+// 'parent' dizininde adı 'after'dan büyük (NULL = baştan) ve 'prefix' ile başlayan (NULL = hepsi)
+// en fazla 'max' girdiyi ada göre sıralı olarak out'a yaz; yazılan girdi sayısını döner. Önekli
+// girdiler ağaçta ardışık durduğundan tarama doğrudan ilk eşleşmeden başlar ve son eşleşmede biter.
+int dirtree_scan(const DirTree* tree, int32_t parent, const char* after, const char* prefix, DirKey* out, int max);
+// Ağacın yapısını doğrula (sıralama, düğüm doluluğu, yaprakların eşit derinliği) ve her
+// anahtar için visit'i çağır. Anahtar sayısını, ağaç bozuksa -1 döner.
+int64_t dirtree_verify(const DirTree* tree, void (*visit)(const DirKey* key, void* context), void* context);
+
+#endif
@@ -1,448 +1,3509 @@
+#define _GNU_SOURCE // copy_file_range için
 #include "fs.h"
+#include "journal.h"
+#include "backup.h"
+#include "crc32c.h"
+#include "oplog.h"
+#include "dirtree.h"
+#include "memdiff.h"
+#include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
-static FileEntry file_table[MAX_FILES];
+// Yeni alanlar eski dolgu baytlarına yerleştirildi; tablo düzeni sürümler arasında aynı kalır
+_Static_assert(sizeof(FileEntry) == 64, "FileEntry boyutu disk bicimiyle uyumlu olmali");
+
+// Akış halinde okumada çekirdek içi kopyalama yapılamazsa kullanılan tampon boyutu
+#define STREAM_CHUNK_SIZE (256 * 1024)
+// Host dosyası içe aktarılırken tek seferde okunan en büyük parça
+#define IMPORT_CHUNK_SIZE (4 * 1024 * 1024)
+
+static Superblock superblock;
+static bool superblock_dirty = false;
+
+// Dosya tablosu formatlama sırasında seçilen kapasiteyle ayrılır, dolunca büyütülür
+static FileEntry* file_table = NULL;
+// Bu indeksten önceki tüm girdiler dolu (boş girdi aramasının başlangıcı)
+static int free_slot_hint = 0;
+// Diske yazılmayı bekleyen (değişmiş) dosya girdileri; her bit bir tablo girdisi
+static uint64_t* dirty_entries = NULL;
+
+// Extent tablosu: tüm dosyaların extent kayıtları, dosya tablosu gibi büyütülebilir
+static Extent* extent_table = NULL;
+static int free_extent_hint = 0;
+static uint64_t* dirty_extents = NULL;
+
+// Disk geometrisi superblock'ta saklanır: formatlarken seçilir, bağlanırken okunur.
+// Blok başına tutulan aşağıdaki diziler geometri belirlenince set_geometry ile ayrılır.
+// Bayt ofseti hesaplamaları (blok * block_size) çok GB'lık disklerde taşmasın diye 64 bit tutulur.
+static off_t disk_size = DEFAULT_DISK_SIZE;
+static off_t block_size = DEFAULT_BLOCK_SIZE;
+static int total_blocks = 0;
+static int bitmap_words = 0; // total_blocks / 64 (blok sayısı her zaman 64'ün katıdır)
+
+// Boş alan bitmap'i: her bit bir bloğu temsil eder (1 = dolu, 0 = boş).
+// Diskte superblock'ta kayıtlı bitmap alanında saklanır.
+static uint64_t* block_bitmap = NULL;
+static int free_block_count = 0;
+// Bu kelimeden önceki tüm kelimeler dolu (first-fit aramasının başlangıcı)
+static int bitmap_hint = 0;
+// Diske yazılmayı bekleyen bitmap kelimeleri; her bit bir bitmap kelimesi
+static uint64_t* bitmap_dirty_words = NULL;
+
+// Her bloğu gösteren extent sayısı. Diske yazılmaz; bağlanırken extent'lerden hesaplanır.
+// 1'den büyükse blok reflink kopyalarıyla paylaşılıyordur.
+static uint16_t* block_refs = NULL;
+static int copy_mode = DEFAULT_COPY_MODE;
+
+// Her bloğun içeriğinin CRC32C değeri; diskte checksum alanında tutulur. Yalnızca
+// dosyalara ait bloklar için anlamlıdır ve bloğa her yazıldığında güncellenir.
+static uint32_t* block_checksums = NULL;
+// Diske yazılmayı bekleyen sağlama toplamları; her bit bir blok
+static uint64_t* checksum_dirty = NULL;
+static bool verify_reads = DEFAULT_VERIFY_READS;
+
+// İşlem commit edilene kadar serbest bırakılmayan blok aralıkları. Silinen
+// dosyanın blokları, silme kalıcı olmadan başka bir dosyaya verilip ezilmemeli.
+typedef struct {
+    int first;
+    int count;
+} BlockRange;
+
+static BlockRange* pending_frees = NULL;
+static int pending_free_count = 0;
+static int pending_free_capacity = 0;
+static bool pending_frees_lost = false; // Kaydedilemeyen serbest bırakma var; commit'te bitmap yeniden kurulur
+
+// Son yedek neslinden sonra yazılan ya da ayrılan bloklar (artımlı yedek için).
+// Temiz kapanışta CHANGES_FILE dosyasına kaydedilir, açılışta geri okunur.
+static uint64_t* changed_blocks = NULL;
+static uint64_t backup_chain_id = 0;
+static uint32_t backup_generation = 0; // 0 = bu disk için bilinen bir yedek yok
+static char backup_parent[BACKUP_PATH_LEN];
+
+// Kayıt dosyasında başlığı bitmap_words kelimelik değişen blok bitmap'i izler
+typedef struct {
+    uint32_t magic;
+    uint32_t generation;
+    uint64_t chain_id;
+    char parent[BACKUP_PATH_LEN];
+    uint64_t disk_size;
+    uint32_t block_size;
+    uint32_t reserved;
+} ChangeRecord;
+
+#define CHANGES_MAGIC 0x324E4843 // "CHN2"
+
+// Metadata günlüğü ve grup commit durumu
+static Journal journal;
+static int group_commit_ops = DEFAULT_GROUP_COMMIT_OPS;
+static int group_commit_ms = DEFAULT_GROUP_COMMIT_MS;
+static int txn_op_count = 0;
+static struct timespec txn_started;
+
+// Dizin ağacı: tüm dizinlerin girdileri (üst dizin, ad) anahtarlı tek bir B-ağacında.
+// Düğüm tablosu extent tablosu gibi büyütülebilir; kök düğümün indeksi superblock'ta tutulur.
+static int alloc_dir_node(DirTree* tree);
+static void free_dir_node(DirTree* tree, int index);
+static void mark_dir_node_dirty(DirTree* tree, int index);
+static DirTree dir_tree = {.root = -1, .alloc_node = alloc_dir_node, .free_node = free_dir_node, .mark_dirty = mark_dir_node_dirty};
+static int free_dir_node_hint = 0;
+static uint64_t* dirty_dir_nodes = NULL;
+
+// Dentry önbelleği: (üst dizin, ad) hash'i -> tablo indeksi. Her kova hash'in üst 32 bitini
+// ve indeksi tek bir 64 bitlik kelimede tutar; okuma kilidi altındaki eşzamanlı okuyucular
+// kovaları atomik olarak okuyup yazar. Kayıtlar geçersiz kılınmaz: isabet her zaman dosya
+// tablosundaki girdiyle doğrulanır, eski ya da çakışan bir kova yalnızca ıskalamaya yol açar.
+#define DENTRY_CACHE_SLOTS 4096
+static uint64_t dentry_cache[DENTRY_CACHE_SLOTS];
 
 // Başta -1 çünkü henüz atama yapılmadı
 static int disk_fd = -1;
-static int log_fd = -1;
 
-// disk.sim içinden metadatayı al, hafızaya yükle
-static int load_metadata() {
-    lseek(disk_fd, 0, SEEK_SET);
-    return (int) read(disk_fd, file_table, sizeof(file_table));
+// mmap modunda disk.sim'in bellekteki eşlemesi ve son commit'ten beri
+// değişen bayt aralığı (commit sırasında yalnızca bu aralık msync edilir)
+static int io_mode = DEFAULT_IO_MODE;
+static char* disk_map = NULL;
+static off_t map_dirty_start = DEFAULT_DISK_SIZE;
+static off_t map_dirty_end = 0;
+
+// Eşzamanlılık: metadata (dosya tablosu, dizin ağacı, bitmap, günlük) fs_lock ile korunur.
+// Değişiklik yapan işlemler fs_lock'u yazma modunda alır. Okuyucular dosyanın yerini
+// okuma kilidi altında bulur, dosyanın kilidini alır ve veriyi okumadan önce fs_lock'u
+// bırakır; böylece farklı dosyaları okuyan iş parçacıkları birbirini beklemez.
+// Dosya kilitleri tablo indeksine göre şeritlenmiştir. Kilit sırası her zaman
+// önce fs_lock, sonra dosya kilitleri (artan şerit sırasıyla) şeklindedir.
+#define FILE_LOCK_STRIPES 64
+
+static pthread_rwlock_t fs_lock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_rwlock_t file_locks[FILE_LOCK_STRIPES];
+static pthread_once_t file_locks_once = PTHREAD_ONCE_INIT;
+// Yazma işleminin o an tuttuğu dosya kilitleri; fs_lock yazma modunda tutulduğu için tek kopya yeterli
+static uint64_t held_file_locks = 0;
+
+static int find_free_blocks(int required_blocks);
+static void bitmap_rebuild();
+static void rebuild_block_refs();
+static int rebuild_checksums();
+static int format_unlocked(int max_files, uint64_t size, int bsize);
+static void load_change_record();
+
+static void init_file_locks() {
+    for (int i = 0; i < FILE_LOCK_STRIPES; i++) pthread_rwlock_init(&file_locks[i], NULL);
 }
 
-// Hafızada tutulan metadatayı disk.sim içine kaydet
-static int save_metadata() {
-    lseek(disk_fd, 0, SEEK_SET);
-    return (int) write(disk_fd, file_table, sizeof(file_table));
+// Değişiklik yapan işlemin başı ve sonu; işlem sırasında alınan dosya kilitleri sonda bırakılır
+static void begin_update() {
+    pthread_once(&file_locks_once, init_file_locks);
+    pthread_rwlock_wrlock(&fs_lock);
+}
+
+static void end_update() {
+    while (held_file_locks) {
+        int stripe = __builtin_ctzll(held_file_locks);
+        held_file_locks &= held_file_locks - 1;
+        pthread_rwlock_unlock(&file_locks[stripe]);
+    }
+    pthread_rwlock_unlock(&fs_lock);
+}
+
+static void begin_read() {
+    pthread_once(&file_locks_once, init_file_locks);
+    pthread_rwlock_rdlock(&fs_lock);
+}
+
+static void end_read() { pthread_rwlock_unlock(&fs_lock); }
+
+// Dosyanın verisine ya da yerine dokunmadan önce çağrılır (yalnızca begin_update içinde)
+static void lock_file_exclusive(int slot) {
+    int stripe = slot % FILE_LOCK_STRIPES;
+    if (held_file_locks & (1ULL << stripe)) return;
+    pthread_rwlock_wrlock(&file_locks[stripe]);
+    held_file_locks |= 1ULL << stripe;
+}
+
+// Tüm diski yeniden yazan işlemler (formatlama, geri yükleme) için
+static void lock_all_files() {
+    for (int i = 0; i < FILE_LOCK_STRIPES; i++) lock_file_exclusive(i);
+}
+
+static int lock_file_shared(int slot) {
+    int stripe = slot % FILE_LOCK_STRIPES;
+    pthread_rwlock_rdlock(&file_locks[stripe]);
+    return stripe;
+}
+
+// Disk dosyasını belleğe eşle. Eşleme tüm disk boyutunu kapsadığından dosya kısaysa uzatılır.
+static int map_disk() {
+    if (io_mode != FS_IO_MMAP || disk_map) return 0;
+
+    struct stat st;
+    if (fstat(disk_fd, &st) != 0 || (st.st_size < disk_size && ftruncate(disk_fd, disk_size) != 0)) return -1;
+
+    void* map = mmap(NULL, disk_size, PROT_READ | PROT_WRITE, MAP_SHARED, disk_fd, 0);
+    if (map == MAP_FAILED) {
+        write(STDOUT_FILENO, "Disk dosyasi bellege eslenemedi.\n", 33);
+        return -1;
+    }
+    disk_map = map;
+    return 0;
+}
+
+static void unmap_disk() {
+    if (!disk_map) return;
+    munmap(disk_map, disk_size);
+    disk_map = NULL;
+    map_dirty_start = disk_size;
+    map_dirty_end = 0;
+}
+
+// Disk üzerindeki bir bölgeye doğrudan erişim; yalnızca mmap modunda mümkündür
+static char* disk_at(off_t offset) { return disk_map ? disk_map + offset : NULL; }
+
+static void mark_map_dirty(off_t offset, off_t size) {
+    if (offset < map_dirty_start) map_dirty_start = offset;
+    if (offset + size > map_dirty_end) map_dirty_end = offset + size;
+}
+
+// Bayt aralığının kapsadığı blokları son yedekten sonra değişmiş olarak işaretle
+static void mark_changed(off_t offset, off_t size) {
+    if (size <= 0) return;
+    int last = (offset + size - 1) / block_size;
+    for (int block = offset / block_size; block <= last && block < total_blocks; block++) {
+        changed_blocks[block / 64] |= 1ULL << (block % 64);
+    }
+}
+
+// Bayt aralığının kapsadığı blokların sağlama toplamlarını yeniden hesapla. 'data'
+// aralığa yazılan veridir; tamamı kapsanan bloklar ondan, kenardaki bloklar diskten okunur.
+static void update_checksums(off_t offset, off_t size, const char* data) {
+    if (size <= 0) return;
+    char block[block_size];
+    int last = (offset + size - 1) / block_size;
+    for (int b = offset / block_size; b <= last && b < total_blocks; b++) {
+        off_t start = (off_t) b * block_size;
+        const char* content = block;
+        if (data && start >= offset && start + block_size <= offset + size) {
+            content = data + (start - offset);
+        } else if (disk_map) {
+            content = disk_map + start;
+        } else if (pread(disk_fd, block, block_size, start) != block_size) {
+            memset(block, 0, block_size);
+        }
+        block_checksums[b] = crc32c(0, content, block_size);
+        checksum_dirty[b / 64] |= 1ULL << (b % 64);
+    }
+}
+
+// Blok hizalı bir kopyalamada hedef blokların sağlama toplamları kaynaktan alınır;
+// yalnızca kısmen kopyalanan son blok yeniden hesaplanır
+static void move_checksums(off_t dest, off_t src, off_t size) {
+    if (dest % block_size != 0 || src % block_size != 0) {
+        update_checksums(dest, size, NULL);
+        return;
+    }
+    int whole = size / block_size;
+    memmove(&block_checksums[dest / block_size], &block_checksums[src / block_size], whole * sizeof(uint32_t));
+    for (int b = dest / block_size; b < dest / block_size + whole; b++) checksum_dirty[b / 64] |= 1ULL << (b % 64);
+    update_checksums(dest + (off_t) whole * block_size, size - (off_t) whole * block_size, NULL);
+}
+
+static int disk_read(void* buffer, int size, off_t offset) {
+    if (disk_map) {
+        memcpy(buffer, disk_map + offset, size);
+        return size;
+    }
+    return (int) pread(disk_fd, buffer, size, offset);
+}
+
+static int disk_write(const void* data, int size, off_t offset) {
+    mark_changed(offset, size);
+    if (disk_map) {
+        memcpy(disk_map + offset, data, size);
+        mark_map_dirty(offset, size);
+        update_checksums(offset, size, data);
+        return size;
+    }
+    int written = (int) pwrite(disk_fd, data, size, offset);
+    if (written == size) update_checksums(offset, size, data);
+    return written;
+}
+
+// disk.sim seyrek tutulur: boş bloklar dosya sisteminde yer kaplamayan deliklerdir.
+// 'offset'ten sonraki ilk veri ya da delik konumu ('end' ile sınırlı). Dosya sistemi
+// SEEK_DATA/SEEK_HOLE desteklemiyorsa her yer veri sayılır.
+static off_t next_data(off_t offset, off_t end) {
+    off_t data = lseek(disk_fd, offset, SEEK_DATA);
+    if (data < 0) return errno == ENXIO ? end : offset;
+    return data < end ? data : end;
+}
+
+static off_t next_hole(off_t offset, off_t end) {
+    off_t hole = lseek(disk_fd, offset, SEEK_HOLE);
+    return hole < 0 || hole > end ? end : hole;
+}
+
+// Bayt aralığını delik yap; sayfa sınırına denk gelmeyen kenarlar sıfırla doldurulur
+static int punch_hole(off_t offset, off_t size) {
+    if (size <= 0) return 0;
+    return fallocate(disk_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, size);
+}
+
+// Disk üzerinde bir bölgeyi başka bir yere kopyala (bölgeler çakışabilir)
+static int copy_region(off_t dest, off_t src, int size) {
+    if (size <= 0) return 0;
+    mark_changed(dest, size);
+    if (disk_map) {
+        memmove(disk_map + dest, disk_map + src, size);
+        mark_map_dirty(dest, size);
+        move_checksums(dest, src, size);
+        return 0;
+    }
+
+    // Çakışmayan bölgeler çekirdek içinde kopyalanır; veri kullanıcı alanına taşınmaz
+    if (dest + size <= src || src + size <= dest) {
+        off_t from = src;
+        off_t to = dest;
+        int remaining = size;
+        while (remaining > 0) {
+            ssize_t n = copy_file_range(disk_fd, &from, disk_fd, &to, remaining, 0);
+            if (n <= 0) break;
+            remaining -= n;
+        }
+        if (remaining == 0) {
+            move_checksums(dest, src, size);
+            return 0;
+        }
+        // Kopyalanamayan kısım aşağıda parçalarla tamamlanır
+        move_checksums(dest, src, size - remaining);
+        src = from;
+        dest = to;
+        size = remaining;
+    }
+
+    // Desteklenmiyorsa sabit boyutlu parçalarla kopyalanır. Hedef kaynağın ilerisinde
+    // ve bölgeler çakışıyorsa kopyalama sondan başa doğru yapılır.
+    int chunk = size < STREAM_CHUNK_SIZE ? size : STREAM_CHUNK_SIZE;
+    char* content = malloc(chunk);
+    if (!content) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+    bool backwards = dest > src && dest < src + size;
+    int result = 0;
+    for (int done = 0; done < size && result == 0; done += chunk) {
+        int n = size - done < chunk ? size - done : chunk;
+        off_t from = backwards ? src + size - done - n : src + done;
+        off_t to = backwards ? dest + size - done - n : dest + done;
+        if (disk_read(content, n, from) != n || disk_write(content, n, to) != n) result = -1;
+    }
+    free(content);
+    return result;
+}
+
+// Bölgeyi kopyala; çakışmayan bölgelerde kaynaktaki delikler okunup yazılmaz, hedefte
+// de delik açılır. Böylece birleştirme ve kopyalama seyrek alanı doldurmaz.
+static int disk_move(off_t dest, off_t src, int size) {
+    if (size <= 0) return 0;
+    if (dest < src + size && src < dest + size) return copy_region(dest, src, size);
+
+    off_t end = src + size;
+    for (off_t from = src; from < end;) {
+        off_t data = next_data(from, end);
+        if (data > from) {
+            off_t to = dest + (from - src);
+            if (punch_hole(to, data - from) == 0) {
+                mark_changed(to, data - from);
+                move_checksums(to, from, data - from);
+            } else if (copy_region(to, from, data - from) < 0) {
+                return -1;
+            }
+            from = data;
+            continue;
+        }
+        off_t hole = next_hole(from, end);
+        if (hole <= from) hole = end;
+        if (copy_region(dest + (from - src), from, hole - from) < 0) return -1;
+        from = hole;
+    }
+    return 0;
+}
+
+// Eşleme üzerinden yapılan veri yazmalarını diske gönder (commit noktalarında)
+static int flush_mapped_data() {
+    if (!disk_map || map_dirty_end <= map_dirty_start) return 0;
+
+    long page = sysconf(_SC_PAGESIZE);
+    off_t start = map_dirty_start / page * page;
+    int result = msync(disk_map + start, map_dirty_end - start, MS_SYNC);
+    map_dirty_start = disk_size;
+    map_dirty_end = 0;
+    return result;
+}
+
+// Bir dosyanın diskte kapladığı blok sayısı (boş dosyalar da 1 blok ayırır)
+static int file_blocks(int size) { return (size + block_size - 1) / block_size; }
+
+// Verilen blok aralığını dolu ya da boş olarak işaretle (kelime kelime)
+static void bitmap_mark(int first, int count, bool used) {
+    int end = first + count;
+    if (first < 0 || end > total_blocks) return;
+
+    while (first < end) {
+        int word = first / 64;
+        int bit = first % 64;
+        int n = 64 - bit;
+        if (n > end - first) n = end - first;
+
+        uint64_t mask = (n == 64) ? ~0ULL : (((1ULL << n) - 1) << bit);
+        uint64_t old = block_bitmap[word];
+        block_bitmap[word] = used ? (old | mask) : (old & ~mask);
+        // Yeni ayrılan blokların eski içeriği yedekte olmayabilir
+        if (used) changed_blocks[word] |= mask;
+
+        // Boş blok sayacını yalnızca değişen bitler kadar güncelle
+        free_block_count -= __builtin_popcountll(block_bitmap[word] & mask) - __builtin_popcountll(old & mask);
+
+        if (!used && word < bitmap_hint) bitmap_hint = word;
+        bitmap_dirty_words[word / 64] |= 1ULL << (word % 64);
+        first += n;
+    }
+}
+
+// Verilen blok aralığının tamamen boş olup olmadığını kontrol et
+static bool bitmap_range_free(int first, int count) {
+    int end = first + count;
+    if (first < 0 || end > total_blocks) return false;
+
+    while (first < end) {
+        int bit = first % 64;
+        int n = 64 - bit;
+        if (n > end - first) n = end - first;
+
+        uint64_t mask = (n == 64) ? ~0ULL : (((1ULL << n) - 1) << bit);
+        if (block_bitmap[first / 64] & mask) return false;
+        first += n;
+    }
+    return true;
+}
+
+// Serbest kalan blokların diskteki alanını geri ver. Komşu bloklar da boşsa aralık sayfa
+// sınırlarına genişletilir; böylece kenar sayfalar sıfırla doldurulmak yerine boşaltılır.
+static void punch_free_blocks(int first, int count) {
+    long page = sysconf(_SC_PAGESIZE);
+    int align = page > block_size ? page / block_size : 1;
+    int start = first - first % align;
+    if (!bitmap_range_free(start, first - start)) start = first;
+    int end = first + count;
+    int aligned_end = (end + align - 1) / align * align;
+    if (aligned_end <= total_blocks && bitmap_range_free(end, aligned_end - end)) end = aligned_end;
+    punch_hole((off_t) start * block_size, (off_t) (end - start) * block_size);
+}
+
+// Bayt sayısını blok sayısına çevir (yukarı yuvarlayarak)
+static uint64_t bytes_to_blocks(uint64_t bytes) { return (bytes + block_size - 1) / block_size; }
+
+// Blok boyutu MIN_BLOCK_SIZE ile MAX_BLOCK_SIZE arasında 2'nin kuvveti olmalı; blok sayısı
+// bitmap kelimelerini tam dolduracak şekilde 64'ün katı ve int ile gösterilebilir olmalı
+static bool valid_geometry(uint64_t size, uint64_t bsize) {
+    if (bsize < MIN_BLOCK_SIZE || bsize > MAX_BLOCK_SIZE || (bsize & (bsize - 1)) != 0) return false;
+    if (size == 0 || size % (bsize * 64) != 0) return false;
+    return size / bsize <= INT_MAX;
+}
+
+// Disk geometrisini değiştir ve blok başına tutulan dizileri yeni boyutla ayır.
+// Dizilerin içeriği sıfırlanır; çağıran bitmap'i ve sağlama toplamlarını yeniden kurar.
+static int set_geometry(uint64_t size, uint64_t bsize) {
+    int blocks = size / bsize;
+    int words = blocks / 64;
+    if (block_bitmap && blocks == total_blocks && (off_t) bsize == block_size) return 0;
+
+    uint64_t* bitmap = calloc(words, sizeof(uint64_t));
+    uint64_t* bitmap_dirty = calloc((words + 63) / 64, sizeof(uint64_t));
+    uint16_t* refs = calloc(blocks, sizeof(uint16_t));
+    uint32_t* checksums = calloc(blocks, sizeof(uint32_t));
+    uint64_t* checksums_dirty = calloc(words, sizeof(uint64_t));
+    uint64_t* changed = calloc(words, sizeof(uint64_t));
+    if (!bitmap || !bitmap_dirty || !refs || !checksums || !checksums_dirty || !changed) {
+        free(bitmap);
+        free(bitmap_dirty);
+        free(refs);
+        free(checksums);
+        free(checksums_dirty);
+        free(changed);
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+
+    // Eski geometriyle alınmış yedekler bu diskin artımlı zincirine bağlanamaz
+    if (block_bitmap) backup_generation = 0;
+
+    free(block_bitmap);
+    free(bitmap_dirty_words);
+    free(block_refs);
+    free(block_checksums);
+    free(checksum_dirty);
+    free(changed_blocks);
+    block_bitmap = bitmap;
+    bitmap_dirty_words = bitmap_dirty;
+    block_refs = refs;
+    block_checksums = checksums;
+    checksum_dirty = checksums_dirty;
+    changed_blocks = changed;
+
+    disk_size = size;
+    block_size = bsize;
+    total_blocks = blocks;
+    bitmap_words = words;
+    return 0;
+}
+
+// Bitmap'i sıfırla; superblock, dosya tablosu ve bitmap alanları her zaman dolu sayılır
+static void bitmap_reset() {
+    memset(block_bitmap, 0, bitmap_words * sizeof(uint64_t));
+    free_block_count = total_blocks;
+    bitmap_hint = 0;
+    bitmap_mark(0, 1, true);
+    bitmap_mark(superblock.table_offset / block_size, superblock.table_blocks, true);
+    bitmap_mark(superblock.extent_offset / block_size, superblock.extent_blocks, true);
+    bitmap_mark(superblock.dir_offset / block_size, superblock.dir_blocks, true);
+    bitmap_mark(superblock.bitmap_offset / block_size, superblock.bitmap_blocks, true);
+    bitmap_mark(superblock.checksum_offset / block_size, superblock.checksum_blocks, true);
+    bitmap_mark(superblock.journal_offset / block_size, superblock.journal_blocks, true);
+    memset(bitmap_dirty_words, 0xFF, (bitmap_words + 63) / 64 * sizeof(uint64_t));
+    pending_free_count = 0;
+    pending_frees_lost = false;
+}
+
+// Blokları serbest bırak; asıl serbest bırakma açık işlem commit edilirken yapılır
+static void bitmap_release(int first, int count) {
+    if (count <= 0) return;
+    if (pending_free_count == pending_free_capacity) {
+        int capacity = pending_free_capacity ? pending_free_capacity * 2 : 64;
+        BlockRange* grown = realloc(pending_frees, capacity * sizeof(BlockRange));
+        if (!grown) {
+            // Bellek yoksa aralık kaydedilmez; commit bitmap'i extent'lerden yeniden kurar
+            pending_frees_lost = true;
+            return;
+        }
+        pending_frees = grown;
+        pending_free_capacity = capacity;
+    }
+    pending_frees[pending_free_count].first = first;
+    pending_frees[pending_free_count].count = count;
+    pending_free_count++;
+}
+
+// Extent'lere eklenen blokların referans sayısını artır
+static void ref_blocks(int first, int count) {
+    for (int b = first; b < first + count; b++) block_refs[b]++;
+}
+
+// Extent'ten çıkarılan blokların referansını düşür; artık hiçbir extent'in
+// göstermediği bloklar (ardışık diziler halinde) serbest bırakılır
+static void release_blocks(int first, int count) {
+    int run_start = -1;
+    for (int b = first; b < first + count; b++) {
+        if (block_refs[b] > 0) block_refs[b]--;
+        if (block_refs[b] == 0 && run_start < 0) run_start = b;
+        if (block_refs[b] != 0 && run_start >= 0) {
+            bitmap_release(run_start, b - run_start);
+            run_start = -1;
+        }
+    }
+    if (run_start >= 0) bitmap_release(run_start, first + count - run_start);
+}
+
+// Bitmap'i diskten yükle
+static int load_bitmap() {
+    ssize_t bytes = bitmap_words * sizeof(uint64_t);
+    if (pread(disk_fd, block_bitmap, bytes, superblock.bitmap_offset) != bytes) return -1;
+
+    free_block_count = 0;
+    for (int i = 0; i < bitmap_words; i++) {
+        free_block_count += 64 - __builtin_popcountll(block_bitmap[i]);
+    }
+    bitmap_hint = 0;
+    memset(bitmap_dirty_words, 0, (bitmap_words + 63) / 64 * sizeof(uint64_t));
+    pending_free_count = 0;
+    pending_frees_lost = false;
+    return 0;
+}
+
+// Dosya tablosunu verilen kapasiteye göre (yeniden) ayır; yeni girdiler sıfırlanır
+static int alloc_file_table(int capacity) {
+    int old_capacity = file_table ? (int) superblock.max_files : 0;
+    int old_words = (old_capacity + 63) / 64;
+    int words = (capacity + 63) / 64;
+
+    FileEntry* table = realloc(file_table, capacity * sizeof(FileEntry));
+    if (table) file_table = table;
+    uint64_t* dirty = realloc(dirty_entries, words * sizeof(uint64_t));
+    if (dirty) dirty_entries = dirty;
+    if (!table || !dirty) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+
+    if (capacity > old_capacity) memset(&table[old_capacity], 0, (capacity - old_capacity) * sizeof(FileEntry));
+    if (words > old_words) memset(&dirty[old_words], 0, (words - old_words) * sizeof(uint64_t));
+    superblock.max_files = capacity;
+    free_slot_hint = 0;
+    return 0;
+}
+
+// Extent tablosunu verilen kapasiteye göre (yeniden) ayır; yeni kayıtlar boş işaretlenir
+static int alloc_extent_table(int capacity) {
+    int old_capacity = extent_table ? (int) superblock.max_extents : 0;
+    int old_words = (old_capacity + 63) / 64;
+    int words = (capacity + 63) / 64;
+
+    Extent* table = realloc(extent_table, capacity * sizeof(Extent));
+    if (table) extent_table = table;
+    uint64_t* dirty = realloc(dirty_extents, words * sizeof(uint64_t));
+    if (dirty) dirty_extents = dirty;
+    if (!table || !dirty) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+
+    for (int i = old_capacity; i < capacity; i++) {
+        memset(&table[i], 0, sizeof(Extent));
+        table[i].next = -1;
+    }
+    if (words > old_words) memset(&dirty[old_words], 0, (words - old_words) * sizeof(uint64_t));
+    superblock.max_extents = capacity;
+    free_extent_hint = 0;
+    return 0;
+}
+
+// Dizin ağacının düğüm tablosunu verilen kapasiteye göre (yeniden) ayır; yeni düğümler boştur
+static int alloc_dir_table(int capacity) {
+    int old_capacity = dir_tree.nodes ? (int) superblock.max_dir_nodes : 0;
+    int old_words = (old_capacity + 63) / 64;
+    int words = (capacity + 63) / 64;
+
+    DirNode* table = realloc(dir_tree.nodes, capacity * sizeof(DirNode));
+    if (table) dir_tree.nodes = table;
+    uint64_t* dirty = realloc(dirty_dir_nodes, words * sizeof(uint64_t));
+    if (dirty) dirty_dir_nodes = dirty;
+    if (!table || !dirty) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+
+    if (capacity > old_capacity) memset(&table[old_capacity], 0, (capacity - old_capacity) * sizeof(DirNode));
+    if (words > old_words) memset(&dirty[old_words], 0, (words - old_words) * sizeof(uint64_t));
+    dir_tree.capacity = capacity;
+    superblock.max_dir_nodes = capacity;
+    free_dir_node_hint = 0;
+    return 0;
+}
+
+// Dosya tablosu kapasitesi için başlangıçtaki düğüm sayısı (büyüme sırasında kök için bir fazlası)
+static int dir_nodes_for(int max_files) { return max_files / FILES_PER_DIR_NODE + 2; }
+
+// Günlük alanının boyutu: diskin 1/32'si, en az 16 blok, en fazla MAX_JOURNAL_SIZE
+static uint64_t journal_blocks_for_disk(uint64_t size, uint64_t bsize) {
+    uint64_t blocks = size / bsize / 32;
+    if (blocks > MAX_JOURNAL_SIZE / bsize) blocks = MAX_JOURNAL_SIZE / bsize;
+    return blocks < 16 ? 16 : blocks;
+}
+
+// Verilen kapasite ve geometri için superblock'u yeni bir disk düzeniyle doldur:
+// [superblock][dosya tablosu][extent tablosu][dizin ağacı][bitmap][sağlama toplamları][günlük][veri blokları...]
+static bool layout_superblock(Superblock* sb, int max_files, uint64_t size, uint64_t bsize) {
+    uint64_t blocks = size / bsize;
+    memset(sb, 0, sizeof(*sb));
+    sb->magic = FS_MAGIC;
+    sb->version = FS_VERSION;
+    sb->block_size = bsize;
+    sb->max_files = max_files;
+    sb->disk_size = size;
+    sb->table_offset = bsize;
+    sb->table_blocks = ((uint64_t) max_files * sizeof(FileEntry) + bsize - 1) / bsize;
+    sb->max_extents = max_files * EXTENTS_PER_FILE;
+    sb->extent_offset = sb->table_offset + sb->table_blocks * bsize;
+    sb->extent_blocks = ((uint64_t) sb->max_extents * sizeof(Extent) + bsize - 1) / bsize;
+    sb->max_dir_nodes = dir_nodes_for(max_files);
+    sb->dir_offset = sb->extent_offset + sb->extent_blocks * bsize;
+    sb->dir_blocks = ((uint64_t) sb->max_dir_nodes * sizeof(DirNode) + bsize - 1) / bsize;
+    sb->bitmap_offset = sb->dir_offset + sb->dir_blocks * bsize;
+    sb->bitmap_blocks = (blocks / 64 * sizeof(uint64_t) + bsize - 1) / bsize;
+    sb->checksum_offset = sb->bitmap_offset + sb->bitmap_blocks * bsize;
+    sb->checksum_blocks = (blocks * sizeof(uint32_t) + bsize - 1) / bsize;
+    sb->journal_offset = sb->checksum_offset + sb->checksum_blocks * bsize;
+    sb->journal_blocks = journal_blocks_for_disk(size, bsize);
+
+    // Metadata alanlarından sonra en az bir veri bloğu kalmalı
+    return sb->journal_offset + (sb->journal_blocks + 1) * bsize <= size;
+}
+
+// FNV-1a; (üst dizin, ad) çifti üzerinden. Ad FILENAME_LEN karakterde kesilir.
+static uint32_t hash_entry(int dir, const char* name) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 4; i++) {
+        hash ^= ((uint32_t) dir >> (i * 8)) & 0xFF;
+        hash *= 16777619u;
+    }
+    for (int i = 0; i < FILENAME_LEN && name[i] != '\0'; i++) {
+        hash ^= (unsigned char) name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Dizindeki girdiyi bul (yoksa -1): önce dentry önbelleğine, ıskalanırsa dizin ağacına bakılır
+static int lookup_entry(int dir, const char* name) {
+    uint32_t hash = hash_entry(dir, name);
+    uint64_t* bucket = &dentry_cache[hash % DENTRY_CACHE_SLOTS];
+    uint64_t cached = __atomic_load_n(bucket, __ATOMIC_RELAXED);
+    if ((uint32_t) (cached >> 32) == hash) {
+        int slot = (int) (uint32_t) cached;
+        if (slot < (int) superblock.max_files && file_table[slot].valid && file_table[slot].parent == dir &&
+            strncmp(file_table[slot].name, name, FILENAME_LEN) == 0) {
+            return slot;
+        }
+    }
+
+    int slot = dir_tree.nodes ? dirtree_find(&dir_tree, dir, name) : -1;
+    if (slot >= 0) __atomic_store_n(bucket, (uint64_t) hash << 32 | (uint32_t) slot, __ATOMIC_RELAXED);
+    return slot;
+}
+
+// Yol çözümlemesinin sonucu
+#define PATH_OK 0
+#define PATH_NOT_FOUND -1 // Ara dizinlerden biri yok
+#define PATH_NOT_DIR -2   // Ara bileşenlerden biri dizin değil
+#define PATH_TOO_LONG -3  // Bileşen FILENAME_LEN - 1 karakterden uzun
+
+// Yolu '/' ile ayrılmış bileşenlerine ayırıp dizinler boyunca ilerle. Son bileşenin bulunduğu
+// dizin *dir'e, adı name'e yazılır; yol bir dizinin kendisini gösteriyorsa ("/", "a/..") name
+// boş kalır. "." atlanır, ".." üst dizine çıkar (kökün üstü yine köktür).
+static int walk_path(const char* path, int* dir, char name[FILENAME_LEN]) {
+    int current = FS_ROOT_DIR;
+    name[0] = '\0';
+    while (*path) {
+        if (*path == '/') {
+            path++;
+            continue;
+        }
+        const char* end = strchr(path, '/');
+        size_t length = end ? (size_t) (end - path) : strlen(path);
+        if (length >= FILENAME_LEN) return PATH_TOO_LONG;
+
+        // Önceki bileşen bir ara dizindir
+        if (name[0] != '\0') {
+            int slot = lookup_entry(current, name);
+            if (slot < 0) return PATH_NOT_FOUND;
+            if (file_table[slot].type != FS_TYPE_DIR) return PATH_NOT_DIR;
+            current = slot;
+        }
+        memcpy(name, path, length);
+        name[length] = '\0';
+        if (strcmp(name, ".") == 0) {
+            name[0] = '\0';
+        } else if (strcmp(name, "..") == 0) {
+            if (current != FS_ROOT_DIR) current = file_table[current].parent;
+            name[0] = '\0';
+        }
+        path += length;
+    }
+    *dir = current;
+    return PATH_OK;
+}
+
+// Yolu tablo indeksine çözümle (bulunamazsa -1). Kök dizin tabloda olmadığı için bulunamaz.
+static int find_entry(const char* path) {
+    int dir;
+    char name[FILENAME_LEN];
+    if (walk_path(path, &dir, name) != PATH_OK) return -1;
+    return name[0] != '\0' ? lookup_entry(dir, name) : dir;
+}
+
+// find_entry ile aynı, ama yalnızca dosyaları bulur
+static int find_file(const char* path) {
+    int slot = find_entry(path);
+    return slot >= 0 && file_table[slot].type == FS_TYPE_FILE ? slot : -1;
+}
+
+// find_file ile aynı; dosya bulunamazsa ya da yol bir dizinse kullanıcıya mesaj gösterir
+static int resolve_file(const char* path) {
+    int slot = find_entry(path);
+    if (slot >= 0 && file_table[slot].type == FS_TYPE_FILE) return slot;
+
+    if (slot >= 0) write(STDOUT_FILENO, "Bir dizin, dosya degil: ", 24);
+    else write(STDOUT_FILENO, "Dosya bulunamadi: ", 18);
+    write(STDOUT_FILENO, path, strlen(path));
+    write(STDOUT_FILENO, "\n", 1);
+    return -1;
+}
+
+// Yolu bir dizine çözümle (kök için FS_ROOT_DIR); bulunamazsa mesaj gösterip -1 döner
+static int resolve_dir(const char* path, int* dir) {
+    char name[FILENAME_LEN];
+    bool found = walk_path(path, dir, name) == PATH_OK;
+    if (found && name[0] != '\0') {
+        *dir = lookup_entry(*dir, name);
+        found = *dir >= 0 && file_table[*dir].type == FS_TYPE_DIR;
+    }
+    if (!found) {
+        write(STDOUT_FILENO, "Dizin bulunamadi: ", 18);
+        write(STDOUT_FILENO, path, strlen(path));
+        write(STDOUT_FILENO, "\n", 1);
+        return -1;
+    }
+    return 0;
+}
+
+// Oluşturulacak girdinin dizinini ve adını çözümle. Dizin yoksa, ad geçersizse ya da
+// dizinde aynı adda bir girdi varsa mesaj gösterip -1 döner.
+static int resolve_new_entry(const char* path, int* dir, char name[FILENAME_LEN]) {
+    int result = walk_path(path, dir, name);
+    if (result == PATH_TOO_LONG) {
+        write(STDOUT_FILENO, "Dosya adi cok uzun (en fazla 31 karakter).\n", 43);
+        return -1;
+    }
+    if (result != PATH_OK) {
+        write(STDOUT_FILENO, "Hedef dizin bulunamadi: ", 24);
+        write(STDOUT_FILENO, path, strlen(path));
+        write(STDOUT_FILENO, "\n", 1);
+        return -1;
+    }
+    if (name[0] == '\0') {
+        write(STDOUT_FILENO, "Gecersiz dosya adi.\n", 20);
+        return -1;
+    }
+    if (lookup_entry(*dir, name) >= 0) {
+        write(STDOUT_FILENO, "Dosya zaten mevcut.\n", 20);
+        return -1;
+    }
+    return 0;
+}
+
+// Tablo girdisini diske yazılacak olarak işaretle
+static void mark_entry_dirty(int slot) { dirty_entries[slot / 64] |= 1ULL << (slot % 64); }
+static void mark_extent_dirty(int index) { dirty_extents[index / 64] |= 1ULL << (index % 64); }
+static void mark_dir_node_dirty(DirTree* tree, int index) {
+    (void) tree;
+    dirty_dir_nodes[index / 64] |= 1ULL << (index % 64);
+}
+
+// Bir tablonun ilk 'capacity' kaydını kirli olarak işaretle
+static void mark_all_dirty(uint64_t* words, int capacity) {
+    memset(words, 0xFF, (capacity / 64) * sizeof(uint64_t));
+    if (capacity % 64) words[capacity / 64] = (1ULL << (capacity % 64)) - 1;
+}
+
+// Tüm tabloları diske yazılacak olarak işaretle (formatlama ve dönüştürme sonrası)
+static void mark_all_entries_dirty() {
+    mark_all_dirty(dirty_entries, superblock.max_files);
+    mark_all_dirty(dirty_extents, superblock.max_extents);
+    mark_all_dirty(dirty_dir_nodes, superblock.max_dir_nodes);
+}
+
+// Bit dizisinde 'from' konumundan itibaren ilk ardışık 1 bit dizisini bul.
+// Dizinin başlangıcını döner ve uzunluğunu length'e yazar; dizi yoksa -1 döner.
+static int next_set_run(const uint64_t* words, int bit_count, int from, int* length) {
+    int word_count = (bit_count + 63) / 64;
+    int w = from / 64;
+    if (w >= word_count) return -1;
+
+    uint64_t word = words[w] & (~0ULL << (from % 64));
+    while (word == 0) {
+        if (++w >= word_count) return -1;
+        word = words[w];
+    }
+    int start = w * 64 + __builtin_ctzll(word);
+    if (start >= bit_count) return -1;
+
+    // Dizinin sonu: başlangıçtan sonraki ilk 0 bit
+    uint64_t inverse = ~words[w] & (~0ULL << (start % 64));
+    while (inverse == 0 && ++w < word_count) inverse = ~words[w];
+    int end = (w < word_count) ? w * 64 + __builtin_ctzll(inverse) : word_count * 64;
+    if (end > bit_count) end = bit_count;
+
+    *length = end - start;
+    return start;
+}
+
+// Hafızada değişen metadatayı açık işleme ekle: kirli girdiler, extent kayıtları, dizin
+// ağacı düğümleri, bitmap kelimeleri ve superblock. Ardışık kirli girdiler ve kelimeler tek kayıtta birleştirilir.
+static int collect_metadata() {
+    int length;
+    int slot = 0;
+    while ((slot = next_set_run(dirty_entries, superblock.max_files, slot, &length)) >= 0) {
+        uint64_t offset = superblock.table_offset + (uint64_t) slot * sizeof(FileEntry);
+        if (journal_add(&journal, offset, &file_table[slot], length * sizeof(FileEntry)) < 0) return -1;
+        slot += length;
+    }
+    memset(dirty_entries, 0, ((superblock.max_files + 63) / 64) * sizeof(uint64_t));
+
+    int index = 0;
+    while ((index = next_set_run(dirty_extents, superblock.max_extents, index, &length)) >= 0) {
+        uint64_t offset = superblock.extent_offset + (uint64_t) index * sizeof(Extent);
+        if (journal_add(&journal, offset, &extent_table[index], length * sizeof(Extent)) < 0) return -1;
+        index += length;
+    }
+    memset(dirty_extents, 0, ((superblock.max_extents + 63) / 64) * sizeof(uint64_t));
+
+    // Kök düğüm bölünme ya da birleştirmeyle değişmiş olabilir
+    if (superblock.version == FS_VERSION && superblock.dir_root != dir_tree.root) {
+        superblock.dir_root = dir_tree.root;
+        superblock_dirty = true;
+    }
+    int node = 0;
+    while ((node = next_set_run(dirty_dir_nodes, superblock.max_dir_nodes, node, &length)) >= 0) {
+        uint64_t offset = superblock.dir_offset + (uint64_t) node * sizeof(DirNode);
+        if (journal_add(&journal, offset, &dir_tree.nodes[node], length * sizeof(DirNode)) < 0) return -1;
+        node += length;
+    }
+    memset(dirty_dir_nodes, 0, ((superblock.max_dir_nodes + 63) / 64) * sizeof(uint64_t));
+
+    int word = 0;
+    while ((word = next_set_run(bitmap_dirty_words, bitmap_words, word, &length)) >= 0) {
+        uint64_t offset = superblock.bitmap_offset + (uint64_t) word * sizeof(uint64_t);
+        if (journal_add(&journal, offset, &block_bitmap[word], length * sizeof(uint64_t)) < 0) return -1;
+        word += length;
+    }
+    memset(bitmap_dirty_words, 0, (bitmap_words + 63) / 64 * sizeof(uint64_t));
+
+    int block = 0;
+    while ((block = next_set_run(checksum_dirty, total_blocks, block, &length)) >= 0) {
+        uint64_t offset = superblock.checksum_offset + (uint64_t) block * sizeof(uint32_t);
+        if (journal_add(&journal, offset, &block_checksums[block], length * sizeof(uint32_t)) < 0) return -1;
+        block += length;
+    }
+    memset(checksum_dirty, 0, bitmap_words * sizeof(uint64_t));
+
+    // Superblock en son kayıttır; böylece yeni yerine taşınan tablo ondan önce yazılır
+    if (superblock_dirty) {
+        if (journal_add(&journal, 0, &superblock, sizeof(superblock)) < 0) return -1;
+        superblock_dirty = false;
+    }
+    return 0;
+}
+
+// Açık işlemi commit et: ertelenen bloklar serbest bırakılır, değişen metadata
+// günlüğe yazılır ve tek bir fdatasync ile (o ana kadarki veri yazmalarıyla birlikte)
+// kalıcı hale gelir. Günlüğe sığmayacak kadar büyük işlemler doğrudan yazılır.
+static int commit_metadata() {
+    for (int i = 0; i < pending_free_count; i++) {
+        bitmap_mark(pending_frees[i].first, pending_frees[i].count, false);
+    }
+    int freed = pending_free_count;
+    pending_free_count = 0;
+    txn_op_count = 0;
+    if (pending_frees_lost) bitmap_rebuild();
+
+    if (collect_metadata() < 0) {
+        journal_discard(&journal);
+        write(STDOUT_FILENO, "Metadata gunluge eklenemedi.\n", 29);
+        return -1;
+    }
+
+    // Eşleme üzerinden yazılan veri, onu gösteren metadata'dan önce diske ulaşmalı
+    if (flush_mapped_data() < 0) {
+        journal_discard(&journal);
+        write(STDOUT_FILENO, "Disk eslemesi diske yazilamadi.\n", 32);
+        return -1;
+    }
+
+    int result = journal_fits(&journal) ? journal_commit(&journal) : journal_write_direct(&journal);
+    if (result < 0) {
+        journal_discard(&journal);
+        write(STDOUT_FILENO, "Metadata diske yazilamadi.\n", 27);
+        return result;
+    }
+
+    // Serbest bırakma artık kalıcı; eski içerik çökmeden sonra gerekmeyeceği için bloklar delinir
+    for (int i = 0; i < freed; i++) punch_free_blocks(pending_frees[i].first, pending_frees[i].count);
+    return result;
 }
 
-// Log sistemini başlat
-bool log_init() {
-    log_fd = open(LOG_FILE, O_WRONLY | O_CREAT | O_APPEND, 0666);
-    if (log_fd < 0) {
-        write(STDOUT_FILENO, "Log dosyasi acilamadi veya olusturulamadi\n", 43);
-        return false;
+// Grup commit zamanlayıcısı: açık işlem, arkasından yeni bir işlem gelmese de ilk
+// işlemin üzerinden group_commit_ms geçtiğinde bu iş parçacığı tarafından commit edilir
+static pthread_t commit_thread;
+static pthread_mutex_t commit_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t commit_cond = PTHREAD_COND_INITIALIZER;
+static bool commit_thread_running = false;
+static bool commit_thread_stopping = false;
+static bool commit_pending = false;     // Süresi beklenen açık bir işlem var
+static struct timespec commit_deadline; // CLOCK_REALTIME
+
+static void* commit_worker(void* arg) {
+    (void) arg;
+    pthread_mutex_lock(&commit_mutex);
+    while (!commit_thread_stopping) {
+        if (!commit_pending) {
+            pthread_cond_wait(&commit_cond, &commit_mutex);
+            continue;
+        }
+        if (pthread_cond_timedwait(&commit_cond, &commit_mutex, &commit_deadline) == 0) continue;
+
+        // Süre doldu. Bu arada başlayan yeni bir işlem erken commit edilebilir; bu zararsızdır.
+        commit_pending = false;
+        pthread_mutex_unlock(&commit_mutex);
+        begin_update();
+        if (disk_fd >= 0 && txn_op_count > 0) commit_metadata();
+        end_update();
+        pthread_mutex_lock(&commit_mutex);
+    }
+    pthread_mutex_unlock(&commit_mutex);
+    return NULL;
+}
+
+// Yeni açılan işlem için zamanlayıcıyı kur (fs_lock yazma modunda tutulurken çağrılır)
+static void schedule_commit() {
+    pthread_mutex_lock(&commit_mutex);
+    clock_gettime(CLOCK_REALTIME, &commit_deadline);
+    commit_deadline.tv_sec += group_commit_ms / 1000;
+    commit_deadline.tv_nsec += (long) (group_commit_ms % 1000) * 1000000;
+    if (commit_deadline.tv_nsec >= 1000000000) {
+        commit_deadline.tv_sec++;
+        commit_deadline.tv_nsec -= 1000000000;
+    }
+    commit_pending = true;
+    if (!commit_thread_running) {
+        commit_thread_stopping = false;
+        commit_thread_running = pthread_create(&commit_thread, NULL, commit_worker, NULL) == 0;
+    }
+    pthread_cond_signal(&commit_cond);
+    pthread_mutex_unlock(&commit_mutex);
+}
+
+// Zamanlayıcıyı durdur (fs_close'da, fs_lock alınmadan önce)
+static void stop_commit_thread() {
+    pthread_mutex_lock(&commit_mutex);
+    if (!commit_thread_running) {
+        pthread_mutex_unlock(&commit_mutex);
+        return;
+    }
+    commit_thread_stopping = true;
+    pthread_cond_broadcast(&commit_cond);
+    pthread_mutex_unlock(&commit_mutex);
+
+    pthread_join(commit_thread, NULL);
+
+    pthread_mutex_lock(&commit_mutex);
+    commit_thread_running = false;
+    commit_pending = false;
+    pthread_mutex_unlock(&commit_mutex);
+}
+
+// Bir işlem sonunda çağrılır. Değişiklikler hafızada açık işlemde birikir; grup
+// dolduğunda ya da ilk işlemin üzerinden yeterli süre geçtiğinde commit edilir.
+static int save_metadata() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    bool opened = txn_op_count++ == 0;
+    if (opened) txn_started = now;
+
+    long elapsed_ms = (now.tv_sec - txn_started.tv_sec) * 1000 + (now.tv_nsec - txn_started.tv_nsec) / 1000000;
+    if (txn_op_count >= group_commit_ops || elapsed_ms >= group_commit_ms) return commit_metadata();
+    if (opened) schedule_commit();
+    return 0;
+}
+
+// Tüm metadatayı günlüğü atlayarak doğrudan ev konumlarına yaz (formatlama ve dönüştürme)
+static int write_metadata_direct() {
+    journal_discard(&journal);
+    txn_op_count = 0;
+    if (collect_metadata() < 0 || journal_write_direct(&journal) < 0) {
+        journal_discard(&journal);
+        return -1;
+    }
+    return 0;
+}
+
+// Sürüm 0 imajındaki dosya girdisi: her dosya tek bir ardışık alanda tutulur
+typedef struct {
+    char name[FILENAME_LEN];
+    int size;
+    int start_block; // Bayt ofseti
+    time_t created_at;
+    bool valid;
+} LegacyFileEntry;
+
+// Sürüm 0 imajı (superblock yok, 64 girdilik tablo diskin başında) yeni düzene dönüştür.
+// Her dosyanın alanı tek bir extent olur. Yeni tablolar ve bitmap boş veri bloklarına
+// yazılır, superblock en son yazılır; böylece işlem yarıda kalırsa eski imaj bozulmadan kalır.
+static int migrate_legacy_image() {
+    LegacyFileEntry legacy[LEGACY_MAX_FILES];
+    memset(legacy, 0, sizeof(legacy));
+    pread(disk_fd, legacy, sizeof(legacy), 0);
+
+    uint64_t table_blocks = bytes_to_blocks(LEGACY_MAX_FILES * sizeof(FileEntry));
+    uint64_t extent_blocks = bytes_to_blocks(LEGACY_MAX_FILES * EXTENTS_PER_FILE * sizeof(Extent));
+    uint64_t bitmap_blocks = bytes_to_blocks(bitmap_words * sizeof(uint64_t));
+    uint64_t checksum_blocks = bytes_to_blocks(total_blocks * sizeof(uint32_t));
+    uint64_t journal_blocks = journal_blocks_for_disk(disk_size, block_size);
+
+    // Dizin ağacı, sürüm 4 imajlarında olduğu gibi ardından add_directory_tree ile eklenir
+    memset(&superblock, 0, sizeof(superblock));
+    superblock.magic = FS_MAGIC;
+    superblock.version = 4;
+    superblock.block_size = block_size;
+    superblock.disk_size = disk_size;
+
+    free(file_table);
+    file_table = NULL;
+    free(extent_table);
+    extent_table = NULL;
+    if (alloc_file_table(LEGACY_MAX_FILES) < 0 || alloc_extent_table(LEGACY_MAX_FILES * EXTENTS_PER_FILE) < 0) return -1;
+
+    int extent_count = 0;
+    for (int i = 0; i < LEGACY_MAX_FILES; i++) {
+        FileEntry* entry = &file_table[i];
+        memcpy(entry->name, legacy[i].name, FILENAME_LEN);
+        entry->size = legacy[i].size;
+        entry->created_at = legacy[i].created_at;
+        entry->valid = legacy[i].valid;
+        entry->first_extent = entry->last_extent = -1;
+        if (!entry->valid || entry->size <= 0) continue;
+
+        Extent* extent = &extent_table[extent_count];
+        extent->start = legacy[i].start_block / block_size;
+        extent->length = file_blocks(entry->size);
+        entry->first_extent = entry->last_extent = extent_count++;
+        entry->extent_count = 1;
+    }
+
+    // Önce yalnızca superblock ve dosyalar işaretlenir, metadata alanları boş alana yerleştirilir
+    bitmap_rebuild();
+    int start = find_free_blocks(table_blocks + extent_blocks + bitmap_blocks + checksum_blocks + journal_blocks);
+    if (start == -1) {
+        write(STDOUT_FILENO, "Eski disk imaji donusturulemedi: diskte bos alan yok.\n", 54);
+        return -1;
+    }
+    superblock.table_offset = start * block_size;
+    superblock.table_blocks = table_blocks;
+    superblock.extent_offset = superblock.table_offset + table_blocks * block_size;
+    superblock.extent_blocks = extent_blocks;
+    superblock.bitmap_offset = superblock.extent_offset + extent_blocks * block_size;
+    superblock.bitmap_blocks = bitmap_blocks;
+    superblock.checksum_offset = superblock.bitmap_offset + bitmap_blocks * block_size;
+    superblock.checksum_blocks = checksum_blocks;
+    superblock.journal_offset = superblock.checksum_offset + checksum_blocks * block_size;
+    superblock.journal_blocks = journal_blocks;
+    bitmap_rebuild();
+
+    memset(block_checksums, 0, total_blocks * sizeof(uint32_t));
+    if (rebuild_checksums() < 0) return -1;
+    memset(checksum_dirty, 0xFF, bitmap_words * sizeof(uint64_t));
+
+    journal_attach(&journal, disk_fd, superblock.journal_offset, journal_blocks * block_size, block_size, disk_size);
+    if (journal_format(&journal) < 0) return -1;
+
+    mark_all_entries_dirty();
+    if (write_metadata_direct() < 0) return -1;
+    superblock_dirty = true;
+    if (write_metadata_direct() < 0) return -1;
+
+    write(STDOUT_FILENO, "Eski disk imaji yeni surume donusturuldu.\n", 42);
+    return 0;
+}
+
+// Sürüm 3 imajına sağlama toplamı alanı ekle. Alan boş bloklara yerleştirilir, dosya
+// blokları için toplamlar hesaplanır ve yeni superblock'la birlikte tek işlemde commit edilir.
+static int add_checksum_region() {
+    uint64_t blocks = bytes_to_blocks(total_blocks * sizeof(uint32_t));
+    int start = find_free_blocks(blocks);
+    if (start < 0) {
+        write(STDOUT_FILENO, "Saglama toplami alani icin diskte bos alan yok.\n", 48);
+        return -1;
+    }
+    bitmap_mark(start, blocks, true);
+    superblock.checksum_offset = start * block_size;
+    superblock.checksum_blocks = blocks;
+    superblock.version = 4;
+    superblock_dirty = true;
+
+    memset(block_checksums, 0, total_blocks * sizeof(uint32_t));
+    if (rebuild_checksums() < 0) return -1;
+    memset(checksum_dirty, 0xFF, bitmap_words * sizeof(uint64_t));
+    if (commit_metadata() < 0) return -1;
+
+    write(STDOUT_FILENO, "Disk imajina blok saglama toplamlari eklendi.\n", 46);
+    return 0;
+}
+
+// Sürüm 4 imajına dizin ağacı ekle. Eski imajlarda dizin yoktur, tüm girdiler kök dizinde
+// dosya olur. Adlardaki '/' artık yol ayırıcısı olduğundan '_' ile değiştirilir; böylece
+// çakışan ya da geçersiz kalan adların sonuna '~' ve bir sayı eklenir. Ağaç boş bloklara
+// yazılır ve yeni superblock'la birlikte tek işlemde commit edilir.
+static int add_directory_tree() {
+    free(dir_tree.nodes);
+    dir_tree.nodes = NULL;
+    superblock.max_dir_nodes = 0;
+    if (alloc_dir_table(dir_nodes_for(superblock.max_files)) < 0) return -1;
+
+    uint64_t blocks = bytes_to_blocks((uint64_t) superblock.max_dir_nodes * sizeof(DirNode));
+    int start = find_free_blocks(blocks);
+    if (start < 0) {
+        write(STDOUT_FILENO, "Dizin agaci icin diskte bos alan yok.\n", 38);
+        return -1;
+    }
+    bitmap_mark(start, blocks, true);
+    superblock.dir_offset = start * block_size;
+    superblock.dir_blocks = blocks;
+    if (dirtree_create(&dir_tree) < 0) return -1;
+
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        FileEntry* entry = &file_table[i];
+        entry->type = FS_TYPE_FILE;
+        entry->parent = FS_ROOT_DIR;
+        if (!entry->valid) continue;
+
+        char original[FILENAME_LEN];
+        memcpy(original, entry->name, FILENAME_LEN);
+        original[FILENAME_LEN - 1] = '\0';
+        for (char* c = original; *c; c++) {
+            if (*c == '/') *c = '_';
+        }
+        strcpy(entry->name, original);
+        for (int n = 1; entry->name[0] == '\0' || strcmp(entry->name, ".") == 0 || strcmp(entry->name, "..") == 0 ||
+                        dirtree_find(&dir_tree, FS_ROOT_DIR, entry->name) >= 0;
+             n++) {
+            snprintf(entry->name, FILENAME_LEN, "%.20s~%d", original, n);
+        }
+        if (dirtree_insert(&dir_tree, FS_ROOT_DIR, entry->name, i) < 0) {
+            write(STDOUT_FILENO, "Dizin agaci olusturulamadi.\n", 28);
+            return -1;
+        }
+    }
+
+    // Tablonun kullanılmayan düğümleri de yazılır; alanın eski içeriği düğüm sayılmasın
+    mark_all_dirty(dirty_entries, superblock.max_files);
+    mark_all_dirty(dirty_dir_nodes, superblock.max_dir_nodes);
+    superblock.version = FS_VERSION;
+    superblock_dirty = true;
+    if (commit_metadata() < 0) return -1;
+
+    write(STDOUT_FILENO, "Disk imajina dizin agaci eklendi.\n", 34);
+    return 0;
+}
+
+// disk.sim içinden metadatayı al, hafızaya yükle
+static int load_metadata() {
+    Superblock sb;
+    if (pread(disk_fd, &sb, sizeof(sb), 0) != sizeof(sb) || sb.magic != FS_MAGIC) {
+        if (set_geometry(LEGACY_DISK_SIZE, LEGACY_BLOCK_SIZE) < 0 || migrate_legacy_image() < 0) return -1;
+        rebuild_block_refs();
+        return add_directory_tree();
+    }
+
+    // Sürüm 3 ve 4 imajları aynı düzene sahiptir; sürüm 3'te sağlama toplamı alanı,
+    // ikisinde de dizin ağacı eksiktir
+    if ((sb.version != FS_VERSION && sb.version != 4 && sb.version != 3) || !valid_geometry(sb.disk_size, sb.block_size)) {
+        write(STDOUT_FILENO, "Desteklenmeyen disk surumu veya geometrisi.\n", 44);
+        return -1;
+    }
+    if (set_geometry(sb.disk_size, sb.block_size) < 0) return -1;
+
+    // Yarıda kalan işlemler tamamlanır; günlük superblock'u da değiştirmiş olabilir
+    JournalReplayStats stats;
+    journal_attach(&journal, disk_fd, sb.journal_offset, sb.journal_blocks * block_size, block_size, disk_size);
+    if (journal_replay(&journal, &stats) < 0 || pread(disk_fd, &sb, sizeof(sb), 0) != sizeof(sb)) {
+        write(STDOUT_FILENO, "Gunluk yeniden oynatilamadi.\n", 29);
+        return -1;
+    }
+    if (stats.transactions > 0) {
+        char msg[160];
+        int len = snprintf(msg, sizeof(msg), "Gunluk yeniden oynatildi: %llu islem, %llu kayit, %llu bytes, %.3f ms\n",
+                           (unsigned long long) stats.transactions, (unsigned long long) stats.records,
+                           (unsigned long long) stats.bytes, stats.elapsed_ms);
+        write(STDOUT_FILENO, msg, len);
+    }
+
+    // Sürüm 3 superblock'unda bu alanlar yoktu (bloğun geri kalanı eski veri içerebilir)
+    if (sb.version == 3) {
+        sb.state = 0;
+        sb.checksum_offset = 0;
+        sb.checksum_blocks = 0;
+    }
+    if (sb.version != FS_VERSION) {
+        sb.dir_offset = 0;
+        sb.dir_blocks = 0;
+        sb.max_dir_nodes = 0;
+        sb.dir_root = 0;
+    } else if (sb.dir_root < 0 || sb.dir_root >= (int32_t) sb.max_dir_nodes) {
+        write(STDOUT_FILENO, "Disk metadatasi okunamadi.\n", 27);
+        return -1;
+    }
+    superblock = sb;
+    superblock_dirty = false;
+    txn_op_count = 0;
+    if (alloc_file_table(sb.max_files) < 0 || alloc_extent_table(sb.max_extents) < 0) return -1;
+    memset(dirty_entries, 0, ((sb.max_files + 63) / 64) * sizeof(uint64_t));
+    memset(dirty_extents, 0, ((sb.max_extents + 63) / 64) * sizeof(uint64_t));
+    if (sb.version == FS_VERSION) {
+        if (alloc_dir_table(sb.max_dir_nodes) < 0) return -1;
+        memset(dirty_dir_nodes, 0, ((sb.max_dir_nodes + 63) / 64) * sizeof(uint64_t));
+        dir_tree.root = sb.dir_root;
+    }
+
+    ssize_t bytes = (ssize_t) sb.max_files * sizeof(FileEntry);
+    ssize_t dir_bytes = (ssize_t) sb.max_dir_nodes * sizeof(DirNode);
+    ssize_t extent_bytes = (ssize_t) sb.max_extents * sizeof(Extent);
+    if (pread(disk_fd, file_table, bytes, sb.table_offset) != bytes ||
+        pread(disk_fd, extent_table, extent_bytes, sb.extent_offset) != extent_bytes || load_bitmap() < 0 ||
+        (sb.version == FS_VERSION && pread(disk_fd, dir_tree.nodes, dir_bytes, sb.dir_offset) != dir_bytes) ||
+        (sb.version != 3 && pread(disk_fd, block_checksums, total_blocks * sizeof(uint32_t), sb.checksum_offset) != (ssize_t) (total_blocks * sizeof(uint32_t)))) {
+        write(STDOUT_FILENO, "Disk metadatasi okunamadi.\n", 27);
+        return -1;
+    }
+    memset(checksum_dirty, 0, bitmap_words * sizeof(uint64_t));
+    rebuild_block_refs();
+    if (sb.version == 3 && add_checksum_region() < 0) return -1;
+    return sb.version == FS_VERSION ? 0 : add_directory_tree();
+}
+
+// Büyütülen bir metadata tablosunu boş bloklara doğrudan yaz ve eski alanını serbest bırak.
+// Yeni alan superblock commit edilene kadar kullanılmadığından eski imaj tutarlı kalır.
+static int relocate_table(const void* data, uint64_t bytes, uint64_t* offset, uint64_t* blocks) {
+    uint64_t new_blocks = bytes_to_blocks(bytes);
+    int start = find_free_blocks(new_blocks);
+    if (start == -1) return -1;
+    if (pwrite(disk_fd, data, bytes, start * block_size) != (ssize_t) bytes) return -1;
+
+    bitmap_release(*offset / block_size, *blocks);
+    bitmap_mark(start, new_blocks, true);
+    *offset = start * block_size;
+    *blocks = new_blocks;
+    superblock_dirty = true;
+    return 0;
+}
+
+// Dosya tablosu dolduğunda kapasiteyi iki katına çıkar. Superblock değişikliği
+// açık işlemle birlikte commit edilir.
+static int grow_file_table() {
+    int old_capacity = superblock.max_files;
+    int new_capacity = old_capacity * 2;
+    if (free_block_count < (int) bytes_to_blocks((uint64_t) new_capacity * sizeof(FileEntry))) return -1;
+    if (alloc_file_table(new_capacity) < 0) return -1;
+    if (relocate_table(file_table, (uint64_t) new_capacity * sizeof(FileEntry), &superblock.table_offset, &superblock.table_blocks) < 0) {
+        superblock.max_files = old_capacity;
+        return -1;
+    }
+
+    free_slot_hint = old_capacity;
+    return 0;
+}
+
+// Extent tablosu dolduğunda kapasiteyi iki katına çıkar
+static int grow_extent_table() {
+    int old_capacity = superblock.max_extents;
+    int new_capacity = old_capacity * 2;
+    if (free_block_count < (int) bytes_to_blocks((uint64_t) new_capacity * sizeof(Extent))) return -1;
+    if (alloc_extent_table(new_capacity) < 0) return -1;
+    if (relocate_table(extent_table, (uint64_t) new_capacity * sizeof(Extent), &superblock.extent_offset, &superblock.extent_blocks) < 0) {
+        superblock.max_extents = old_capacity;
+        return -1;
+    }
+
+    free_extent_hint = old_capacity;
+    return 0;
+}
+
+// Boş bir extent kaydı al (tablo doluysa büyütülür)
+static int alloc_extent() {
+    for (int i = free_extent_hint; i < (int) superblock.max_extents; i++) {
+        if (extent_table[i].length == 0) {
+            free_extent_hint = i + 1;
+            extent_table[i].flags = 0;
+            return i;
+        }
+    }
+    free_extent_hint = superblock.max_extents;
+    if (grow_extent_table() < 0) return -1;
+    return free_extent_hint++;
+}
+
+// Dizin ağacının düğüm tablosu dolduğunda kapasiteyi iki katına çıkar
+static int grow_dir_table() {
+    int old_capacity = superblock.max_dir_nodes;
+    int new_capacity = old_capacity * 2;
+    if (free_block_count < (int) bytes_to_blocks((uint64_t) new_capacity * sizeof(DirNode))) return -1;
+    if (alloc_dir_table(new_capacity) < 0) return -1;
+    if (relocate_table(dir_tree.nodes, (uint64_t) new_capacity * sizeof(DirNode), &superblock.dir_offset, &superblock.dir_blocks) < 0) {
+        superblock.max_dir_nodes = old_capacity;
+        dir_tree.capacity = old_capacity;
+        return -1;
+    }
+
+    free_dir_node_hint = old_capacity;
+    return 0;
+}
+
+// Ağaç için boş bir düğüm al (tablo doluysa büyütülür)
+static int alloc_dir_node(DirTree* tree) {
+    int index = -1;
+    for (int i = free_dir_node_hint; i < (int) superblock.max_dir_nodes; i++) {
+        if (!(tree->nodes[i].flags & DIR_NODE_USED)) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        free_dir_node_hint = superblock.max_dir_nodes;
+        if (grow_dir_table() < 0) return -1;
+        index = free_dir_node_hint;
+    }
+    free_dir_node_hint = index + 1;
+    memset(&tree->nodes[index], 0, sizeof(DirNode));
+    tree->nodes[index].flags = DIR_NODE_USED;
+    mark_dir_node_dirty(tree, index);
+    return index;
+}
+
+static void free_dir_node(DirTree* tree, int index) {
+    memset(&tree->nodes[index], 0, sizeof(DirNode));
+    mark_dir_node_dirty(tree, index);
+    if (index < free_dir_node_hint) free_dir_node_hint = index;
+}
+
+static void free_extent(int index) {
+    extent_table[index].start = 0;
+    extent_table[index].length = 0;
+    extent_table[index].next = -1;
+    extent_table[index].flags = 0;
+    mark_extent_dirty(index);
+    if (index < free_extent_hint) free_extent_hint = index;
+}
+
+// 'first' bloğundan başlayan boş blok sayısı (en fazla max)
+static int free_run_length(int first, int max) {
+    int length = 0;
+    while (length < max && first + length < total_blocks) {
+        int block = first + length;
+        uint64_t word = block_bitmap[block / 64] >> (block % 64);
+        if (word & 1) break;
+        length += word ? __builtin_ctzll(word) : 64 - block % 64;
+    }
+    return length < max ? length : max;
+}
+
+// En fazla 'wanted' bloklık boş bir alan bul. Tek parça yeterli alan yoksa en uzun
+// boş alan seçilir; uzunluk 'length'e yazılır, blok numarası döner (-1 = yer yok).
+static int find_free_run(int wanted, int* length) {
+    int start = find_free_blocks(wanted);
+    if (start >= 0) {
+        *length = wanted;
+        return start;
+    }
+
+    int best = -1;
+    int best_length = 0;
+    for (int block = bitmap_hint * 64; block < total_blocks;) {
+        uint64_t word = ~block_bitmap[block / 64] >> (block % 64);
+        if (word == 0) {
+            block += 64 - block % 64;
+            continue;
+        }
+        block += __builtin_ctzll(word);
+        int run = free_run_length(block, total_blocks);
+        if (run > best_length) {
+            best = block;
+            best_length = run;
+        }
+        block += run;
+    }
+    *length = best_length;
+    return best;
+}
+
+// Dosyanın sonuna 'count' blok ekle. Son extent'in ardındaki bloklar boşsa extent
+// yerinde uzatılır; kalan bloklar yeni extent'ler olarak eklenir. Dosya taşınmaz.
+static int extend_file(int slot, int count) {
+    if (count > free_block_count) return -1;
+
+    int last = file_table[slot].last_extent;
+    if (last >= 0) {
+        int end = extent_table[last].start + extent_table[last].length;
+        int grown = free_run_length(end, count);
+        if (grown > 0) {
+            bitmap_mark(end, grown, true);
+            ref_blocks(end, grown);
+            extent_table[last].length += grown;
+            mark_extent_dirty(last);
+            count -= grown;
+        }
+    }
+
+    while (count > 0) {
+        // Extent tablosu büyürken blok ayırabileceği için kayıt, alan aranmadan önce alınır
+        int index = alloc_extent();
+        if (index < 0) return -1;
+
+        int length;
+        int start = find_free_run(count, &length);
+        if (start < 0) {
+            free_extent(index);
+            return -1;
+        }
+        bitmap_mark(start, length, true);
+        ref_blocks(start, length);
+
+        FileEntry* entry = &file_table[slot];
+        extent_table[index].start = start;
+        extent_table[index].length = length;
+        extent_table[index].next = -1;
+        mark_extent_dirty(index);
+        if (entry->last_extent >= 0) {
+            extent_table[entry->last_extent].next = index;
+            mark_extent_dirty(entry->last_extent);
+        } else {
+            entry->first_extent = index;
+        }
+        entry->last_extent = index;
+        entry->extent_count++;
+        count -= length;
+    }
+    mark_entry_dirty(slot);
+    return 0;
+}
+
+// Dosyanın yalnızca ilk 'keep' bloğunu tut; kalan bloklar ve boşalan extent kayıtları serbest bırakılır
+static void trim_file(int slot, int keep) {
+    FileEntry* entry = &file_table[slot];
+    int blocks = 0;
+    int last = -1;
+    int count = 0;
+
+    for (int e = entry->first_extent; e >= 0;) {
+        Extent* extent = &extent_table[e];
+        int next = extent->next;
+        if (blocks >= keep) {
+            release_blocks(extent->start, extent->length);
+            free_extent(e);
+        } else {
+            if (blocks + (int) extent->length > keep) {
+                int kept = keep - blocks;
+                release_blocks(extent->start + kept, extent->length - kept);
+                extent->length = kept;
+                mark_extent_dirty(e);
+            }
+            blocks += extent->length;
+            last = e;
+            count++;
+        }
+        e = next;
+    }
+
+    if (last >= 0 && extent_table[last].next != -1) {
+        extent_table[last].next = -1;
+        mark_extent_dirty(last);
+    }
+    if (last < 0) entry->first_extent = -1;
+    entry->last_extent = last;
+    entry->extent_count = count;
+    mark_entry_dirty(slot);
+}
+
+// Dosyanın ayırdığı blokları yeni boyuta göre ayarla. Mevcut veri yerinde kalır.
+static int resize_file(int slot, int new_size) {
+    lock_file_exclusive(slot);
+    int old_blocks = file_blocks(file_table[slot].size);
+    int new_blocks = file_blocks(new_size);
+
+    if (new_blocks < old_blocks) trim_file(slot, new_blocks);
+    if (new_blocks > old_blocks && extend_file(slot, new_blocks - old_blocks) < 0) {
+        trim_file(slot, old_blocks);
+        write(STDOUT_FILENO, "Diskte yeterli bos alan bulunamadi.\n", 36);
+        return -1;
+    }
+    return 0;
+}
+
+// Extent'in blokları başka bir dosyayla hâlâ paylaşılıyor mu
+static bool extent_is_shared(int e) {
+    if (!(extent_table[e].flags & EXTENT_SHARED)) return false;
+    for (uint32_t b = extent_table[e].start; b < extent_table[e].start + extent_table[e].length; b++) {
+        if (block_refs[b] > 1) return true;
+    }
+    return false;
+}
+
+// Paylaşılan bir extent'i dosyaya özel yeni bloklara taşı (copy-on-write). Yeni alan
+// birden fazla parçadan oluşabilir; keep_data false ise extent'in tamamı zaten yeniden
+// yazılacağından eski içerik kopyalanmaz. Son parçanın indeksini döner (-1 = yer yok).
+static int unshare_extent(int slot, int prev, int e, bool keep_data) {
+    int length = extent_table[e].length;
+    int* pieces = malloc(length * sizeof(int));
+    if (!pieces) return -1;
+
+    // Önce tüm alan ayrılır; yetmezse hiçbir şey değiştirilmeden geri alınır
+    int count = 0;
+    for (int allocated = 0; allocated < length;) {
+        int index = alloc_extent();
+        int run = 0;
+        int start = index >= 0 ? find_free_run(length - allocated, &run) : -1;
+        if (start < 0) {
+            if (index >= 0) free_extent(index);
+            for (int k = 0; k < count; k++) {
+                bitmap_mark(extent_table[pieces[k]].start, extent_table[pieces[k]].length, false);
+                free_extent(pieces[k]);
+            }
+            free(pieces);
+            write(STDOUT_FILENO, "Diskte yeterli bos alan bulunamadi.\n", 36);
+            return -1;
+        }
+        bitmap_mark(start, run, true);
+        extent_table[index].start = start;
+        extent_table[index].length = run;
+        extent_table[index].flags = 0;
+        pieces[count++] = index;
+        allocated += run;
+    }
+
+    off_t source = (off_t) extent_table[e].start * block_size;
+    for (int k = 0; k < count; k++) {
+        Extent* piece = &extent_table[pieces[k]];
+        if (keep_data && disk_move((off_t) piece->start * block_size, source, piece->length * block_size) < 0) {
+            free(pieces);
+            return -1;
+        }
+        source += piece->length * block_size;
+        ref_blocks(piece->start, piece->length);
+        piece->next = k + 1 < count ? pieces[k + 1] : extent_table[e].next;
+        mark_extent_dirty(pieces[k]);
+    }
+
+    // Parçalar eski extent'in yerine zincire bağlanır
+    FileEntry* entry = &file_table[slot];
+    int last = pieces[count - 1];
+    if (prev >= 0) {
+        extent_table[prev].next = pieces[0];
+        mark_extent_dirty(prev);
+    } else {
+        entry->first_extent = pieces[0];
+    }
+    if (entry->last_extent == e) entry->last_extent = last;
+    entry->extent_count += count - 1;
+    mark_entry_dirty(slot);
+
+    release_blocks(extent_table[e].start, length);
+    free_extent(e);
+    free(pieces);
+    return last;
+}
+
+// Dosyanın [offset, offset + size) aralığına düşen paylaşılan extent'leri yazmadan önce ayır
+static int unshare_range(int slot, int offset, int size) {
+    int prev = -1;
+    int position = 0;
+    for (int e = file_table[slot].first_extent; e >= 0 && position < offset + size;) {
+        int bytes = extent_table[e].length * block_size;
+        int next = extent_table[e].next;
+        if (position + bytes > offset && extent_is_shared(e)) {
+            bool covered = offset <= position && position + bytes <= offset + size;
+            prev = unshare_extent(slot, prev, e, !covered);
+            if (prev < 0) return -1;
+        } else {
+            prev = e;
+        }
+        position += bytes;
+        e = next;
+    }
+    return 0;
+}
+
+// Kaynağın blokları bir referans daha alabilir mi; referans sayısı 16 bitlik sayaçta
+// tutulduğundan doymuş bloklar paylaşılamaz ve dosya verisi kopyalanır
+static bool can_reflink(int src) {
+    for (int e = file_table[src].first_extent; e >= 0; e = extent_table[e].next) {
+        for (uint32_t b = extent_table[e].start; b < extent_table[e].start + extent_table[e].length; b++) {
+            if (block_refs[b] == UINT16_MAX) return false;
+        }
+    }
+    return true;
+}
+
+// Hedef dosyaya kaynağın extent'lerinin kopyalarını ekle; bloklar iki dosya arasında
+// paylaşılır ve veri kopyalanmaz
+static int reflink_file(int src, int dest) {
+    for (int e = file_table[src].first_extent; e >= 0; e = extent_table[e].next) {
+        int index = alloc_extent();
+        if (index < 0) return -1;
+
+        FileEntry* entry = &file_table[dest];
+        extent_table[index].start = extent_table[e].start;
+        extent_table[index].length = extent_table[e].length;
+        extent_table[index].next = -1;
+        extent_table[index].flags = EXTENT_SHARED;
+        extent_table[e].flags |= EXTENT_SHARED;
+        ref_blocks(extent_table[e].start, extent_table[e].length);
+        mark_extent_dirty(index);
+        mark_extent_dirty(e);
+
+        if (entry->last_extent >= 0) {
+            extent_table[entry->last_extent].next = index;
+            mark_extent_dirty(entry->last_extent);
+        } else {
+            entry->first_extent = index;
+        }
+        entry->last_extent = index;
+        entry->extent_count++;
+    }
+    mark_entry_dirty(dest);
+    return 0;
+}
+
+// Dosya içindeki bir ofsetin düştüğü extent'i bul; extent içindeki bayt ofseti 'within'e yazılır
+static int seek_extent(int slot, int offset, int* within) {
+    int e = file_table[slot].first_extent;
+    while (e >= 0 && offset >= (int) extent_table[e].length * block_size) {
+        offset -= extent_table[e].length * block_size;
+        e = extent_table[e].next;
+    }
+    *within = offset;
+    return e;
+}
+
+// Dosyanın [offset, offset + size) aralığını extent'ler boyunca oku ya da yaz
+static int file_io(int slot, int offset, void* buffer, int size, bool writing) {
+    int within;
+    int e = seek_extent(slot, offset, &within);
+    int done = 0;
+
+    while (done < size && e >= 0) {
+        int chunk = extent_table[e].length * block_size - within;
+        if (chunk > size - done) chunk = size - done;
+        off_t position = (off_t) extent_table[e].start * block_size + within;
+        int result = writing ? disk_write((char*) buffer + done, chunk, position) : disk_read((char*) buffer + done, chunk, position);
+        if (result != chunk) return -1;
+        done += chunk;
+        within = 0;
+        e = extent_table[e].next;
+    }
+    return done;
+}
+
+// Dosyanın bir aralığının diskteki parçalarını topla. Okuyucular metadata kilidini
+// bırakmadan önce parçaları kopyalar; dönen dizi çağıran tarafından serbest bırakılır.
+typedef struct {
+    off_t position;
+    int length;
+} Segment;
+
+static Segment* file_segments(int slot, int offset, int size, int* count) {
+    Segment* segments = malloc((file_table[slot].extent_count + 1) * sizeof(Segment));
+    if (!segments) return NULL;
+
+    int within;
+    int e = seek_extent(slot, offset, &within);
+    int n = 0;
+    for (int done = 0; done < size && e >= 0; e = extent_table[e].next) {
+        int chunk = extent_table[e].length * block_size - within;
+        if (chunk > size - done) chunk = size - done;
+        segments[n].position = (off_t) extent_table[e].start * block_size + within;
+        segments[n].length = chunk;
+        n++;
+        done += chunk;
+        within = 0;
+    }
+    *count = n;
+    return segments;
+}
+
+// Toplanan parçaları sırayla tampona oku; okunan bayt sayısını döner
+static int read_segments(const Segment* segments, int count, char* buffer) {
+    int done = 0;
+    for (int k = 0; k < count; k++) {
+        if (disk_read(buffer + done, segments[k].length, segments[k].position) != segments[k].length) return -1;
+        done += segments[k].length;
+    }
+    return done;
+}
+
+// Parçaların kapsadığı blokları sağlama toplamlarıyla doğrula (okumada doğrulama açıksa).
+// Dosyanın paylaşımlı kilidi tutulurken çağrılır; bozuk blok bulunursa -1 döner.
+static int verify_segments(const Segment* segments, int count, const char* filename) {
+    char* buffer = NULL;
+    int result = 0;
+    for (int k = 0; k < count && result == 0; k++) {
+        int first = segments[k].position / block_size;
+        int end = (segments[k].position + segments[k].length + block_size - 1) / block_size;
+        for (int block = first; block < end && result == 0;) {
+            int blocks = end - block;
+            if (blocks > STREAM_CHUNK_SIZE / block_size) blocks = STREAM_CHUNK_SIZE / block_size;
+
+            const char* data = disk_at((off_t) block * block_size);
+            if (!data) {
+                if (!buffer && !(buffer = malloc(STREAM_CHUNK_SIZE))) {
+                    write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+                    return -1;
+                }
+                if (disk_read(buffer, blocks * block_size, (off_t) block * block_size) != blocks * block_size) {
+                    write(STDOUT_FILENO, "Dosya okuma hatasi.\n", 20);
+                    result = -1;
+                    break;
+                }
+                data = buffer;
+            }
+            for (int b = 0; b < blocks; b++) {
+                if (crc32c(0, data + (size_t) b * block_size, block_size) != block_checksums[block + b]) {
+                    char msg[FILENAME_LEN + 64];
+                    int len = snprintf(msg, sizeof(msg), "Hata: \"%s\" dosyasinin verisi bozuk (blok %d).\n", filename, block + b);
+                    write(STDOUT_FILENO, msg, len);
+                    result = -1;
+                    break;
+                }
+            }
+            block += blocks;
+        }
+    }
+    free(buffer);
+    return result;
+}
+
+// Tamponu tamamen doldur (kısmi okumalar ve sinyal kesintileri tekrarlanır); okunan
+// bayt sayısını döner, dosya sonunda daha az olabilir
+static ssize_t read_full(int fd, char* buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fd, buffer + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        if (n == 0) break;
+        done += n;
+    }
+    return done;
+}
+
+// Tamponun tamamını yaz (kısmi yazmalar ve sinyal kesintileri tekrarlanır)
+static int write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        data += n;
+        size -= n;
+    }
+    return 0;
+}
+
+// Parçaları sırayla bir dosya tanımlayıcısına aktar. mmap modunda eşlemeden doğrudan
+// yazılır; aksi halde önce copy_file_range, desteklenmezse sendfile denenir ve ikisi
+// de kullanılamıyorsa büyük, hizalı bir tamponla pread/write yapılır.
+static int stream_segments(const Segment* segments, int count, int out_fd) {
+    bool try_copy_range = true;
+    bool try_sendfile = true;
+    char* buffer = NULL;
+    int total = 0;
+
+    for (int k = 0; k < count; k++) {
+        off_t position = segments[k].position;
+        size_t remaining = segments[k].length;
+
+        if (disk_map) {
+            if (write_all(out_fd, disk_at(position), remaining) < 0) return -1;
+            total += remaining;
+            continue;
+        }
+
+        while (remaining > 0) {
+            ssize_t n = -1;
+            if (try_copy_range) {
+                n = copy_file_range(disk_fd, &position, out_fd, NULL, remaining, 0);
+                if (n <= 0) try_copy_range = false;
+            }
+            if (n <= 0 && try_sendfile) {
+                n = sendfile(out_fd, disk_fd, &position, remaining);
+                if (n <= 0) try_sendfile = false;
+            }
+            if (n <= 0) {
+                if (!buffer && posix_memalign((void**) &buffer, 4096, STREAM_CHUNK_SIZE) != 0) {
+                    write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+                    return -1;
+                }
+                size_t chunk = remaining < STREAM_CHUNK_SIZE ? remaining : STREAM_CHUNK_SIZE;
+                n = pread(disk_fd, buffer, chunk, position);
+                if (n <= 0 || write_all(out_fd, buffer, n) < 0) {
+                    free(buffer);
+                    return -1;
+                }
+                position += n;
+            }
+            remaining -= n;
+            total += n;
+        }
+    }
+
+    free(buffer);
+    return total;
+}
+
+// Superblock'u günlüğü atlayarak yerine yaz (yalnızca durum bayrağı değiştiğinde)
+static int write_superblock_state() {
+    if (pwrite(disk_fd, &superblock, sizeof(superblock), 0) != sizeof(superblock) || fdatasync(disk_fd) != 0) return -1;
+    return 0;
+}
+
+// Bağlanırken 'temiz' bayrağını kaldır. Bayrak yoksa disk düzgün kapatılmamıştır: son
+// commit'ten sonra yazılan blokların sağlama toplamları diske ulaşmamış olabileceği için
+// dosya bloklarının toplamları yeniden hesaplanır.
+static int mark_mounted() {
+    if (!(superblock.state & FS_STATE_CLEAN)) {
+        int changed = rebuild_checksums();
+        if (changed < 0 || commit_metadata() < 0) return -1;
+        if (changed > 0) {
+            char msg[128];
+            int len = snprintf(msg, sizeof(msg), "Disk duzgun kapatilmamis; %d blogun saglama toplami yeniden hesaplandi.\n", changed);
+            write(STDOUT_FILENO, msg, len);
+        }
+    }
+    superblock.state &= ~FS_STATE_CLEAN;
+    return write_superblock_state();
+}
+
+// Diski başlat (yoksa oluştur, varsa yükle)
+static bool init_unlocked() {
+    disk_fd = open(DISK_FILE, O_RDWR);
+    if (disk_fd < 0) {
+        disk_fd = open(DISK_FILE, O_RDWR | O_CREAT, 0666);
+        if (disk_fd < 0) {
+            write(STDOUT_FILENO, "Disk dosyasi acilamadi veya olusturulamadi\n", 43);
+            return false;
+        }
+    }
+
+    // Boş dosya yeni disk gibi formatlanır; eski değişiklik kaydı bu diske ait değildir
+    struct stat st;
+    if (fstat(disk_fd, &st) == 0 && st.st_size == 0) {
+        unlink(CHANGES_FILE);
+        return format_unlocked(DEFAULT_MAX_FILES, 0, 0) >= 0;
+    }
+
+    if (load_metadata() < 0 || map_disk() != 0) return false;
+    load_change_record();
+    return mark_mounted() == 0;
+}
+
+// Yeni dosya ya da dizin girdisi oluştur ve dizin ağacına ekle; girdinin tablo indeksini döner
+static int create_entry(const char* path, int type) {
+    int dir;
+    char name[FILENAME_LEN];
+    if (resolve_new_entry(path, &dir, name) < 0) return -1;
+
+    // Boş bir dosya girdisi bul
+    int free_slot = -1;
+    for (int i = free_slot_hint; i < (int) superblock.max_files; ++i) {
+        if (!file_table[i].valid) {
+            free_slot = i;
+            break;
+        }
+    }
+    free_slot_hint = free_slot == -1 ? (int) superblock.max_files : free_slot;
+
+    // Tablo doluysa kapasiteyi büyüt
+    if (free_slot == -1 && grow_file_table() == 0) free_slot = free_slot_hint;
+
+    if (free_slot == -1) {
+        write(STDOUT_FILENO, "Dosya tablosunda bos yer kalmadi.\n", 34);
+        return -1;
+    }
+    if (dirtree_insert(&dir_tree, dir, name, free_slot) < 0) {
+        write(STDOUT_FILENO, "Dizin agacinda yer kalmadi.\n", 28);
+        return -1;
+    }
+
+    // Dosya girdisini doldur; bloklar ilk yazmada extent olarak ayrılır
+    FileEntry* entry = &file_table[free_slot];
+    memset(entry, 0, sizeof(FileEntry));
+    strcpy(entry->name, name);
+    entry->first_extent = -1;
+    entry->last_extent = -1;
+    entry->created_at = time(NULL);
+    entry->valid = 1;
+    entry->type = type;
+    entry->parent = dir;
+    mark_entry_dirty(free_slot);
+    return free_slot;
+}
+
+// Girdiyi dizin ağacından çıkar ve tablo girdisini boşalt
+static void remove_entry(int slot) {
+    dirtree_remove(&dir_tree, file_table[slot].parent, file_table[slot].name);
+    if (slot < free_slot_hint) free_slot_hint = slot;
+    memset(&file_table[slot], 0, sizeof(FileEntry));
+    file_table[slot].first_extent = -1;
+    file_table[slot].last_extent = -1;
+    file_table[slot].parent = FS_ROOT_DIR;
+    mark_entry_dirty(slot);
+}
+
+// Yeni dosya oluştur
+static int create_unlocked(const char* filename) {
+    if (create_entry(filename, FS_TYPE_FILE) < 0) return -1;
+    return save_metadata();
+}
+
+// Dosyayı sil
+static int delete_unlocked(const char* filename) {
+    int i = resolve_file(filename);
+    if (i < 0) return -1;
+    lock_file_exclusive(i);
+
+    trim_file(i, 0);
+    remove_entry(i);
+    return save_metadata();
+}
+
+// Yeni dizin oluştur
+static int mkdir_unlocked(const char* path) {
+    if (create_entry(path, FS_TYPE_DIR) < 0) return -1;
+    return save_metadata();
+}
+
+// Boş dizini sil
+static int rmdir_unlocked(const char* path) {
+    int i = find_entry(path);
+    if (i < 0 || file_table[i].type != FS_TYPE_DIR) {
+        write(STDOUT_FILENO, "Dizin bulunamadi: ", 18);
+        write(STDOUT_FILENO, path, strlen(path));
+        write(STDOUT_FILENO, "\n", 1);
+        return -1;
+    }
+    DirKey first;
+    if (dirtree_scan(&dir_tree, i, NULL, NULL, &first, 1) > 0) {
+        write(STDOUT_FILENO, "Dizin bos degil.\n", 17);
+        return -1;
+    }
+
+    remove_entry(i);
+    return save_metadata();
+}
+
+// Dosya içine yaz
+static int write_unlocked(const char* filename, const char* data, int size) {
+    // Geçersiz veri kontrolü
+    if (data == NULL || size <= 0) {
+        write(STDOUT_FILENO, "Yazilacak veri bulunamadi.\n", 27);
+        return -1;
+    }
+
+    int i = resolve_file(filename);
+    if (i < 0) return -1;
+    lock_file_exclusive(i);
+
+    int old_size = file_table[i].size;
+    if (resize_file(i, size) < 0 || unshare_range(i, 0, size) < 0) return -1;
+    if (file_io(i, 0, (void*) data, size, true) != size) {
+        // Ayrılan bloklar eski boyuta göre geri ayarlanır; boyut yazılamayan baytları göstermez
+        resize_file(i, old_size);
+        write(STDOUT_FILENO, "Veri diske yazilamadi.\n", 23);
+        return -1;
+    }
+    file_table[i].size = size;
+    mark_entry_dirty(i);
+    return save_metadata();
+}
+
+// Dosyayı oku
+int fs_read(const char* filename, int offset, int size, char* buffer) {
+    begin_read();
+    int i = resolve_file(filename);
+    if (i < 0) {
+        end_read();
+        return -1;
+    }
+
+    if (offset + size > file_table[i].size) {
+        end_read();
+        write(STDOUT_FILENO, "Okuma dosya boyutunu asiyor.\n", 29);
+        return -1;
+    }
+
+    // Veri, dosyanın kilidi altında metadata kilidi bırakıldıktan sonra okunur
+    int count;
+    Segment* segments = file_segments(i, offset, size, &count);
+    if (!segments) {
+        end_read();
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+    bool verify = verify_reads;
+    int stripe = lock_file_shared(i);
+    end_read();
+
+    int result = verify && verify_segments(segments, count, filename) < 0 ? -1 : read_segments(segments, count, buffer);
+    pthread_rwlock_unlock(&file_locks[stripe]);
+    free(segments);
+    return result;
+}
+
+// Dosyanın bir aralığını tampon gerektirmeden doğrudan bir dosya tanımlayıcısına aktar.
+// Bellek kullanımı dosya boyutundan bağımsızdır; aktarılan bayt sayısını döner.
+int fs_read_to_fd(const char* filename, int offset, int size, int out_fd) {
+    begin_read();
+    int i = resolve_file(filename);
+    if (i < 0) {
+        end_read();
+        return -1;
+    }
+
+    if (offset < 0 || size < 0 || offset + size > file_table[i].size) {
+        end_read();
+        write(STDOUT_FILENO, "Okuma dosya boyutunu asiyor.\n", 29);
+        return -1;
+    }
+
+    int count;
+    Segment* segments = file_segments(i, offset, size, &count);
+    if (!segments) {
+        end_read();
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+    bool verify = verify_reads;
+    int stripe = lock_file_shared(i);
+    end_read();
+
+    int result = verify && verify_segments(segments, count, filename) < 0 ? -1 : stream_segments(segments, count, out_fd);
+    pthread_rwlock_unlock(&file_locks[stripe]);
+    free(segments);
+    return result;
+}
+
+// Dosyayı bir host dosyasına aktar (host dosyası yoksa oluşturulur, varsa üzerine yazılır).
+// Hedef baştan dosya boyutu kadar ayrılır; aktarılan bayt sayısını döner.
+int fs_export(const char* filename, const char* host_path) {
+    begin_read();
+    int i = resolve_file(filename);
+    if (i < 0) {
+        end_read();
+        return -1;
+    }
+
+    int size = file_table[i].size;
+    int count;
+    Segment* segments = file_segments(i, 0, size, &count);
+    if (!segments) {
+        end_read();
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+    bool verify = verify_reads;
+    int stripe = lock_file_shared(i);
+    end_read();
+
+    int result = -1;
+    int out_fd = open(host_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        write(STDOUT_FILENO, "Host dosyasi olusturulamadi.\n", 29);
+    } else {
+        if (size > 0) posix_fallocate(out_fd, 0, size);
+        if (!(verify && verify_segments(segments, count, filename) < 0)) result = stream_segments(segments, count, out_fd);
+        if (close(out_fd) != 0) result = -1;
+    }
+    pthread_rwlock_unlock(&file_locks[stripe]);
+    free(segments);
+    return result;
+}
+
+// Dizin listesi ağaçtan bu kadar girdilik parçalar halinde okunur ve yazdırılır
+#define LS_BATCH 64
+
+// İmleçten sonraki en fazla max girdiyi ağaçtan oku ve imleci ilerlet
+static int list_unlocked(int dir, const char* prefix, FsListCursor* cursor, FsDirEntry* entries, int max) {
+    DirKey keys[LS_BATCH];
+    int count = 0;
+    while (count < max && !cursor->done) {
+        int want = max - count < LS_BATCH ? max - count : LS_BATCH;
+        const char* after = cursor->last[0] != '\0' ? cursor->last : NULL;
+        int found = dirtree_scan(&dir_tree, dir, after, prefix, keys, want);
+        for (int k = 0; k < found; k++) {
+            const FileEntry* entry = &file_table[keys[k].slot];
+            FsDirEntry* out = &entries[count++];
+            memcpy(out->name, entry->name, FILENAME_LEN);
+            out->size = entry->size;
+            out->type = entry->type;
+            out->created_at = entry->created_at;
+        }
+        if (found > 0) memcpy(cursor->last, keys[found - 1].name, FILENAME_LEN);
+        if (found < want) cursor->done = true;
+    }
+    return count;
+}
+
+// Dizindeki dosyaları ada göre sıralı göster; alt dizinler '/' ile biter. Her sayfa
+// tek bir write ile yazılır.
+static void ls_unlocked(int dir, const char* prefix, bool is_called_from_menu) {
+    FsDirEntry entries[LS_BATCH];
+    char out[LS_BATCH * (FILENAME_LEN + 32)];
+    FsListCursor cursor = {0};
+    int count = list_unlocked(dir, prefix, &cursor, entries, LS_BATCH);
+
+    // Dosya yoksa ve menüden çağrıldıysa mesaj göster
+    if (count == 0) {
+        if (!is_called_from_menu) return;
+        if (prefix && prefix[0] != '\0') write(STDOUT_FILENO, "Onekle eslesen dosya bulunamadi.\n", 33);
+        else if (dir == FS_ROOT_DIR) write(STDOUT_FILENO, "Diskte dosya bulunamadi.\n", 25);
+        else write(STDOUT_FILENO, "Dizinde dosya bulunamadi.\n", 26);
+        return;
+    }
+
+    // Dosyalar varsa liste göster
+    if (dir == FS_ROOT_DIR) write(STDOUT_FILENO, "Diskteki Dosyalar:\n", 19);
+    else write(STDOUT_FILENO, "Dizindeki Dosyalar:\n", 20);
+    while (count > 0) {
+        size_t length = 0;
+        for (int k = 0; k < count; k++) {
+            const FsDirEntry* entry = &entries[k];
+            length += entry->type == FS_TYPE_DIR
+                ? (size_t) snprintf(out + length, sizeof(out) - length, " - %s/\n", entry->name)
+                : (size_t) snprintf(out + length, sizeof(out) - length, " - %s (%d bytes)\n", entry->name, entry->size);
+        }
+        write(STDOUT_FILENO, out, length);
+        count = list_unlocked(dir, prefix, &cursor, entries, LS_BATCH);
+    }
+}
+
+// Diski verilen dosya tablosu kapasitesiyle formatla
+static int format_unlocked(int max_files, uint64_t size, int bsize) {
+    if (max_files <= 0) max_files = DEFAULT_MAX_FILES;
+    if (size == 0) size = disk_size;
+    if (bsize <= 0) bsize = block_size;
+    if (!valid_geometry(size, bsize)) {
+        write(STDOUT_FILENO, "Gecersiz disk geometrisi: blok boyutu 512-65536 arasi 2'nin kuvveti, disk boyutu 64 blogun kati olmali.\n", 104);
+        return -1;
+    }
+
+    Superblock sb;
+    if (!layout_superblock(&sb, max_files, size, bsize)) {
+        write(STDOUT_FILENO, "Dosya tablosu kapasitesi diske sigmiyor.\n", 41);
+        return -1;
+    }
+
+    // Eşleme disk boyutunu kapsadığından boyut değişirken kaldırılır, formattan sonra yeniden kurulur.
+    // Okuyucular dosya kilidi altında eşlemeden okuyabileceği için önce tüm dosyalar kilitlenir.
+    lock_all_files();
+    if ((off_t) size != disk_size) unmap_disk();
+    if (ftruncate(disk_fd, size) != 0) {
+        write(STDOUT_FILENO, "ftruncate islemi basarisiz oldu.\n", 33);
+        return -1;
+    }
+    if (set_geometry(size, bsize) < 0 || map_disk() != 0) return -1;
+
+    // Eski içerik bırakılmaz; yeni disk yalnızca yazılan metadata kadar yer kaplar
+    bool punched = punch_hole(0, size) == 0;
+    free(file_table);
+    file_table = NULL;
+    free(extent_table);
+    extent_table = NULL;
+    free(dir_tree.nodes);
+    dir_tree.nodes = NULL;
+    superblock = sb;
+    if (alloc_file_table(max_files) < 0 || alloc_extent_table(sb.max_extents) < 0 || alloc_dir_table(sb.max_dir_nodes) < 0) return -1;
+    superblock_dirty = true;
+    mark_all_entries_dirty();
+    bitmap_reset();
+    if (dirtree_create(&dir_tree) < 0) return -1;
+    rebuild_block_refs();
+    // Delinen disk zaten sıfır okunduğundan boş sağlama toplamı alanı yazılmaz
+    memset(block_checksums, 0, total_blocks * sizeof(uint32_t));
+    memset(checksum_dirty, punched ? 0 : 0xFF, bitmap_words * sizeof(uint64_t));
+
+    // Formatlama tüm metadatayı yeniden yazdığı için günlük kullanılmaz
+    journal_attach(&journal, disk_fd, sb.journal_offset, sb.journal_blocks * block_size, block_size, disk_size);
+    if (journal_format(&journal) < 0) return -1;
+    return write_metadata_direct();
+}
+
+// Dosyayı yeniden adlandır (fs_mv bu özelliği zaten içeriyor)
+int fs_rename(const char* old_name, const char* new_name) { return fs_mv(old_name, new_name); }
+
+// Dosya ya da dizin varlığını kontrol et
+bool fs_exists(const char* filename) {
+    begin_read();
+    bool exists = find_entry(filename) >= 0;
+    end_read();
+    return exists;
+}
+
+// Dosyanın boyutunu bul
+int fs_size(const char* filename) {
+    begin_read();
+    int i = resolve_file(filename);
+    int size = i < 0 ? -1 : file_table[i].size;
+    end_read();
+    return size;
+}
+
+// Dosyaya ekleme yap
+static int append_unlocked(const char* filename, const char* data, int size) {
+    int i = resolve_file(filename);
+    if (i < 0) return -1;
+    lock_file_exclusive(i);
+
+    if (resize_file(i, file_table[i].size + size) < 0 || unshare_range(i, file_table[i].size, size) < 0) return -1;
+    if (file_io(i, file_table[i].size, (void*) data, size, true) != size) {
+        // Eklenemeyen veri için ayrılan bloklar bırakılır; dosya eski boyutunda kalır
+        trim_file(i, file_blocks(file_table[i].size));
+        write(STDOUT_FILENO, "Veri diske yazilamadi.\n", 23);
+        return -1;
+    }
+    file_table[i].size += size;
+    mark_entry_dirty(i);
+    return save_metadata();
+}
+
+// Host dosyasının içeriğini sırayla parçalara yaz. mmap modunda veri doğrudan eşlemeye
+// okunur; aksi halde büyük, hizalı bir tamponla okunup diske yazılır.
+static int import_segments(int host_fd, const Segment* segments, int count) {
+    char* buffer = NULL;
+    int result = 0;
+    for (int k = 0; k < count && result == 0; k++) {
+        off_t position = segments[k].position;
+        int remaining = segments[k].length;
+        while (remaining > 0) {
+            int chunk = remaining < IMPORT_CHUNK_SIZE ? remaining : IMPORT_CHUNK_SIZE;
+            char* target = disk_at(position);
+            if (!target) {
+                if (!buffer && posix_memalign((void**) &buffer, 4096, IMPORT_CHUNK_SIZE) != 0) {
+                    write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+                    return -1;
+                }
+                target = buffer;
+            }
+            if (read_full(host_fd, target, chunk) != chunk) {
+                write(STDOUT_FILENO, "Host dosyasi okunamadi.\n", 24);
+                result = -1;
+                break;
+            }
+            if (disk_map) {
+                mark_changed(position, chunk);
+                mark_map_dirty(position, chunk);
+                update_checksums(position, chunk, target);
+            } else if (disk_write(target, chunk, position) != chunk) {
+                write(STDOUT_FILENO, "Dosya yazma hatasi.\n", 20);
+                result = -1;
+                break;
+            }
+            position += chunk;
+            remaining -= chunk;
+        }
+    }
+    free(buffer);
+    return result;
+}
+
+// Boyutu bilinmeyen kaynağı (boru, terminal) parça parça dosyanın sonuna ekle
+static int import_stream(int host_fd, int slot) {
+    char* buffer = malloc(IMPORT_CHUNK_SIZE);
+    if (!buffer) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+    ssize_t n;
+    while ((n = read_full(host_fd, buffer, IMPORT_CHUNK_SIZE)) > 0) {
+        int size = file_table[slot].size;
+        if (n > INT_MAX - size) {
+            write(STDOUT_FILENO, "Host dosyasi cok buyuk.\n", 24);
+            n = -1;
+            break;
+        }
+        if (resize_file(slot, size + n) < 0) {
+            n = -1;
+            break;
+        }
+        if (file_io(slot, size, buffer, n, true) != n) {
+            trim_file(slot, file_blocks(size));
+            write(STDOUT_FILENO, "Dosya yazma hatasi.\n", 20);
+            n = -1;
+            break;
+        }
+        file_table[slot].size = size + n;
+    }
+    free(buffer);
+    return n < 0 ? -1 : 0;
+}
+
+// Dosyanın extent zinciri ve boyutu; aktarma sırasında eski içerik bir kenarda tutulur
+typedef struct {
+    int size;
+    int first_extent;
+    int last_extent;
+    int extent_count;
+} FileChain;
+
+// Zinciri girdiden ayır; girdi boş bir dosya olarak kalır, bloklar ayrılmış kalır
+static FileChain detach_chain(int slot) {
+    FileEntry* entry = &file_table[slot];
+    FileChain chain = {entry->size, entry->first_extent, entry->last_extent, entry->extent_count};
+    entry->size = 0;
+    entry->first_extent = -1;
+    entry->last_extent = -1;
+    entry->extent_count = 0;
+    return chain;
+}
+
+static void attach_chain(int slot, FileChain chain) {
+    FileEntry* entry = &file_table[slot];
+    entry->size = chain.size;
+    entry->first_extent = chain.first_extent;
+    entry->last_extent = chain.last_extent;
+    entry->extent_count = chain.extent_count;
+    mark_entry_dirty(slot);
+}
+
+// Host dosyasını diske aktar (varsa üzerine yazılır). Boyut biliniyorsa tüm extent'ler
+// baştan ayrılır ve veri tek geçişte yerine okunur. Aktarılan bayt sayısını döner.
+// Mevcut dosyanın verisi yeni extent'lere aktarılır; eski extent'ler ancak aktarma
+// başarılı olursa bırakılır, bu yüzden aktarma sırasında iki kopyaya yer gerekir.
+static int import_unlocked(int host_fd, const char* filename) {
+    struct stat st;
+    if (fstat(host_fd, &st) != 0) return -1;
+    bool known_size = S_ISREG(st.st_mode);
+    if (known_size && st.st_size > INT_MAX) {
+        write(STDOUT_FILENO, "Host dosyasi cok buyuk.\n", 24);
+        return -1;
+    }
+
+    bool created = find_entry(filename) < 0;
+    if (created && create_unlocked(filename) < 0) return -1;
+    int i = resolve_file(filename);
+    if (i < 0) return -1;
+    lock_file_exclusive(i);
+    FileChain old = detach_chain(i);
+
+    int result;
+    if (known_size) {
+        int size = (int) st.st_size;
+        posix_fadvise(host_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        result = resize_file(i, size) < 0 || unshare_range(i, 0, size) < 0 ? -1 : 0;
+
+        int count = 0;
+        Segment* segments = result == 0 ? file_segments(i, 0, size, &count) : NULL;
+        if (result == 0 && !segments) write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        result = segments ? import_segments(host_fd, segments, count) : -1;
+        free(segments);
+        if (result == 0) file_table[i].size = size;
+    } else {
+        result = import_stream(host_fd, i);
+    }
+
+    // Yarım kalan aktarmanın blokları bırakılır ve eski içerik geri bağlanır; yeni oluşturulan dosya silinir
+    if (result < 0) {
+        trim_file(i, 0);
+        attach_chain(i, old);
+        if (created) delete_unlocked(filename);
+        else save_metadata();
+        return -1;
+    }
+    FileChain imported = detach_chain(i);
+    attach_chain(i, old);
+    trim_file(i, 0);
+    attach_chain(i, imported);
+    if (save_metadata() < 0) return -1;
+    return file_table[i].size;
+}
+
+// Dosyayı kırp (boyutu küçültmek için)
+static int truncate_unlocked(const char* filename, int new_size) {
+    int i = resolve_file(filename);
+    if (i < 0) return -1;
+    lock_file_exclusive(i);
+
+    if (new_size > file_table[i].size) {
+        write(STDOUT_FILENO, "Yeni boyut mevcut dosya boyutundan buyuk.\n", 42);
+        return -1;
+    }
+    resize_file(i, new_size);
+    file_table[i].size = new_size;
+    mark_entry_dirty(i);
+    return save_metadata();
+}
+
+// Başarısız kopyalamanın oluşturduğu hedefi bloklarıyla birlikte geri al
+static int discard_copy(int slot) {
+    trim_file(slot, 0);
+    remove_entry(slot);
+    save_metadata();
+    return -1;
+}
+
+// Dosyayı kopyala
+static int copy_unlocked(const char* src, const char* dest) {
+    int i = find_file(src);
+    if (i < 0) {
+        write(STDOUT_FILENO, "Kaynak dosya bulunamadi: ", 25);
+        return -1;
+    }
+
+    if (find_entry(dest) >= 0) {
+        write(STDOUT_FILENO, "Hedef dosya zaten mevcut.\n", 26);
+        return -1;
     }
-    return true;
-}
 
-// Diski başlat (yoksa oluştur, varsa yükle)
-bool fs_init() {
-    disk_fd = open(DISK_FILE, O_RDWR);
-    if (disk_fd < 0) {
-        disk_fd = open(DISK_FILE, O_RDWR | O_CREAT, 0666);
-        if (disk_fd < 0) {
-            write(STDOUT_FILENO, "Disk dosyasi acilamadi veya olusturulamadi\n", 44);
-            return false;
+    // Hedef için ayrılan bloklar kaynağın bloklarıyla çakışmadığından içerik disk
+    // üzerinde, iki dosyanın extent'leri boyunca parça parça kopyalanır
+    int size = file_table[i].size;
+    int j = create_entry(dest, FS_TYPE_FILE);
+    if (j < 0) return -1;
+    lock_file_exclusive(j);
+    if (copy_mode == FS_COPY_REFLINK && can_reflink(i)) {
+        if (reflink_file(i, j) < 0) {
+            write(STDOUT_FILENO, "Extent tablosunda yer kalmadi.\n", 31);
+            return discard_copy(j);
         }
-        ftruncate(disk_fd, DISK_SIZE);
-        memset(file_table, 0, sizeof(file_table));
-        save_metadata();
-    } else {
-        load_metadata();
+        file_table[j].size = size;
+        return save_metadata();
     }
-    return true;
+    if (resize_file(j, size) < 0) return discard_copy(j);
+
+    int src_count, dest_count;
+    Segment* src_segments = file_segments(i, 0, size, &src_count);
+    Segment* dest_segments = file_segments(j, 0, size, &dest_count);
+    int result = src_segments && dest_segments ? 0 : -1;
+    int s = 0, d = 0;
+    off_t src_done = 0, dest_done = 0;
+    while (result == 0 && s < src_count && d < dest_count) {
+        int chunk = src_segments[s].length - src_done;
+        if (chunk > dest_segments[d].length - dest_done) chunk = dest_segments[d].length - dest_done;
+        result = disk_move(dest_segments[d].position + dest_done, src_segments[s].position + src_done, chunk);
+        src_done += chunk;
+        dest_done += chunk;
+        if (src_done == src_segments[s].length) s++, src_done = 0;
+        if (dest_done == dest_segments[d].length) d++, dest_done = 0;
+    }
+    free(src_segments);
+    free(dest_segments);
+    if (result < 0) return discard_copy(j);
+    file_table[j].size = size;
+    mark_entry_dirty(j);
+    return save_metadata();
 }
 
-// Yeni dosya oluştur
-int fs_create(const char* filename) {
-    if (fs_exists(filename)) {
-        write(STDOUT_FILENO, "Dosya zaten mevcut.\n", 21);
+// Dosyayı ya da dizini taşı (fs_rename özelliğini zaten içeriyor). Hedef mevcut bir dizinse
+// girdi aynı adla onun içine taşınır. Yalnızca dizin ağacı ve girdi değişir; veri yerinde kalır.
+static int mv_unlocked(const char* old_path, const char* new_path) {
+    int i = find_entry(old_path);
+    if (i < 0) {
+        write(STDOUT_FILENO, "Dosya bulunamadi: ", 18);
+        write(STDOUT_FILENO, old_path, strlen(old_path));
+        write(STDOUT_FILENO, "\n", 1);
         return -1;
     }
 
-    // Boş bir dosya girdisi bul
-    int free_slot = -1;
-    for (int i = 0; i < MAX_FILES; ++i) {
-        if (!file_table[i].valid) {
-            free_slot = i;
-            break;
-        }
+    int dir;
+    char name[FILENAME_LEN];
+    int result = walk_path(new_path, &dir, name);
+    if (result == PATH_TOO_LONG) {
+        write(STDOUT_FILENO, "Dosya adi cok uzun (en fazla 31 karakter).\n", 43);
+        return -1;
     }
-
-    if (free_slot == -1) {
-        write(STDOUT_FILENO, "Dosya tablosunda bos yer kalmadi.\n", 35);
+    if (result != PATH_OK) {
+        write(STDOUT_FILENO, "Hedef dizin bulunamadi: ", 24);
+        write(STDOUT_FILENO, new_path, strlen(new_path));
+        write(STDOUT_FILENO, "\n", 1);
+        return -1;
+    }
+    int existing = name[0] != '\0' ? lookup_entry(dir, name) : dir;
+    if (name[0] == '\0' || (existing >= 0 && file_table[existing].type == FS_TYPE_DIR)) {
+        if (name[0] != '\0') dir = existing;
+        strcpy(name, file_table[i].name);
+        existing = lookup_entry(dir, name);
+    }
+    if (existing >= 0) {
+        write(STDOUT_FILENO, "Hedef konumda ayni isimde dosya zaten var.\n", 43);
         return -1;
     }
 
-    // Diskte uygun yer bul
-    int start_block = find_free_block(0);
-    if (start_block == -1) {
-        // Disk dolu, defragmentasyon denenir
-        if (fs_defragment() < 0) {
-            write(STDOUT_FILENO, "Diskte bos alan bulunamadi ve defragmentasyon basarisiz.\n", 58);
+    // Dizin kendi alt ağacına taşınırsa kökten kopuk bir döngü oluşur
+    for (int d = dir; d != FS_ROOT_DIR; d = file_table[d].parent) {
+        if (d == i) {
+            write(STDOUT_FILENO, "Dizin kendi alt dizinine tasinamaz.\n", 36);
             return -1;
         }
+    }
 
-        // Defragmentasyon sonrası tekrar deneme
-        start_block = find_free_block(0);
-        if (start_block == -1) {
-            write(STDOUT_FILENO, "Defragmentasyona ragmen diskte yeterli alan bulunamadi.\n", 57);
-            return -1;
-        }
+    if (dirtree_insert(&dir_tree, dir, name, i) < 0) {
+        write(STDOUT_FILENO, "Dizin agacinda yer kalmadi.\n", 28);
+        return -1;
     }
+    dirtree_remove(&dir_tree, file_table[i].parent, file_table[i].name);
+    memset(file_table[i].name, 0, FILENAME_LEN);
+    strcpy(file_table[i].name, name);
+    file_table[i].parent = dir;
+    mark_entry_dirty(i);
+    return save_metadata();
+}
 
-    // Dosya girdisini doldur
-    strncpy(file_table[free_slot].name, filename, FILENAME_LEN);
-    file_table[free_slot].size = 0;
-    file_table[free_slot].start_block = start_block;
-    file_table[free_slot].created_at = time(NULL);
-    file_table[free_slot].valid = 1;
+// Dosyaları ilk extent'lerinin başlangıç bloğuna göre sıralamak için
+static int compare_start_block(const void* a, const void* b) {
+    int first_a = file_table[*(const int*) a].first_extent;
+    int first_b = file_table[*(const int*) b].first_extent;
+    return (int) extent_table[first_a].start - (int) extent_table[first_b].start;
+}
 
-    return save_metadata();
+// Dosyanın tüm extent'lerini 'target' bloğundan başlayan boş alana sırayla kopyala
+// ve dosyayı tek bir extent'e indir
+static int relocate_file(int slot, int target) {
+    FileEntry* entry = &file_table[slot];
+    int blocks = file_blocks(entry->size);
+    off_t position = (off_t) target * block_size;
+
+    lock_file_exclusive(slot);
+    for (int e = entry->first_extent; e >= 0; e = extent_table[e].next) {
+        int bytes = extent_table[e].length * block_size;
+        if (disk_move(position, (off_t) extent_table[e].start * block_size, bytes) < 0) return -1;
+        position += bytes;
+    }
+
+    // Hedef, eski extent'ler serbest bırakılmadan önce dolu işaretlenir
+    bitmap_mark(target, blocks, true);
+    ref_blocks(target, blocks);
+    trim_file(slot, 0);
+    int index = alloc_extent();
+    if (index < 0) return -1;
+    extent_table[index].start = target;
+    extent_table[index].length = blocks;
+    extent_table[index].next = -1;
+    mark_extent_dirty(index);
+    entry->first_extent = entry->last_extent = index;
+    entry->extent_count = 1;
+    mark_entry_dirty(slot);
+    return 0;
 }
 
-// Dosyayı sil
-int fs_delete(const char* filename) {
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, filename) == 0) {
-            file_table[i].valid = 0;
-            memset(file_table[i].name, 0, FILENAME_LEN);
-            file_table[i].size = 0;
-            file_table[i].start_block = 0;
-            file_table[i].created_at = 0;
-            return save_metadata();
-        }
-    }
-    write(STDOUT_FILENO, "Dosya bulunamadi: ", 19);
-    write(STDOUT_FILENO, filename, strlen(filename));
-    write(STDOUT_FILENO, "\n", 1);
-    return -1;
+// Birleştirmenin kaldığı yer: bu bloktan önce başlayan dosyalar geçerli turda işlendi
+static int defrag_cursor = 0;
+
+// Arka plan birleştirme iş parçacığı
+static pthread_t defrag_thread;
+static pthread_mutex_t defrag_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t defrag_cond = PTHREAD_COND_INITIALIZER;
+static bool defrag_running = false;
+static bool defrag_stopping = false;
+static int defrag_step_blocks = DEFAULT_DEFRAG_STEP_BLOCKS;
+static int defrag_interval_ms = DEFAULT_DEFRAG_INTERVAL_MS;
+static DefragStats defrag_totals;
+
+static double elapsed_ms_since(const struct timespec* started) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - started->tv_sec) * 1000.0 + (now.tv_nsec - started->tv_nsec) / 1e6;
 }
 
-// Dosya içine yaz
-int fs_write(const char* filename, const char* data, int size) {
-    // Geçersiz veri kontrolü
-    if (data == NULL || size <= 0) {
-        write(STDOUT_FILENO, "Yazilacak veri bulunamadi.\n", 28);
+// Birleştirme turunun bir adımı. Dosyalar disk üzerindeki sırayla, kendilerinden önceki
+// ilk uygun boş alana taşınır; birden fazla extent'e bölünmüş dosyalar sığdıkları ilk boş
+// alanda birleştirilir. Yerinde duran dosyalara dokunulmaz. Hedef yalnızca boş bloklardan
+// seçildiği için taşıma sırasında hiçbir veri ezilmez; her taşımadan sonra işlem commit
+// edilir ve boşalan bloklar sıradaki dosyalara açılır. Bir adımda en az bir dosya, toplamda
+// en fazla 'max_blocks' blok taşınır. Tur bittiyse 0, sürüyorsa 1 döner (-1 = hata).
+static int defragment_step_unlocked(int max_blocks, DefragStats* stats) {
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    int file_count = 0;
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (file_table[i].valid && file_table[i].first_extent >= 0 &&
+            (int) extent_table[file_table[i].first_extent].start >= defrag_cursor) {
+            file_count++;
+        }
+    }
+
+    int* order = malloc((file_count > 0 ? file_count : 1) * sizeof(int));
+    if (!order) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
         return -1;
     }
 
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, filename) == 0) {
-            lseek(disk_fd, file_table[i].start_block, SEEK_SET);
-            write(disk_fd, data, size);
-            file_table[i].size = size;
-            return save_metadata();
+    int n = 0;
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (file_table[i].valid && file_table[i].first_extent >= 0 &&
+            (int) extent_table[file_table[i].first_extent].start >= defrag_cursor) {
+            order[n++] = i;
         }
     }
+    qsort(order, file_count, sizeof(int), compare_start_block);
 
-    write(STDOUT_FILENO, "Dosya bulunamadi: ", 19);
-    write(STDOUT_FILENO, filename, strlen(filename));
-    write(STDOUT_FILENO, "\n", 1);
-    return -1;
-}
+    int result = 0;
+    int moved = 0;
+    for (int k = 0; k < file_count; k++) {
+        FileEntry* entry = &file_table[order[k]];
+        int blocks = file_blocks(entry->size);
+        int start = extent_table[entry->first_extent].start;
+        if (moved > 0 && moved + blocks > max_blocks) {
+            defrag_cursor = start;
+            result = 1;
+            break;
+        }
+        defrag_cursor = start + 1;
+        stats->files_checked++;
 
-// Dosyayı oku
-int fs_read(const char* filename, int offset, int size, char* buffer) {
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, filename) == 0) {
-            if (offset + size > file_table[i].size) {
-                write(STDOUT_FILENO, "Okuma dosya boyutunu asiyor.\n", 30);
-                return -1;
-            }
-            lseek(disk_fd, file_table[i].start_block + offset, SEEK_SET);
-            return (int) read(disk_fd, buffer, size);
+        int target = find_free_blocks(blocks);
+        if (target < 0 || (entry->extent_count == 1 && target >= start)) continue;
+
+        // Paylaşılan blokları taşımak paylaşımı bozacağından bu dosyalar yerinde bırakılır
+        bool shared = false;
+        for (int e = entry->first_extent; e >= 0 && !shared; e = extent_table[e].next) shared = extent_is_shared(e);
+        if (shared) continue;
+
+        if (relocate_file(order[k], target) < 0 || commit_metadata() < 0) {
+            result = -1;
+            break;
         }
+        moved += blocks;
+        stats->files_moved++;
+        stats->bytes_moved += (uint64_t) blocks * block_size;
     }
-    write(STDOUT_FILENO, "Dosya bulunamadi: ", 19);
-    write(STDOUT_FILENO, filename, strlen(filename));
-    write(STDOUT_FILENO, "\n", 1);
-    return -1;
+    free(order);
+
+    if (result == 0) defrag_cursor = 0;
+    stats->elapsed_ms += elapsed_ms_since(&started);
+    return result;
 }
 
-// Tüm dosyaları göster
-void fs_ls(bool is_called_from_menu) {
-    bool files_exist = false;
-    for (int i = 0; i < MAX_FILES; ++i) {
-        if (file_table[i].valid) {
-            files_exist = true;
-            break;
-        }
+// Birleştirme turunu adım adım ilerlet. Her adım kilidi yalnızca kendi süresince tutar;
+// adımlar arasında okuma ve yazma işlemleri devam edebilir.
+int fs_defragment_step(int max_blocks, DefragStats* stats) {
+    begin_update();
+    int result = defragment_step_unlocked(max_blocks > 0 ? max_blocks : 1, stats);
+    end_update();
+    return result;
+}
+
+// Tam bir birleştirme turu çalıştır ve sonucu raporla
+int fs_defragment() {
+    DefragStats stats = {0};
+    int result;
+    while ((result = fs_defragment_step(DEFAULT_DEFRAG_STEP_BLOCKS, &stats)) > 0) {
     }
+    if (result < 0) return -1;
 
-    // Dosya yoksa ve menüden çağrıldıysa mesaj göster
-    if (!files_exist) {
-        if (is_called_from_menu) write(STDOUT_FILENO, "Diskte dosya bulunamadi.\n", 26);
-        return;
+    if (stats.files_checked == 0) {
+        write(STDOUT_FILENO, "Diskte dosya bulunmamaktadir.\n", 30);
+        return 0;
     }
 
-    // Dosyalar varsa liste göster
-    write(STDOUT_FILENO, "Diskteki Dosyalar:\n", 20);
-    for (int i = 0; i < MAX_FILES; ++i) {
-        if (file_table[i].valid) {
-            char size_buf[32];
-            int len = snprintf(size_buf, sizeof(size_buf), " (%d bytes)\n", file_table[i].size);
+    char msg[128];
+    int len = snprintf(msg, sizeof(msg), "Disk alanindaki bosluklar basariyla birlestirildi: %d dosya, %llu bytes tasindi, %.3f ms\n",
+                       stats.files_moved, (unsigned long long) stats.bytes_moved, stats.elapsed_ms);
+    write(STDOUT_FILENO, msg, len);
+    return 0;
+}
 
-            write(STDOUT_FILENO, " - ", 3);
-            write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
-            write(STDOUT_FILENO, size_buf, len);
+// Bekleme süresi dolana ya da durdurma istenene kadar bekle; durdurulduysa true döner
+static bool defrag_wait(int ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (long) (ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&defrag_mutex);
+    while (!defrag_stopping && pthread_cond_timedwait(&defrag_cond, &defrag_mutex, &deadline) == 0) {
+    }
+    bool stopping = defrag_stopping;
+    pthread_mutex_unlock(&defrag_mutex);
+    return stopping;
+}
+
+// Arka planda adımlarla birleştirme yapar; her tur bittiğinde taşıma yapıldıysa günlüğe yazılır
+static void* defrag_worker(void* arg) {
+    (void) arg;
+    DefragStats pass = {0};
+    while (!defrag_wait(defrag_interval_ms)) {
+        int result = fs_defragment_step(defrag_step_blocks, &pass);
+        if (result < 0) break;
+
+        pthread_mutex_lock(&defrag_mutex);
+        if (result == 0) {
+            defrag_totals.files_checked += pass.files_checked;
+            defrag_totals.files_moved += pass.files_moved;
+            defrag_totals.bytes_moved += pass.bytes_moved;
+            defrag_totals.elapsed_ms += pass.elapsed_ms;
+        }
+        pthread_mutex_unlock(&defrag_mutex);
+
+        if (result == 0) {
+            // Süre olarak turun kilit altında geçirdiği toplam süre, sonuç olarak taşınan dosya sayısı kaydedilir
+            if (pass.files_moved > 0) {
+                uint64_t started = log_clock() - (uint64_t) (pass.elapsed_ms * 1e6);
+                log_operation(LOG_OP_DEFRAG_BACKGROUND, NULL, NULL, pass.bytes_moved, started, pass.files_moved);
+            }
+            memset(&pass, 0, sizeof(pass));
         }
     }
+    return NULL;
 }
 
-// Diski formatla
-int fs_format() {
-    memset(file_table, 0, sizeof(file_table));
-    if (ftruncate(disk_fd, DISK_SIZE) != 0) {
-        write(STDOUT_FILENO, "ftruncate islemi basarisiz oldu.\n", 34);
+// Arka plan birleştirmesini başlat: her 'interval_ms' milisaniyede en fazla 'step_blocks'
+// blok taşınır. Zaten çalışıyorsa yalnızca ayarlar güncellenir.
+int fs_defragment_start(int step_blocks, int interval_ms) {
+    pthread_mutex_lock(&defrag_mutex);
+    defrag_step_blocks = step_blocks > 0 ? step_blocks : DEFAULT_DEFRAG_STEP_BLOCKS;
+    defrag_interval_ms = interval_ms >= 0 ? interval_ms : DEFAULT_DEFRAG_INTERVAL_MS;
+    if (defrag_running) {
+        pthread_mutex_unlock(&defrag_mutex);
+        return 0;
+    }
+
+    defrag_stopping = false;
+    memset(&defrag_totals, 0, sizeof(defrag_totals));
+    if (pthread_create(&defrag_thread, NULL, defrag_worker, NULL) != 0) {
+        pthread_mutex_unlock(&defrag_mutex);
         return -1;
     }
-    return save_metadata();
+    defrag_running = true;
+    pthread_mutex_unlock(&defrag_mutex);
+    return 0;
 }
 
-// Dosyayı yeniden adlandır (fs_mv bu özelliği zaten içeriyor)
-int fs_rename(const char* old_name, const char* new_name) { return fs_mv(old_name, new_name); }
+// Arka plan birleştirmesini durdur; tamamlanan turların toplamı 'stats'a yazılır (NULL olabilir)
+void fs_defragment_stop(DefragStats* stats) {
+    pthread_mutex_lock(&defrag_mutex);
+    if (!defrag_running) {
+        pthread_mutex_unlock(&defrag_mutex);
+        if (stats) memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    defrag_stopping = true;
+    pthread_cond_broadcast(&defrag_cond);
+    pthread_mutex_unlock(&defrag_mutex);
 
-// Dosya varlığını kontrol et
-bool fs_exists(const char* filename) {
-    for (int i = 0; i < MAX_FILES; ++i) {
-        if (file_table[i].valid && strcmp(file_table[i].name, filename) == 0)
-            return true;
+    pthread_join(defrag_thread, NULL);
+
+    pthread_mutex_lock(&defrag_mutex);
+    defrag_running = false;
+    if (stats) *stats = defrag_totals;
+    pthread_mutex_unlock(&defrag_mutex);
+}
+
+// Dosyanın extent zincirini doğrula: geçerli kayıtlardan oluşmalı, döngü içermemeli
+// ve son kayıt girdideki last_extent olmalı. Zincirdeki blok sayısını döner (-1 = bozuk).
+static int chain_blocks(int slot) {
+    FileEntry* entry = &file_table[slot];
+    int blocks = 0;
+    int count = 0;
+    int last = -1;
+    for (int e = entry->first_extent; e >= 0; e = extent_table[e].next) {
+        if (e >= (int) superblock.max_extents || extent_table[e].length == 0 || ++count > entry->extent_count) return -1;
+        blocks += extent_table[e].length;
+        last = e;
     }
-    return false;
+    return count == entry->extent_count && last == entry->last_extent ? blocks : -1;
 }
 
-// Dosyanın boyutunu bul
-int fs_size(const char* filename) {
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, filename) == 0) {
-            return file_table[i].size;
+// Blok aralığının bit dizisindeki bitlerini ayarla
+static void set_block_bits(uint64_t* words, uint64_t first, uint64_t count, bool value) {
+    for (uint64_t block = first; block < first + count && block < (uint64_t) total_blocks; block++) {
+        if (value) {
+            words[block / 64] |= 1ULL << (block % 64);
+        } else {
+            words[block / 64] &= ~(1ULL << (block % 64));
         }
     }
-    write(STDOUT_FILENO, "Dosya bulunamadi: ", 19);
-    write(STDOUT_FILENO, filename, strlen(filename));
-    write(STDOUT_FILENO, "\n", 1);
-    return -1;
 }
 
-// Dosyaya ekleme yap
-int fs_append(const char* filename, const char* data, int size) {
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, filename) == 0) {
-            int offset = file_table[i].start_block + file_table[i].size;
-            lseek(disk_fd, offset, SEEK_SET);
-            write(disk_fd, data, size);
-            file_table[i].size += size;
-            return save_metadata();
+// Bütünlük raporu: bulunan hatalar makinece okunabilir JSON olarak da yazılır (fd < 0 = kapalı)
+typedef struct {
+    int fd;
+    int entries;
+} IntegrityReport;
+
+// Dosya adını JSON dizgisi olarak yaz (tırnak, ters bölü ve kontrol karakterleri kaçırılır)
+static int json_string(char* out, int capacity, const char* text) {
+    int n = 0;
+    out[n++] = '"';
+    for (const unsigned char* c = (const unsigned char*) text; *c && n < capacity - 8; c++) {
+        if (*c == '"' || *c == '\\') {
+            out[n++] = '\\';
+            out[n++] = *c;
+        } else if (*c < 0x20) {
+            n += snprintf(out + n, capacity - n, "\\u%04x", *c);
+        } else {
+            out[n++] = *c;
         }
     }
-    write(STDOUT_FILENO, "Dosya bulunamadi: ", 19);
-    write(STDOUT_FILENO, filename, strlen(filename));
-    write(STDOUT_FILENO, "\n", 1);
-    return -1;
+    out[n++] = '"';
+    out[n] = '\0';
+    return n;
 }
 
-// Dosyayı kırp (boyutu küçültmek için)
-int fs_truncate(const char* filename, int new_size) {
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, filename) == 0) {
-            if (new_size > file_table[i].size) {
-                write(STDOUT_FILENO, "Yeni boyut mevcut dosya boyutundan buyuk.\n", 43);
-                return -1;
-            }
-            file_table[i].size = new_size;
-            return save_metadata();
-        }
+// Hatayı rapora ekle. 'slot' ve 'other' ilgili dosyalar, 'block' ilgili blok (-1 = yok)
+static void report_error(IntegrityReport* report, const char* type, int slot, int other, int64_t block) {
+    if (!report || report->fd < 0) return;
+    char entry[16 * FILENAME_LEN];
+    int n = snprintf(entry, sizeof(entry), "%s\n    {\"type\": \"%s\"", report->entries++ ? "," : "", type);
+    if (slot >= 0) {
+        n += snprintf(entry + n, sizeof(entry) - n, ", \"file\": ");
+        n += json_string(entry + n, sizeof(entry) - n - 64, file_table[slot].name);
     }
-    write(STDOUT_FILENO, "Dosya bulunamadi: ", 19);
-    write(STDOUT_FILENO, filename, strlen(filename));
-    write(STDOUT_FILENO, "\n", 1);
-    return -1;
+    if (other >= 0) {
+        n += snprintf(entry + n, sizeof(entry) - n, ", \"other\": ");
+        n += json_string(entry + n, sizeof(entry) - n - 32, file_table[other].name);
+    }
+    if (block >= 0) n += snprintf(entry + n, sizeof(entry) - n, ", \"block\": %lld", (long long) block);
+    n += snprintf(entry + n, sizeof(entry) - n, "}");
+    write(report->fd, entry, n);
 }
 
-// Dosyayı kopyala
-int fs_copy(const char* src, const char* dest) {
-    if (!fs_exists(src)) {
-        write(STDOUT_FILENO, "Kaynak dosya bulunamadi: ", 26);
-        return -1;
+// Çakışma taramasında bir extent kaydı
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+    int slot;
+    bool shared;
+} ExtentSpan;
+
+static int compare_spans(const void* a, const void* b) {
+    const ExtentSpan* x = a;
+    const ExtentSpan* y = b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return x->slot - y->slot;
+}
+
+static int compare_pairs(const void* a, const void* b) {
+    const int* x = a;
+    const int* y = b;
+    return x[0] != y[0] ? x[0] - y[0] : x[1] - y[1];
+}
+
+// Etkin extent'ler: bitiş bloğuna göre en küçük yığın (min-heap). Tarama noktasının
+// gerisinde kalanlar tepeden çıkarılır.
+typedef struct {
+    int* items;
+    int count;
+} SpanHeap;
+
+static void heap_push(SpanHeap* heap, const ExtentSpan* spans, int k) {
+    int i = heap->count++;
+    while (i > 0 && spans[heap->items[(i - 1) / 2]].end > spans[k].end) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i] = k;
+}
+
+static void heap_pop(SpanHeap* heap, const ExtentSpan* spans) {
+    int last = heap->items[--heap->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && spans[heap->items[child + 1]].end < spans[heap->items[child]].end) child++;
+        if (spans[heap->items[child]].end >= spans[last].end) break;
+        heap->items[i] = heap->items[child];
+        i = child;
     }
+    heap->items[i] = last;
+}
 
-    if (fs_exists(dest)) {
-        write(STDOUT_FILENO, "Hedef dosya zaten mevcut.\n", 27);
+// Zinciri sağlam dosyaların extent'lerini başlangıç bloğuna göre sıralayıp tek geçişte
+// çakışmaları bul (O(n log n + k), k = çakışan extent çifti). Geçiş boyunca henüz bitmemiş
+// extent'ler paylaşımsız ve paylaşılan olarak iki yığında tutulur; yeni extent çakıştığı
+// türdeki her etkin extent'le eşleştirilir. Reflink kopyalarının paylaşılan extent'leri
+// birbiriyle çakışma sayılmaz. Her dosya çifti bir kez raporlanır; hata sayısını döner
+// (-1 = bellek hatası). Bir extent ancak bayrağı taşıyor ve referans sayısı birden büyük
+// bir bloğu varsa paylaşılan sayılır; sayıların extent'lerle tam uyumu check_block_refs'te
+// denetlenir.
+static int check_overlaps(const bool* chain_ok, IntegrityReport* report) {
+    int span_count = 0;
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (chain_ok[i]) span_count += file_table[i].extent_count;
+    }
+    ExtentSpan* spans = malloc((span_count + 1) * sizeof(ExtentSpan));
+    SpanHeap active[2] = {{malloc((span_count + 1) * sizeof(int)), 0}, {malloc((span_count + 1) * sizeof(int)), 0}};
+    int pair_capacity = span_count + 1;
+    int* pairs = malloc(pair_capacity * 2 * sizeof(int));
+    if (!spans || !active[0].items || !active[1].items || !pairs) {
+        free(spans);
+        free(active[0].items);
+        free(active[1].items);
+        free(pairs);
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
         return -1;
     }
 
-    char* buffer;
-    int size;
+    int n = 0;
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (!chain_ok[i]) continue;
+        for (int e = file_table[i].first_extent; e >= 0; e = extent_table[e].next) {
+            spans[n].start = extent_table[e].start;
+            spans[n].end = extent_table[e].start + extent_table[e].length;
+            spans[n].slot = i;
+            spans[n].shared = false;
+            for (uint32_t b = spans[n].start; b < spans[n].end && b < (uint32_t) total_blocks; b++) {
+                if (block_refs[b] > 1) spans[n].shared = (extent_table[e].flags & EXTENT_SHARED) != 0;
+                if (spans[n].shared) break;
+            }
+            n++;
+        }
+    }
+    qsort(spans, n, sizeof(ExtentSpan), compare_spans);
 
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, src) == 0) {
-            size = file_table[i].size;
-            buffer = malloc(size);
-            lseek(disk_fd, file_table[i].start_block, SEEK_SET);
-            read(disk_fd, buffer, size);
-
-            fs_create(dest);
-            for (int j = 0; j < MAX_FILES; j++) {
-                if (file_table[j].valid && strcmp(file_table[j].name, dest) == 0) {
-                    lseek(disk_fd, file_table[j].start_block, SEEK_SET);
-                    write(disk_fd, buffer, size);
-                    file_table[j].size = size;
-                    save_metadata();
-                    free(buffer);
-                    return 0;
+    int pair_count = 0;
+    bool out_of_memory = false;
+    for (int k = 0; k < n && !out_of_memory; k++) {
+        for (int kind = 0; kind < 2 && !out_of_memory; kind++) {
+            SpanHeap* heap = &active[kind];
+            while (heap->count > 0 && spans[heap->items[0]].end <= spans[k].start) heap_pop(heap, spans);
+            // Paylaşılan iki extent çakışmaz
+            if (kind == 1 && spans[k].shared) continue;
+            for (int h = 0; h < heap->count; h++) {
+                if (pair_count == pair_capacity) {
+                    int* grown = realloc(pairs, pair_capacity * 4 * sizeof(int));
+                    if (!grown) {
+                        out_of_memory = true;
+                        break;
+                    }
+                    pairs = grown;
+                    pair_capacity *= 2;
                 }
+                int a = spans[heap->items[h]].slot, b = spans[k].slot;
+                pairs[pair_count * 2] = a < b ? a : b;
+                pairs[pair_count * 2 + 1] = a < b ? b : a;
+                pair_count++;
             }
         }
+        heap_push(&active[spans[k].shared], spans, k);
+    }
+    free(spans);
+    free(active[0].items);
+    free(active[1].items);
+    if (out_of_memory) {
+        free(pairs);
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
     }
 
-    return -1;
+    qsort(pairs, pair_count, 2 * sizeof(int), compare_pairs);
+    int error_count = 0;
+    for (int k = 0; k < pair_count; k++) {
+        if (k > 0 && pairs[k * 2] == pairs[k * 2 - 2] && pairs[k * 2 + 1] == pairs[k * 2 - 1]) continue;
+        const char* first = file_table[pairs[k * 2]].name;
+        const char* second = file_table[pairs[k * 2 + 1]].name;
+        write(STDOUT_FILENO, "Hata: Dosya bloklari cakismasi: ", 32);
+        write(STDOUT_FILENO, first, strlen(first));
+        write(STDOUT_FILENO, " ve ", 4);
+        write(STDOUT_FILENO, second, strlen(second));
+        write(STDOUT_FILENO, "\n", 1);
+        report_error(report, "overlap", pairs[k * 2], pairs[k * 2 + 1], -1);
+        error_count++;
+    }
+    free(pairs);
+    return error_count;
 }
 
-// Dosyayı taşı (fs_rename özelliğini zaten içeriyor)
-int fs_mv(const char* old_path, const char* new_path) {
-    if (fs_exists(new_path)) {
-        write(STDOUT_FILENO, "Hedef konumda ayni isimde dosya zaten var.\n", 44);
+// Her bloğu gösteren extent sayısını bellekteki referans sayısıyla karşılaştır. Sayaç
+// taşması ya da kaybolan bir referans, blokların paylaşılırken serbest bırakılıp başka bir
+// dosyaya verilmesine yol açar; kaybolmayan bir azaltma ise hiçbir extent'in göstermediği
+// bloğu sonsuza dek dolu tutar. Bu yüzden extent'siz bloklar da karşılaştırılır; yalnızca
+// zinciri bozuk dosyaların ulaşılabilen blokları atlanır (zincir hatası zaten raporlanır).
+// İki sayının da sıfır olduğu bloklarda bitmap'in boş olması check_bitmap'te denetlenir.
+// Uyuşmayan ardışık bloklar tek hata olarak raporlanır.
+static int check_block_refs(const bool* chain_ok, IntegrityReport* report) {
+    uint32_t* coverage = calloc(total_blocks, sizeof(uint32_t));
+    uint64_t* unknown = calloc(bitmap_words, sizeof(uint64_t));
+    if (!coverage || !unknown) {
+        free(coverage);
+        free(unknown);
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
         return -1;
     }
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (!file_table[i].valid) continue;
+        if (!chain_ok[i]) {
+            int steps = 0;
+            for (int e = file_table[i].first_extent; e >= 0 && e < (int) superblock.max_extents && steps < (int) superblock.max_extents;
+                 e = extent_table[e].next, steps++) {
+                set_block_bits(unknown, extent_table[e].start, extent_table[e].length, true);
+            }
+            continue;
+        }
+        for (int e = file_table[i].first_extent; e >= 0; e = extent_table[e].next) {
+            uint32_t end = extent_table[e].start + extent_table[e].length;
+            for (uint32_t b = extent_table[e].start; b < end && b < (uint32_t) total_blocks; b++) coverage[b]++;
+        }
+    }
 
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, old_path) == 0) {
-            strncpy(file_table[i].name, new_path, FILENAME_LEN);
-            return save_metadata();
+    int error_count = 0;
+    for (int b = 0; b < total_blocks;) {
+        bool skipped = unknown[b / 64] & (1ULL << (b % 64));
+        if (skipped || coverage[b] == block_refs[b]) {
+            b++;
+            continue;
         }
+        int first = b;
+        while (b < total_blocks && !(unknown[b / 64] & (1ULL << (b % 64))) && coverage[b] != block_refs[b]) b++;
+        char msg[96];
+        int len = snprintf(msg, sizeof(msg), "Hata: Blok referans sayisi uyusmuyor: bloklar %d-%d\n", first, b - 1);
+        write(STDOUT_FILENO, msg, len);
+        report_error(report, "ref_count_mismatch", -1, -1, first);
+        error_count++;
     }
+    free(coverage);
+    free(unknown);
+    return error_count;
+}
 
-    write(STDOUT_FILENO, "Dosya bulunamadi: ", 19);
-    write(STDOUT_FILENO, old_path, strlen(old_path));
-    write(STDOUT_FILENO, "\n", 1);
-    return -1;
+// Dizin ağacının gezintisinde anahtarları dosya tablosuyla eşleştirmek için
+typedef struct {
+    uint8_t* seen; // Girdinin ağaçta kaç kez bulunduğu (2'de sınırlanır)
+    int mismatched; // Tablodaki bir girdiyle uyuşmayan anahtar sayısı
+} DirCheck;
+
+static void visit_dir_key(const DirKey* key, void* context) {
+    DirCheck* check = context;
+    int slot = key->slot;
+    if (slot < 0 || slot >= (int) superblock.max_files || !file_table[slot].valid || file_table[slot].parent != key->parent ||
+        strncmp(file_table[slot].name, key->name, FILENAME_LEN) != 0) {
+        check->mismatched++;
+        return;
+    }
+    if (check->seen[slot] < 2) check->seen[slot]++;
 }
 
-int fs_defragment() {
-    int fragmented_count = 0;
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid) {
-            fragmented_count++;
-        }
+// Dizin ağacını dosya tablosuyla karşılaştır: ağaç yapısı geçerli olmalı, her anahtar tablodaki
+// bir girdiyi göstermeli, her geçerli girdi ağaçta tam bir kez bulunmalı ve üst dizin zinciri köke ulaşmalı
+static int check_directories(IntegrityReport* report) {
+    DirCheck check = {calloc(superblock.max_files, 1), 0};
+    if (!check.seen) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+    if (dirtree_verify(&dir_tree, visit_dir_key, &check) < 0) {
+        write(STDOUT_FILENO, "Hata: Dizin agaci bozuk.\n", 25);
+        report_error(report, "broken_dir_tree", -1, -1, -1);
+        free(check.seen);
+        return 1;
     }
 
-    if (fragmented_count == 0) {
-        write(STDOUT_FILENO, "Diskte dosya bulunmamaktadir.\n", 31);
-        return 0;
+    int error_count = 0;
+    if (check.mismatched > 0) {
+        char msg[96];
+        int len = snprintf(msg, sizeof(msg), "Hata: Dizin agacinda %d gecersiz girdi var.\n", check.mismatched);
+        write(STDOUT_FILENO, msg, len);
+        report_error(report, "invalid_dir_entry", -1, -1, -1);
+        error_count++;
     }
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (!file_table[i].valid) continue;
+        if (check.seen[i] != 1) {
+            write(STDOUT_FILENO, "Hata: Dosya dizin agacinda bulunamadi ya da birden fazla kez var: ", 66);
+            write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
+            write(STDOUT_FILENO, "\n", 1);
+            report_error(report, check.seen[i] ? "duplicate_dir_entry" : "missing_dir_entry", i, -1, -1);
+            error_count++;
+        }
 
-    // Geçici dosya tablosu oluştur
-    FileEntry temp_table[MAX_FILES];
-    memset(temp_table, 0, sizeof(temp_table));
+        // Silinmiş, dizin olmayan ya da döngü oluşturan üst dizin
+        int dir = file_table[i].parent;
+        for (int depth = 0; dir != FS_ROOT_DIR && depth < (int) superblock.max_files; depth++) {
+            if (dir < 0 || dir >= (int) superblock.max_files || !file_table[dir].valid || file_table[dir].type != FS_TYPE_DIR) break;
+            dir = file_table[dir].parent;
+        }
+        if (dir != FS_ROOT_DIR) {
+            write(STDOUT_FILENO, "Hata: Dosyanin ust dizini gecersiz: ", 36);
+            write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
+            write(STDOUT_FILENO, "\n", 1);
+            report_error(report, "invalid_parent", i, -1, -1);
+            error_count++;
+        }
+    }
+    free(check.seen);
+    return error_count;
+}
 
-    char* buffer = malloc(BLOCK_SIZE);
-    if (!buffer) {
-        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 23);
+// Boş alan haritasını dosya tablosuyla karşılaştır: dosyaların ve metadata alanlarının
+// blokları dolu, geri kalan bloklar (commit bekleyen serbest bırakmalar hariç) boş olmalı.
+static int check_bitmap(const bool* chain_ok, uint64_t regions[][2], int region_count, IntegrityReport* report) {
+    uint64_t* expected = calloc(bitmap_words, sizeof(uint64_t));
+    if (!expected) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
         return -1;
     }
+    for (int r = 0; r < region_count; r++) set_block_bits(expected, regions[r][0], regions[r][1], true);
+    for (int k = 0; k < pending_free_count; k++) set_block_bits(expected, pending_frees[k].first, pending_frees[k].count, true);
 
-    // Her dosya sırayla yeni bloklar halinde düzenlenir
-    int next_block = METADATA_SIZE;
-    int new_index = 0;
-
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid) {
-            lseek(disk_fd, file_table[i].start_block, SEEK_SET);
-            char* content = malloc(file_table[i].size);
-            if (!content) {
-                free(buffer);
-                write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 23);
-                return -1;
+    int error_count = 0;
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (!chain_ok[i]) continue;
+        int unmarked = -1;
+        for (int e = file_table[i].first_extent; e >= 0; e = extent_table[e].next) {
+            uint64_t end = (uint64_t) extent_table[e].start + extent_table[e].length;
+            for (uint64_t b = extent_table[e].start; b < end && b < (uint64_t) total_blocks; b++) {
+                if (unmarked < 0 && !(block_bitmap[b / 64] & (1ULL << (b % 64)))) unmarked = b;
             }
+            set_block_bits(expected, extent_table[e].start, extent_table[e].length, true);
+        }
+        if (unmarked >= 0) {
+            write(STDOUT_FILENO, "Hata: Dosya bloklari bos alan haritasinda bos gorunuyor: ", 57);
+            write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
+            write(STDOUT_FILENO, "\n", 1);
+            report_error(report, "unmarked_blocks", i, -1, unmarked);
+            error_count++;
+        }
+    }
+
+    // Hiçbir dosyaya ya da metadata alanına ait olmayan dolu bloklar (sızıntı)
+    int leaked = 0;
+    int first_leaked = -1;
+    for (int w = 0; w < bitmap_words; w++) {
+        uint64_t extra = block_bitmap[w] & ~expected[w];
+        if (extra && first_leaked < 0) first_leaked = w * 64 + __builtin_ctzll(extra);
+        leaked += __builtin_popcountll(extra);
+    }
+    free(expected);
+    if (leaked > 0) {
+        char msg[96];
+        int len = snprintf(msg, sizeof(msg), "Hata: %d blok dolu isaretli ama hicbir dosyaya ait degil.\n", leaked);
+        write(STDOUT_FILENO, msg, len);
+        report_error(report, "leaked_blocks", -1, -1, first_leaked);
+        error_count++;
+    }
+    return error_count;
+}
+
+// Veri taraması: dosyalara ait her bloğun içeriği sağlama toplamıyla karşılaştırılır.
+// Bloklar SCRUB_RANGE_BLOCKS'luk aralıklara bölünür; iş parçacıkları sıradaki aralığı
+// atomik sayaçla alır. Tarama sırasında fs_lock paylaşımlı tutulduğu için bloklar değişmez.
+#define SCRUB_MAX_WORKERS 8
+#define SCRUB_RANGE_BLOCKS 256
+#define SCRUB_MAX_REPORTED 64
 
-            read(disk_fd, content, file_table[i].size);
+typedef struct {
+    uint64_t* blocks; // Taranacak bloklar (geçerli dosyaların extent'leri)
+    uint32_t zero_checksum; // Delik (tamamen sıfır) bir bloğun sağlama toplamı
+    int next_range;
+    int scanned;
+    int bad_count;
+    int bad_blocks[SCRUB_MAX_REPORTED];
+    pthread_mutex_t mutex;
+} ScrubState;
 
-            // Yeni tabloyu güncelle
-            temp_table[new_index] = file_table[i];
-            temp_table[new_index].start_block = next_block;
+static void scrub_report(ScrubState* state, int block) {
+    pthread_mutex_lock(&state->mutex);
+    if (state->bad_count < SCRUB_MAX_REPORTED) state->bad_blocks[state->bad_count] = block;
+    state->bad_count++;
+    pthread_mutex_unlock(&state->mutex);
+}
+
+static void* scrub_worker(void* arg) {
+    ScrubState* state = arg;
+    char* buffer = disk_map ? NULL : malloc((size_t) SCRUB_RANGE_BLOCKS * block_size);
+    int scanned = 0;
 
-            // Dosyayı yeni konumuna yaz
-            lseek(disk_fd, next_block, SEEK_SET);
-            write(disk_fd, content, file_table[i].size);
+    for (;;) {
+        int start = __atomic_fetch_add(&state->next_range, SCRUB_RANGE_BLOCKS, __ATOMIC_RELAXED);
+        if (start >= total_blocks) break;
+        int end = start + SCRUB_RANGE_BLOCKS;
 
-            // Bir sonraki bloğa ilerle
-            next_block += ((file_table[i].size + BLOCK_SIZE - 1) / BLOCK_SIZE) * BLOCK_SIZE;
-            new_index++;
+        // Dizi, delik ve veri parçalarına bölünür. Tamamen delik olan bloklar okunmaz,
+        // sıfır bloğun sağlama toplamıyla karşılaştırılır; veri yalnızca sıradaki deliğe kadar okunur.
+        int length;
+        for (int run = next_set_run(state->blocks, end, start, &length); run >= 0;
+             run = next_set_run(state->blocks, end, run + length, &length)) {
+            off_t run_start = (off_t) run * block_size;
+            off_t run_end = run_start + (off_t) length * block_size;
+            int holes = (next_data(run_start, run_end) - run_start) / block_size;
+            if (holes > 0) {
+                for (int b = run; b < run + holes; b++) {
+                    if (block_checksums[b] != state->zero_checksum) scrub_report(state, b);
+                }
+                scanned += holes;
+                length = holes;
+                continue;
+            }
+            off_t hole = next_hole(run_start, run_end);
+            if (hole > run_start) length = (hole - run_start + block_size - 1) / block_size;
 
-            free(content);
+            const char* data = disk_at(run_start);
+            bool readable = true;
+            if (!data) {
+                // Tampon ayrılamadıysa bloklar okunamamış sayılır ve bozuk raporlanır
+                readable = buffer && disk_read(buffer, length * block_size, run_start) == length * block_size;
+                data = buffer;
+            }
+            for (int b = 0; b < length; b++) {
+                if (readable && crc32c(0, data + (size_t) b * block_size, block_size) == block_checksums[run + b]) continue;
+                scrub_report(state, run + b);
+            }
+            scanned += length;
         }
     }
+    free(buffer);
+    __atomic_fetch_add(&state->scanned, scanned, __ATOMIC_RELAXED);
+    return NULL;
+}
 
-    // Dosya tablosunu güncelle
-    memcpy(file_table, temp_table, sizeof(file_table));
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*) a, y = *(const int*) b;
+    return (x > y) - (x < y);
+}
 
-    free(buffer);
+// Zinciri sağlam dosyaların verisini tara; bozuk blok sayısını döner (-1 = hata).
+// chain_ok NULL ise zincirler burada doğrulanır.
+static int scrub_unlocked(const bool* chain_ok, IntegrityReport* report) {
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    ScrubState state = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+    state.blocks = calloc(bitmap_words, sizeof(uint64_t));
+    char* zero = calloc(1, block_size);
+    if (!state.blocks || !zero) {
+        free(state.blocks);
+        free(zero);
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+    state.zero_checksum = crc32c(0, zero, block_size);
+    free(zero);
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (!file_table[i].valid || (chain_ok ? !chain_ok[i] : chain_blocks(i) < 0)) continue;
+        for (int e = file_table[i].first_extent; e >= 0; e = extent_table[e].next) {
+            set_block_bits(state.blocks, extent_table[e].start, extent_table[e].length, true);
+        }
+    }
 
-    int result = save_metadata();
-    if (result >= 0) {
-        write(STDOUT_FILENO, "Disk alanindaki bosluklar basariyla birlestirildi.\n", 52);
+    // Ana iş parçacığı da tarar; iş parçacığı oluşturulamazsa tarama onunla sürer
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = cpus < 1 ? 1 : cpus > SCRUB_MAX_WORKERS ? SCRUB_MAX_WORKERS : (int) cpus;
+    pthread_t threads[SCRUB_MAX_WORKERS];
+    int started_threads = 0;
+    while (started_threads < workers - 1 && pthread_create(&threads[started_threads], NULL, scrub_worker, &state) == 0) {
+        started_threads++;
     }
+    scrub_worker(&state);
+    for (int t = 0; t < started_threads; t++) pthread_join(threads[t], NULL);
+    free(state.blocks);
 
-    return result;
+    // Bozuk bloklar sahibi olan dosyayla birlikte raporlanır
+    int reported = state.bad_count < SCRUB_MAX_REPORTED ? state.bad_count : SCRUB_MAX_REPORTED;
+    qsort(state.bad_blocks, reported, sizeof(int), compare_ints);
+    char msg[FILENAME_LEN + 128];
+    for (int k = 0; k < reported; k++) {
+        int owner = -1;
+        for (int i = 0; i < (int) superblock.max_files && owner < 0; i++) {
+            if (!file_table[i].valid || (chain_ok ? !chain_ok[i] : chain_blocks(i) < 0)) continue;
+            for (int e = file_table[i].first_extent; e >= 0; e = extent_table[e].next) {
+                if ((uint32_t) state.bad_blocks[k] - extent_table[e].start < extent_table[e].length) {
+                    owner = i;
+                    break;
+                }
+            }
+        }
+        int len = snprintf(msg, sizeof(msg), "Hata: \"%s\" dosyasinin verisi bozuk (blok %d).\n",
+                           owner >= 0 ? file_table[owner].name : "?", state.bad_blocks[k]);
+        write(STDOUT_FILENO, msg, len);
+        report_error(report, "corrupt_block", owner, -1, state.bad_blocks[k]);
+    }
+
+    int len = snprintf(msg, sizeof(msg), "Veri taramasi: %d blok dogrulandi, %d bozuk blok, %.3f ms (%s)\n",
+                       state.scanned, state.bad_count, elapsed_ms_since(&started), crc32c_impl());
+    write(STDOUT_FILENO, msg, len);
+    return state.bad_count;
 }
 
-int fs_check_integrity() {
+// Dosya sisteminin tutarlılığını denetle. report_file verilirse bulunan hatalar, hata sayısı
+// ve geçen süre bu dosyaya JSON olarak yazılır. Hata sayısını döner (-1 = denetlenemedi).
+static int check_integrity_unlocked(const char* report_file) {
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
     int error_count = 0;
 
+    // Metadata alanları (blok numarası olarak): superblock, tablolar, dizin ağacı, bitmap, sağlama toplamları ve günlük
+    uint64_t regions[][2] = {
+        {0, 1},
+        {superblock.table_offset / block_size, superblock.table_blocks},
+        {superblock.extent_offset / block_size, superblock.extent_blocks},
+        {superblock.dir_offset / block_size, superblock.dir_blocks},
+        {superblock.bitmap_offset / block_size, superblock.bitmap_blocks},
+        {superblock.checksum_offset / block_size, superblock.checksum_blocks},
+        {superblock.journal_offset / block_size, superblock.journal_blocks},
+    };
+    int region_count = sizeof(regions) / sizeof(regions[0]);
+
+    bool* chain_ok = calloc(superblock.max_files, sizeof(bool));
+    if (!chain_ok) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+
+    IntegrityReport report = {.fd = -1};
+    if (report_file) {
+        report.fd = open(report_file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (report.fd < 0) {
+            write(STDOUT_FILENO, "Rapor dosyasi olusturulamadi.\n", 30);
+            free(chain_ok);
+            return -1;
+        }
+        write(report.fd, "{\n  \"errors\": [", 15);
+    }
+    int files_checked = 0;
+    int extents_checked = 0;
+
     // Dosya tablosunu kontrol et
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid) {
-            // Başlangıç bloğunun sınırlar içinde olup olmadığı kontrol edilir
-            if (file_table[i].start_block < METADATA_SIZE ||
-                file_table[i].start_block >= DISK_SIZE) {
-                write(STDOUT_FILENO, "Hata: Dosya baslangic blogu disk sinirlarinin disinda: ", 56);
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (!file_table[i].valid) continue;
+        files_checked++;
+
+        // Extent zincirinin tutarlı olup olmadığı kontrol edilir
+        int blocks = chain_blocks(i);
+        if (blocks < 0) {
+            write(STDOUT_FILENO, "Hata: Dosyanin extent zinciri bozuk: ", 37);
+            write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
+            write(STDOUT_FILENO, "\n", 1);
+            report_error(&report, "broken_chain", i, -1, -1);
+            error_count++;
+            continue;
+        }
+        chain_ok[i] = true;
+
+        // Dosya boyutunun ayrılan bloklarla uyumlu olup olmadığı kontrol edilir
+        if (file_table[i].size < 0 || blocks != file_blocks(file_table[i].size)) {
+            write(STDOUT_FILENO, "Hata: Dosya boyutu gecersiz: ", 29);
+            write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
+            write(STDOUT_FILENO, "\n", 1);
+            report_error(&report, "invalid_size", i, -1, -1);
+            error_count++;
+        }
+
+        for (int e = file_table[i].first_extent; e >= 0; e = extent_table[e].next) {
+            uint64_t start = extent_table[e].start;
+            uint64_t end = start + extent_table[e].length;
+            extents_checked++;
+
+            // Extent'in disk sınırları içinde olup olmadığı kontrol edilir
+            if (end > (uint64_t) total_blocks) {
+                write(STDOUT_FILENO, "Hata: Dosya extent'i disk sinirlarinin disinda: ", 48);
                 write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
                 write(STDOUT_FILENO, "\n", 1);
+                report_error(&report, "out_of_bounds", i, -1, start);
                 error_count++;
             }
 
-            // Dosya boyutunun sınırlar içinde olup olmadığı kontrol edilir
-            if (file_table[i].size < 0 ||
-                file_table[i].start_block + file_table[i].size > DISK_SIZE) {
-                write(STDOUT_FILENO, "Hata: Dosya boyutu gecersiz: ", 30);
-                write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
-                write(STDOUT_FILENO, "\n", 1);
-                error_count++;
+            // Extent'in metadata alanlarıyla çakışıp çakışmadığı kontrol edilir
+            for (int r = 0; r < region_count; r++) {
+                if (start < regions[r][0] + regions[r][1] && regions[r][0] < end) {
+                    write(STDOUT_FILENO, "Hata: Dosya metadata alaniyla cakisiyor: ", 41);
+                    write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
+                    write(STDOUT_FILENO, "\n", 1);
+                    report_error(&report, "metadata_overlap", i, -1, start);
+                    error_count++;
+                    break;
+                }
             }
+        }
+
+        // Dosya isimlerinin geçerli olup olmadığı kontrol edilir
+        if (strlen(file_table[i].name) == 0) {
+            write(STDOUT_FILENO, "Hata: Gecersiz dosya adi (bos) bulundu.\n", 40);
+            report_error(&report, "empty_name", i, -1, -1);
+            error_count++;
+        }
+    }
+
+    int dir_errors = check_directories(&report);
+    if (dir_errors < 0) {
+        free(chain_ok);
+        if (report.fd >= 0) close(report.fd);
+        return -1;
+    }
+    error_count += dir_errors;
 
-            // Dosya isimlerinin geçerli olup olmadığı kontrol edilir
-            if (strlen(file_table[i].name) == 0) {
-                write(STDOUT_FILENO, "Hata: Gecersiz dosya adi (bos) bulundu.\n", 41);
-                error_count++;
-            }
+    // Dosya bloklarının birbiriyle çakışıp çakışmadığı sıralı taramayla, referans sayıları
+    // ve boş alan haritasıyla uyumu ve içeriklerin sağlama toplamları kontrol edilir
+    int overlaps = check_overlaps(chain_ok, &report);
+    int ref_errors = overlaps < 0 ? -1 : check_block_refs(chain_ok, &report);
+    int bitmap_errors = ref_errors < 0 ? -1 : check_bitmap(chain_ok, regions, region_count, &report);
+    int bad_blocks = bitmap_errors < 0 ? -1 : scrub_unlocked(chain_ok, &report);
+    free(chain_ok);
+    if (bad_blocks < 0) {
+        if (report.fd >= 0) close(report.fd);
+        return -1;
+    }
+    error_count += overlaps + ref_errors + bitmap_errors + bad_blocks;
 
-            // Dosya bloklarının çakışıp çakışmadığı kontrol edilir
-            for (int j = i + 1; j < MAX_FILES; j++) {
-                if (file_table[j].valid) {
-                    // Blok aralıklarının çakışması kontrolü
-                    int start_i = file_table[i].start_block;
-                    int end_i = start_i + file_table[i].size;
-                    int start_j = file_table[j].start_block;
-                    int end_j = start_j + file_table[j].size;
-
-                    if ((start_i <= start_j && start_j < end_i) ||
-                        (start_i < end_j && end_j <= end_i) ||
-                        (start_j <= start_i && start_i < end_j) ||
-                        (start_j < end_i && end_i <= end_j)) {
-                        write(STDOUT_FILENO, "Hata: Dosya bloklari cakismasi: ", 33);
-                        write(STDOUT_FILENO, file_table[i].name, strlen(file_table[i].name));
-                        write(STDOUT_FILENO, " ve ", 4);
-                        write(STDOUT_FILENO, file_table[j].name, strlen(file_table[j].name));
-                        write(STDOUT_FILENO, "\n", 1);
-                        error_count++;
-                    }
-                }
-            }
-        }
+    if (report.fd >= 0) {
+        char summary[256];
+        int len = snprintf(summary, sizeof(summary),
+                           "%s],\n  \"error_count\": %d,\n  \"files_checked\": %d,\n  \"extents_checked\": %d,\n"
+                           "  \"elapsed_ms\": %.3f\n}\n",
+                           report.entries ? "\n  " : "", error_count, files_checked, extents_checked, elapsed_ms_since(&started));
+        write(report.fd, summary, len);
+        close(report.fd);
     }
 
     if (error_count == 0) {
-        write(STDOUT_FILENO, "Dosya sistemi butunlugu kontrol edildi, hata bulunamadi.\n", 58);
+        write(STDOUT_FILENO, "Dosya sistemi butunlugu kontrol edildi, hata bulunamadi.\n", 57);
         return 0;
     } else {
         char error_msg[64];
@@ -452,312 +3513,947 @@ int fs_check_integrity() {
     }
 }
 
-int fs_backup(const char* backup_file) {
-    if (!backup_file || strlen(backup_file) == 0) backup_file = "disk.sim.backup"; // Varsayılan yedek dosya adı
+static uint64_t new_chain_id() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return ((uint64_t) now.tv_sec << 32) ^ (uint64_t) now.tv_nsec ^ ((uint64_t) getpid() << 16);
+}
 
-    lseek(disk_fd, 0, SEEK_SET);
+// Diski yedekle. Tam yedek yalnızca dolu blokları, artımlı yedek son yedek neslinden
+// sonra değişen dolu blokları kopyalar; metadata alanları her yedekte bulunur.
+static int backup_unlocked(const char* backup_file, bool incremental) {
+    if (!backup_file || strlen(backup_file) == 0) backup_file = "disk.sim.backup"; // Varsayılan yedek dosya adı
+    if (strlen(backup_file) >= BACKUP_PATH_LEN) {
+        write(STDOUT_FILENO, "Yedek dosya adi cok uzun.\n", 26);
+        return -1;
+    }
 
-    int backup_fd = open(backup_file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
-    if (backup_fd < 0) {
-        write(STDOUT_FILENO, "Yedek dosyasi olusturulamadi.\n", 31);
+    if (incremental && backup_generation == 0) {
+        write(STDOUT_FILENO, "Onceki yedek bilgisi bulunamadi, tam yedek aliniyor.\n", 53);
+        incremental = false;
+    }
+    if (incremental && strcmp(backup_file, backup_parent) == 0) {
+        write(STDOUT_FILENO, "Artimli yedek onceki yedegin uzerine yazilamaz.\n", 48);
         return -1;
     }
 
-    // Disk içeriğini yedek dosyasına kopyala
-    char buffer[BLOCK_SIZE];
-    int bytes_read;
-    int total_bytes = 0;
+    // Yedeğin tutarlı olması için açık işlem commit edilir ve günlük boşaltılır
+    if (commit_metadata() < 0 || journal_checkpoint(&journal) < 0) return -1;
 
-    lseek(disk_fd, 0, SEEK_SET);
+    BackupHeader header;
+    memset(&header, 0, sizeof(header));
+    header.chain_id = incremental ? backup_chain_id : new_chain_id();
+    header.generation = incremental ? backup_generation + 1 : 1;
+    header.flags = incremental ? BACKUP_INCREMENTAL : 0;
+    header.disk_size = disk_size;
+    header.block_size = block_size;
+    if (incremental) strcpy(header.parent, backup_parent);
 
-    while ((bytes_read = (int) read(disk_fd, buffer, BLOCK_SIZE)) > 0) {
-        if (write(backup_fd, buffer, bytes_read) != bytes_read) {
-            write(STDOUT_FILENO, "Yedekleme sirasinda yazma hatasi olustu.\n", 42);
-            close(backup_fd);
-            return -1;
-        }
-        total_bytes += bytes_read;
+    uint64_t* selected = malloc(bitmap_words * sizeof(uint64_t));
+    if (!selected) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+    int backup_fd = backup_create(backup_file, &header);
+    if (backup_fd < 0) {
+        write(STDOUT_FILENO, "Yedek dosyasi olusturulamadi.\n", 30);
+        free(selected);
+        return -1;
     }
 
-    close(backup_fd);
+    for (int w = 0; w < bitmap_words; w++) selected[w] = block_bitmap[w] & (incremental ? changed_blocks[w] : ~0ULL);
+    set_block_bits(selected, 0, 1, true);
+    set_block_bits(selected, superblock.table_offset / block_size, superblock.table_blocks, true);
+    set_block_bits(selected, superblock.extent_offset / block_size, superblock.extent_blocks, true);
+    set_block_bits(selected, superblock.dir_offset / block_size, superblock.dir_blocks, true);
+    set_block_bits(selected, superblock.bitmap_offset / block_size, superblock.bitmap_blocks, true);
+    set_block_bits(selected, superblock.checksum_offset / block_size, superblock.checksum_blocks, true);
+    // Günlük boşaltıldığından yalnızca başlık bloğu gerekir; eski işlemler sıra numarası
+    // başlıkla eşleşmediği için yeniden oynatılmaz
+    set_block_bits(selected, superblock.journal_offset / block_size, 1, true);
+    set_block_bits(selected, superblock.journal_offset / block_size + 1, superblock.journal_blocks - 1, false);
 
-    if (bytes_read < 0) {
-        write(STDOUT_FILENO, "Yedekleme sirasinda okuma hatasi olustu.\n", 42);
+    // Seçilen bloklar ardışık dizilere ayrılır; diziler yedek modülünde parçalara bölünüp sıkıştırılır
+    int run_count = 0;
+    int length;
+    for (int start = next_set_run(selected, total_blocks, 0, &length); start >= 0;
+         start = next_set_run(selected, total_blocks, start + length, &length)) {
+        run_count++;
+    }
+    BackupRun* runs = malloc(run_count * sizeof(BackupRun));
+    if (!runs) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        free(selected);
+        close(backup_fd);
         return -1;
     }
+    int n = 0;
+    for (int start = next_set_run(selected, total_blocks, 0, &length); start >= 0;
+         start = next_set_run(selected, total_blocks, start + length, &length)) {
+        runs[n].start = start;
+        runs[n].length = length;
+        n++;
+    }
+    free(selected);
 
-    char msg[128];
-    int len = snprintf(msg, sizeof(msg), "Disk basariyla \"%s\" dosyasina yedeklendi. (%d bytes)\n", backup_file, total_bytes);
+    int result = backup_write(backup_fd, &header, disk_fd, disk_map, runs, run_count);
+    free(runs);
+    if (result < 0) {
+        write(STDOUT_FILENO, "Yedekleme sirasinda okuma/yazma hatasi olustu.\n", 47);
+        close(backup_fd);
+        return -1;
+    }
+    int64_t stored_bytes = backup_finish(backup_fd, &header);
+    if (stored_bytes < 0) {
+        write(STDOUT_FILENO, "Yedekleme sirasinda yazma hatasi olustu.\n", 41);
+        return -1;
+    }
+
+    // Sonraki artımlı yedek bu nesli temel alır
+    backup_chain_id = header.chain_id;
+    backup_generation = header.generation;
+    strcpy(backup_parent, backup_file);
+    memset(changed_blocks, 0, bitmap_words * sizeof(uint64_t));
+
+    char msg[BACKUP_PATH_LEN + 128];
+    int len;
+    if (incremental) {
+        len = snprintf(msg, sizeof(msg), "Disk artimli olarak \"%s\" dosyasina yedeklendi (nesil %u). (%llu bytes, yedek %lld bytes)\n",
+                       backup_file, header.generation, (unsigned long long) header.data_bytes, (long long) stored_bytes);
+    } else {
+        len = snprintf(msg, sizeof(msg), "Disk basariyla \"%s\" dosyasina yedeklendi. (%llu bytes, yedek %lld bytes)\n", backup_file,
+                       (unsigned long long) header.data_bytes, (long long) stored_bytes);
+    }
     write(STDOUT_FILENO, msg, len);
 
     return 0;
 }
 
-int fs_restore(const char* backup_file) {
+// Başlıksız eski yedek: disk imajının birebir kopyası
+static int64_t restore_raw_image(int backup_fd) {
+    char* buffer = malloc(STREAM_CHUNK_SIZE);
+    if (!buffer) return -1;
+
+    ssize_t bytes_read;
+    int64_t total_bytes = 0;
+    while ((bytes_read = pread(backup_fd, buffer, STREAM_CHUNK_SIZE, total_bytes)) > 0) {
+        if (pwrite(disk_fd, buffer, bytes_read, total_bytes) != bytes_read) {
+            free(buffer);
+            return -1;
+        }
+        total_bytes += bytes_read;
+    }
+    free(buffer);
+    return bytes_read < 0 ? -1 : total_bytes;
+}
+
+// Yedeği geri yükle. Artımlı bir yedek verilirse üst nesiller tam yedeğe kadar izlenir
+// ve eskiden yeniye doğru sırayla uygulanır.
+static int restore_unlocked(const char* backup_file) {
     if (!backup_file || strlen(backup_file) == 0) backup_file = "disk.sim.backup"; // Varsayılan yedek dosya adı
+    if (strlen(backup_file) >= BACKUP_PATH_LEN) {
+        write(STDOUT_FILENO, "Yedek dosya adi cok uzun.\n", 26);
+        return -1;
+    }
 
     // Yedek dosyasını aç
     int backup_fd = open(backup_file, O_RDONLY);
     if (backup_fd < 0) {
-        write(STDOUT_FILENO, "Yedek dosyasi bulunamadi.\n", 27);
+        write(STDOUT_FILENO, "Yedek dosyasi bulunamadi.\n", 26);
         return -1;
     }
 
-    // Dosya boyutunu al
-    struct stat st;
-    if (fstat(backup_fd, &st) != 0 || st.st_size > DISK_SIZE) {
-        write(STDOUT_FILENO, "Yedek dosyasi gecersiz boyutta.\n", 33);
+    // Disk, yedeğin alındığı geometriyle geri yüklenir. Ham imajlar (disk.sim kopyası)
+    // kendi superblock'larındaki boyutu, superblock'suz eski imajlar 1 MB'ı kullanır.
+    BackupHeader header;
+    int kind = backup_read_header(backup_fd, &header);
+    uint64_t restore_size = header.disk_size;
+    if (kind == 1) {
+        Superblock sb;
+        struct stat st;
+        bool has_sb = pread(backup_fd, &sb, sizeof(sb), 0) == sizeof(sb) && sb.magic == FS_MAGIC;
+        restore_size = has_sb ? sb.disk_size : LEGACY_DISK_SIZE;
+        if (fstat(backup_fd, &st) != 0 || (uint64_t) st.st_size > restore_size ||
+            (has_sb && !valid_geometry(sb.disk_size, sb.block_size))) {
+            kind = -1;
+        }
+    }
+    if (kind < 0 || (kind == 0 && !valid_geometry(header.disk_size, header.block_size))) {
+        write(STDOUT_FILENO, "Yedek dosyasi gecersiz veya bozuk.\n", 35);
+        close(backup_fd);
+        return -1;
+    }
+
+    // Zinciri en yeniden en eskiye topla; her üst nesil aynı zincirden ve bir önceki nesil olmalı
+    int chain_count = 1;
+    int* chain = malloc((kind == 0 ? header.generation : 1) * sizeof(int));
+    if (!chain) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
         close(backup_fd);
         return -1;
     }
+    chain[0] = backup_fd;
+    BackupHeader newest = header;
+    while (kind == 0 && (header.flags & BACKUP_INCREMENTAL)) {
+        BackupHeader parent;
+        int parent_fd = open(header.parent, O_RDONLY);
+        if (parent_fd < 0 || backup_read_header(parent_fd, &parent) != 0 || parent.chain_id != header.chain_id ||
+            parent.generation + 1 != header.generation || parent.disk_size != header.disk_size ||
+            parent.block_size != header.block_size) {
+            char msg[BACKUP_PATH_LEN + 64];
+            int len = snprintf(msg, sizeof(msg), "Ust yedek \"%s\" bulunamadi veya zincire ait degil.\n", header.parent);
+            write(STDOUT_FILENO, msg, len);
+            if (parent_fd >= 0) close(parent_fd);
+            for (int i = 0; i < chain_count; i++) close(chain[i]);
+            free(chain);
+            return -1;
+        }
+        chain[chain_count++] = parent_fd;
+        header = parent;
+    }
 
-    // Disk dosyasını sıfırla
+    // Açık işlem artık geçersiz; disk dosyasını sıfırla
+    lock_all_files();
+    journal_discard(&journal);
+    pending_free_count = 0;
+    unmap_disk();
     ftruncate(disk_fd, 0);
-    ftruncate(disk_fd, DISK_SIZE);
+    ftruncate(disk_fd, restore_size);
 
     // Yedekten geri yükle
-    char buffer[BLOCK_SIZE];
-    int bytes_read;
-    int total_bytes = 0;
-
-    lseek(disk_fd, 0, SEEK_SET);
-    lseek(backup_fd, 0, SEEK_SET);
-
-    while ((bytes_read = (int) read(backup_fd, buffer, BLOCK_SIZE)) > 0) {
-        if (write(disk_fd, buffer, bytes_read) != bytes_read) {
-            write(STDOUT_FILENO, "Geri yukleme sirasinda yazma hatasi olustu.\n", 45);
-            close(backup_fd);
-            return -1;
+    int64_t total_bytes = 0;
+    for (int i = chain_count - 1; i >= 0 && total_bytes >= 0; i--) {
+        int64_t bytes;
+        if (kind == 1) {
+            bytes = restore_raw_image(chain[i]);
+        } else {
+            bytes = backup_read_header(chain[i], &header) == 0 ? backup_apply(chain[i], &header, disk_fd) : -1;
         }
-        total_bytes += bytes_read;
+        total_bytes = bytes < 0 ? -1 : total_bytes + bytes;
     }
+    for (int i = 0; i < chain_count; i++) close(chain[i]);
+    free(chain);
 
-    close(backup_fd);
-
-    if (bytes_read < 0) {
-        write(STDOUT_FILENO, "Geri yukleme sirasinda okuma hatasi olustu.\n", 45);
+    if (total_bytes < 0) {
+        write(STDOUT_FILENO, "Geri yukleme sirasinda okuma/yazma hatasi olustu.\n", 50);
         return -1;
     }
 
     // Metadatayı hafızaya yükle
-    load_metadata();
+    if (load_metadata() < 0 || map_disk() != 0) {
+        write(STDOUT_FILENO, "Geri yuklenen diskin metadatasi okunamadi.\n", 43);
+        return -1;
+    }
 
-    char msg[128];
-    int len = snprintf(msg, sizeof(msg), "Disk basariyla \"%s\" dosyasindan geri yuklendi. (%d bytes)\n", backup_file, total_bytes);
+    // Yedek bağlıyken alınmış olabilir; disk düzgün kapatılana kadar temiz sayılmaz
+    superblock.state &= ~FS_STATE_CLEAN;
+    write_superblock_state();
+
+    // Disk artık geri yüklenen nesille aynı; sonraki artımlı yedek onu temel alır
+    memset(changed_blocks, 0, bitmap_words * sizeof(uint64_t));
+    backup_chain_id = kind == 0 ? newest.chain_id : 0;
+    backup_generation = kind == 0 ? newest.generation : 0;
+    strcpy(backup_parent, backup_file);
+
+    char msg[BACKUP_PATH_LEN + 128];
+    int len = snprintf(msg, sizeof(msg), "Disk basariyla \"%s\" dosyasindan geri yuklendi. (%lld bytes)\n", backup_file, (long long) total_bytes);
     write(STDOUT_FILENO, msg, len);
 
     return 0;
 }
 
+// Değişen blok kaydını sakla (temiz kapanışta). Kayıt açılışta okunup silindiği için
+// çökme sonrasında bulunmaz ve sonraki artımlı yedek tam yedeğe dönüşür.
+static void save_change_record() {
+    if (backup_generation == 0) return;
+
+    ChangeRecord record;
+    memset(&record, 0, sizeof(record));
+    record.magic = CHANGES_MAGIC;
+    record.generation = backup_generation;
+    record.chain_id = backup_chain_id;
+    memcpy(record.parent, backup_parent, BACKUP_PATH_LEN);
+    record.disk_size = disk_size;
+    record.block_size = block_size;
+
+    ssize_t bytes = bitmap_words * sizeof(uint64_t);
+    int fd = open(CHANGES_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd >= 0) {
+        if (write(fd, &record, sizeof(record)) != sizeof(record) || write(fd, changed_blocks, bytes) != bytes ||
+            fdatasync(fd) != 0) {
+            unlink(CHANGES_FILE);
+        }
+        close(fd);
+    }
+}
+
+// Kayıt yalnızca diskin şu anki geometrisiyle yazılmışsa kullanılır
+static void load_change_record() {
+    ChangeRecord record;
+    ssize_t bytes = bitmap_words * sizeof(uint64_t);
+    int fd = open(CHANGES_FILE, O_RDONLY);
+    if (fd >= 0 && read(fd, &record, sizeof(record)) == sizeof(record) && record.magic == CHANGES_MAGIC &&
+        record.disk_size == (uint64_t) disk_size && record.block_size == block_size &&
+        read(fd, changed_blocks, bytes) == bytes) {
+        backup_generation = record.generation;
+        backup_chain_id = record.chain_id;
+        memcpy(backup_parent, record.parent, BACKUP_PATH_LEN);
+        backup_parent[BACKUP_PATH_LEN - 1] = '\0';
+    } else {
+        memset(changed_blocks, 0, bytes);
+    }
+    if (fd >= 0) close(fd);
+    unlink(CHANGES_FILE);
+}
+
 // Dosyayının içeriğini ekrana yazdır
 int fs_cat(const char* filename) {
-    char buffer[BLOCK_SIZE];
-    int size = fs_size(filename);
+    begin_read();
+    int i = resolve_file(filename);
+    if (i < 0 || file_table[i].size <= 0) {
+        end_read();
+        return -1;
+    }
 
-    if (size <= 0) return -1;
+    int count;
+    Segment* segments = file_segments(i, 0, file_table[i].size, &count);
+    if (!segments) {
+        end_read();
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        return -1;
+    }
+    bool verify = verify_reads;
+    int stripe = lock_file_shared(i);
+    end_read();
 
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, filename) == 0) {
-            lseek(disk_fd, file_table[i].start_block, SEEK_SET);
-            read(disk_fd, buffer, size);
-            write(STDOUT_FILENO, buffer, size);
-            write(STDOUT_FILENO, "\n", 1);
-            return 0;
-        }
+    int result = verify && verify_segments(segments, count, filename) < 0 ? -1 : stream_segments(segments, count, STDOUT_FILENO);
+    pthread_rwlock_unlock(&file_locks[stripe]);
+    free(segments);
+    if (result < 0) return -1;
+    write(STDOUT_FILENO, "\n", 1);
+    return 0;
+}
+
+// Dosya parçalarını sırayla gezen okuma imleci
+typedef struct {
+    const Segment* segments;
+    int index;  // Sıradaki parça
+    int within; // Parça içindeki konum
+} SegmentCursor;
+
+// İmlecin bulunduğu parçada kalan bayt sayısı
+static int cursor_contiguous(const SegmentCursor* cursor) {
+    return cursor->segments[cursor->index].length - cursor->within;
+}
+
+// İmleçten sonraki 'size' baytı döndür ve imleci ilerlet. mmap modunda eşlemedeki adres
+// döner (size parçada kalan baytları aşmamalı); aksi halde parçalar tampona okunur.
+static const char* cursor_read(SegmentCursor* cursor, char* buffer, int size) {
+    if (disk_map) {
+        const char* data = disk_at(cursor->segments[cursor->index].position + cursor->within);
+        cursor->within += size;
+        if (cursor->within == cursor->segments[cursor->index].length) cursor->index++, cursor->within = 0;
+        return data;
+    }
+    for (int done = 0; done < size;) {
+        const Segment* segment = &cursor->segments[cursor->index];
+        int n = segment->length - cursor->within;
+        if (n > size - done) n = size - done;
+        if (disk_read(buffer + done, n, segment->position + cursor->within) != n) return NULL;
+        done += n;
+        cursor->within += n;
+        if (cursor->within == segment->length) cursor->index++, cursor->within = 0;
     }
+    return buffer;
+}
 
-    return -1;
+// Farklı bloklar aralıklar halinde biriktirilir; metin tamponu dolunca tek write ile yazılır
+typedef struct {
+    char text[4096];
+    size_t length;
+    int first; // Açık aralık (-1 = yok)
+    int last;
+    int count; // Farklı blok sayısı
+    bool printed;
+} DiffRanges;
+
+static void emit_diff_range(DiffRanges* ranges) {
+    if (ranges->first < 0) return;
+    if (ranges->length + 64 > sizeof(ranges->text)) {
+        write(STDOUT_FILENO, ranges->text, ranges->length);
+        ranges->length = 0;
+    }
+    if (!ranges->printed) {
+        ranges->length += snprintf(ranges->text + ranges->length, sizeof(ranges->text) - ranges->length,
+                                   "Farkli bloklar (blok boyutu %d bayt):\n", (int) block_size);
+        ranges->printed = true;
+    }
+    ranges->length += ranges->first == ranges->last
+        ? snprintf(ranges->text + ranges->length, sizeof(ranges->text) - ranges->length, " - %d\n", ranges->first)
+        : snprintf(ranges->text + ranges->length, sizeof(ranges->text) - ranges->length, " - %d-%d\n", ranges->first, ranges->last);
 }
 
-// İki dosyayı karşılaştır
-int fs_diff(const char* file1, const char* file2) {
-    if (!fs_exists(file1)) {
-        write(STDOUT_FILENO, "Birinci dosya bulunamadi: ", 27);
+// [first, last] bloklarını farklı olarak ekle; bloklar artan sırada gelir
+static void add_diff_range(DiffRanges* ranges, int first, int last) {
+    if (ranges->first >= 0 && first <= ranges->last) first = ranges->last + 1;
+    if (first > last) return;
+    ranges->count += last - first + 1;
+    if (ranges->first >= 0 && first == ranges->last + 1) {
+        ranges->last = last;
+        return;
+    }
+    emit_diff_range(ranges);
+    ranges->first = first;
+    ranges->last = last;
+}
+
+// İki dosyayı karşılaştır. Dosyalar sabit boyutlu parçalar halinde okunur ve SIMD ile
+// karşılaştırılır; ilk farkta durulur. Blok özeti istenirse tüm dosya taranır ve farklı
+// bloklar aralıklar halinde listelenir. Aynıysa 0, farklıysa 1, hata olursa -1 döner.
+int fs_diff_ex(const char* file1, const char* file2, bool block_summary, DiffStats* stats) {
+    begin_read();
+    int index1 = find_file(file1);
+    int index2 = find_file(file2);
+
+    if (index1 < 0) {
+        end_read();
+        write(STDOUT_FILENO, "Birinci dosya bulunamadi: ", 26);
         write(STDOUT_FILENO, file1, strlen(file1));
         write(STDOUT_FILENO, "\n", 1);
         return -1;
     }
 
-    if (!fs_exists(file2)) {
-        write(STDOUT_FILENO, "Ikinci dosya bulunamadi: ", 26);
+    if (index2 < 0) {
+        end_read();
+        write(STDOUT_FILENO, "Ikinci dosya bulunamadi: ", 25);
         write(STDOUT_FILENO, file2, strlen(file2));
         write(STDOUT_FILENO, "\n", 1);
         return -1;
     }
 
-    int size1 = fs_size(file1);
-    int size2 = fs_size(file2);
+    int size1 = file_table[index1].size;
+    int size2 = file_table[index2].size;
 
     if (size1 < 0 || size2 < 0) {
-        write(STDOUT_FILENO, "Dosya boyutu gecersiz.\n", 24);
+        end_read();
+        write(STDOUT_FILENO, "Dosya boyutu gecersiz.\n", 23);
         return -1;
     }
 
-    if (size1 != size2) {
-        if (size1 > size2) {
-            char msg[128];
-            int len = snprintf(msg, sizeof(msg), "Dosyalar boyut olarak farkli: \"%s\" (%d bytes) \"%s\"'den (%d bytes) daha buyuk.\n", file1, size1, file2, size2);
-            write(STDOUT_FILENO, msg, len);
-        } else {
-            char msg[128];
-            int len = snprintf(msg, sizeof(msg), "Dosyalar boyut olarak farkli: \"%s\" (%d bytes) \"%s\"'den (%d bytes) daha buyuk.\n", file2, size2, file1, size1);
-            write(STDOUT_FILENO, msg, len);
-        }
-        return 1;
-    }
+    // Yalnızca ortak uzunluk karşılaştırılır; fazlası zaten farklıdır
+    int common = size1 < size2 ? size1 : size2;
+    int count1, count2;
+    Segment* segments1 = file_segments(index1, 0, common, &count1);
+    Segment* segments2 = file_segments(index2, 0, common, &count2);
 
-    char* buf1 = malloc(size1);
-    char* buf2 = malloc(size2);
+    // Dosya kilitleri artan şerit sırasıyla alınır (aynı şerit bir kez)
+    int stripe1 = index1 % FILE_LOCK_STRIPES;
+    int stripe2 = index2 % FILE_LOCK_STRIPES;
+    lock_file_shared(stripe1 < stripe2 ? index1 : index2);
+    if (stripe1 != stripe2) lock_file_shared(stripe1 < stripe2 ? index2 : index1);
+    bool verify = verify_reads;
+    end_read();
 
-    if (buf1 == NULL || buf2 == NULL) {
-        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 23);
-        if (buf1) free(buf1);
-        if (buf2) free(buf2);
-        return -1;
+    // fd modunda iki sabit, hizalı tampon kullanılır; mmap modunda eşleme doğrudan okunur
+    char* buffer1 = NULL;
+    char* buffer2 = NULL;
+    bool read_ok = true;
+    if (!segments1 || !segments2 ||
+        (!disk_map && (posix_memalign((void**) &buffer1, 4096, STREAM_CHUNK_SIZE) != 0 ||
+                       posix_memalign((void**) &buffer2, 4096, STREAM_CHUNK_SIZE) != 0))) {
+        write(STDOUT_FILENO, "Bellek ayirma hatasi.\n", 22);
+        read_ok = false;
+    } else if (verify && (verify_segments(segments1, count1, file1) < 0 || verify_segments(segments2, count2, file2) < 0)) {
+        read_ok = false;
     }
 
-    bool file1_read = false;
-    bool file2_read = false;
-
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid && strcmp(file_table[i].name, file1) == 0) {
-            lseek(disk_fd, file_table[i].start_block, SEEK_SET);
-            read(disk_fd, buf1, size1);
-            file1_read = true;
+    DiffRanges ranges = {.first = -1};
+    int64_t first_difference = -1;
+    SegmentCursor cursor1 = {segments1, 0, 0};
+    SegmentCursor cursor2 = {segments2, 0, 0};
+    for (int offset = 0; read_ok && offset < common;) {
+        int chunk = common - offset < STREAM_CHUNK_SIZE ? common - offset : STREAM_CHUNK_SIZE;
+        if (disk_map) {
+            if (chunk > cursor_contiguous(&cursor1)) chunk = cursor_contiguous(&cursor1);
+            if (chunk > cursor_contiguous(&cursor2)) chunk = cursor_contiguous(&cursor2);
         }
-        if (file_table[i].valid && strcmp(file_table[i].name, file2) == 0) {
-            lseek(disk_fd, file_table[i].start_block, SEEK_SET);
-            read(disk_fd, buf2, size2);
-            file2_read = true;
+        const char* data1 = cursor_read(&cursor1, buffer1, chunk);
+        const char* data2 = cursor_read(&cursor2, buffer2, chunk);
+        if (!data1 || !data2) {
+            write(STDOUT_FILENO, "Dosya okuma hatasi.\n", 20);
+            read_ok = false;
+            break;
+        }
+
+        // Özet istenirse farklı bloğun geri kalanı atlanıp sonraki blok sınırından devam edilir
+        for (int position = 0; position < chunk;) {
+            int same = (int) memdiff(data1 + position, data2 + position, chunk - position);
+            if (same == chunk - position) break;
+            int64_t at = (int64_t) offset + position + same;
+            if (first_difference < 0) first_difference = at;
+            if (!block_summary) break;
+            int block = at / block_size;
+            add_diff_range(&ranges, block, block);
+            position = (block + 1) * block_size - offset;
         }
+        if (first_difference >= 0 && !block_summary) break;
+        offset += chunk;
     }
 
-    if (!file1_read || !file2_read) {
-        write(STDOUT_FILENO, "Dosya okuma hatasi.\n", 21);
-        free(buf1);
-        free(buf2);
-        return -1;
+    pthread_rwlock_unlock(&file_locks[stripe1]);
+    if (stripe1 != stripe2) pthread_rwlock_unlock(&file_locks[stripe2]);
+    free(buffer1);
+    free(buffer2);
+    free(segments1);
+    free(segments2);
+    if (!read_ok) return -1;
+
+    // Boyutlar farklıysa ortak kısımdan sonraki bloklar yalnızca bir dosyada vardır
+    int larger = size1 > size2 ? size1 : size2;
+    int compared_blocks = file_blocks(larger);
+    if (size1 != size2) {
+        if (first_difference < 0) first_difference = common;
+        if (block_summary) add_diff_range(&ranges, common / block_size, compared_blocks - 1);
+
+        char msg[128];
+        int len = size1 > size2
+            ? snprintf(msg, sizeof(msg), "Dosyalar boyut olarak farkli: \"%s\" (%d bytes) \"%s\"'den (%d bytes) daha buyuk.\n", file1, size1, file2, size2)
+            : snprintf(msg, sizeof(msg), "Dosyalar boyut olarak farkli: \"%s\" (%d bytes) \"%s\"'den (%d bytes) daha buyuk.\n", file2, size2, file1, size1);
+        write(STDOUT_FILENO, msg, len);
     }
 
-    int result = memcmp(buf1, buf2, size1);
-    if (result == 0) {
-        write(STDOUT_FILENO, "Dosyalar ayni.\n", 16);
-    } else {
-        write(STDOUT_FILENO, "Dosyalar farkli.\n", 18);
+    if (block_summary) {
+        emit_diff_range(&ranges);
+        ranges.length += snprintf(ranges.text + ranges.length, sizeof(ranges.text) - ranges.length,
+                                  "Farkli blok sayisi: %d / %d\n", ranges.count, compared_blocks);
+        write(STDOUT_FILENO, ranges.text, ranges.length);
+    }
+
+    if (stats) {
+        stats->first_difference = first_difference;
+        stats->blocks_total = compared_blocks;
+        stats->blocks_different = block_summary ? ranges.count : (first_difference >= 0);
+    }
+
+    if (first_difference < 0) {
+        write(STDOUT_FILENO, "Dosyalar ayni.\n", 15);
+        return 0;
     }
+    char msg[64];
+    int len = snprintf(msg, sizeof(msg), "Dosyalar farkli, ilk farkli bayt: %lld\n", (long long) first_difference);
+    write(STDOUT_FILENO, msg, len);
+    return 1;
+}
+
+int fs_diff(const char* file1, const char* file2) {
+    return fs_diff_ex(file1, file2, false, NULL);
+}
 
-    free(buf1);
-    free(buf2);
+// Kilitli genel API: her işlem metadata kilidini alır, asıl işi *_unlocked sürümü yapar
+bool fs_init() {
+    begin_update();
+    bool result = init_unlocked();
+    end_update();
     return result;
 }
 
-// Log dosyasını göster
-int fs_log() {
-    // Yazma için açık olan log dosyasını kapat
-    if (log_fd >= 0) {
-        close(log_fd);
-        log_fd = -1;
-    }
+int fs_create(const char* filename) {
+    begin_update();
+    int result = create_unlocked(filename);
+    end_update();
+    return result;
+}
+
+int fs_delete(const char* filename) {
+    begin_update();
+    int result = delete_unlocked(filename);
+    end_update();
+    return result;
+}
 
-    // Log dosyasını okuma için aç
-    int read_log_fd = open(LOG_FILE, O_RDONLY);
-    if (read_log_fd < 0) {
-        write(STDOUT_FILENO, "Log dosyasi bulunamadi veya okunamadi.\n", 40);
-        log_init(); // Yazma için yeniden aç
+int fs_mkdir(const char* path) {
+    begin_update();
+    int result = mkdir_unlocked(path);
+    end_update();
+    return result;
+}
+
+int fs_rmdir(const char* path) {
+    begin_update();
+    int result = rmdir_unlocked(path);
+    end_update();
+    return result;
+}
+
+int fs_write(const char* filename, const char* data, int size) {
+    begin_update();
+    int result = write_unlocked(filename, data, size);
+    end_update();
+    return result;
+}
+
+// Host dosyasını diske aktar; aktarılan bayt sayısını döner
+int fs_import(const char* host_path, const char* filename) {
+    int host_fd = open(host_path, O_RDONLY);
+    if (host_fd < 0) {
+        write(STDOUT_FILENO, "Host dosyasi acilamadi.\n", 24);
         return -1;
     }
+    begin_update();
+    int result = import_unlocked(host_fd, filename);
+    end_update();
+    close(host_fd);
+    return result;
+}
+
+int fs_append(const char* filename, const char* data, int size) {
+    begin_update();
+    int result = append_unlocked(filename, data, size);
+    end_update();
+    return result;
+}
+
+int fs_truncate(const char* filename, int new_size) {
+    begin_update();
+    int result = truncate_unlocked(filename, new_size);
+    end_update();
+    return result;
+}
+
+int fs_copy(const char* src, const char* dest) {
+    begin_update();
+    int result = copy_unlocked(src, dest);
+    end_update();
+    return result;
+}
+
+int fs_mv(const char* old_path, const char* new_path) {
+    begin_update();
+    int result = mv_unlocked(old_path, new_path);
+    end_update();
+    return result;
+}
+
+// Diski formatla
+int fs_format() {
+    begin_update();
+    int result = format_unlocked(superblock.max_files, 0, 0);
+    end_update();
+    return result;
+}
+
+int fs_format_ex(int max_files) {
+    begin_update();
+    int result = format_unlocked(max_files, 0, 0);
+    end_update();
+    return result;
+}
+
+// Diski verilen dosya kapasitesi, disk boyutu ve blok boyutuyla formatla (0 = mevcut değer)
+int fs_format_geometry(int max_files, uint64_t size, int bsize) {
+    begin_update();
+    int result = format_unlocked(max_files > 0 ? max_files : (int) superblock.max_files, size, bsize);
+    end_update();
+    return result;
+}
+
+uint64_t fs_disk_size() {
+    begin_read();
+    uint64_t size = disk_size;
+    end_read();
+    return size;
+}
+
+int fs_block_size() {
+    begin_read();
+    int size = block_size;
+    end_read();
+    return size;
+}
+
+int fs_backup(const char* backup_file) {
+    begin_update();
+    int result = backup_unlocked(backup_file, false);
+    end_update();
+    return result;
+}
+
+int fs_backup_incremental(const char* backup_file) {
+    begin_update();
+    int result = backup_unlocked(backup_file, true);
+    end_update();
+    return result;
+}
+
+int fs_restore(const char* backup_file) {
+    begin_update();
+    int result = restore_unlocked(backup_file);
+    end_update();
+    return result;
+}
+
+void fs_ls(bool is_called_from_menu) {
+    begin_read();
+    ls_unlocked(FS_ROOT_DIR, NULL, is_called_from_menu);
+    end_read();
+}
+
+int fs_ls_dir(const char* path, const char* prefix) {
+    begin_read();
+    int dir;
+    int result = resolve_dir(path, &dir);
+    if (result == 0) ls_unlocked(dir, prefix, true);
+    end_read();
+    return result;
+}
+
+int fs_list(const char* path, const char* prefix, FsListCursor* cursor, FsDirEntry* entries, int max_entries) {
+    if (cursor == NULL || entries == NULL || max_entries < 0) return -1;
+    begin_read();
+    int dir;
+    int result = resolve_dir(path, &dir);
+    if (result == 0) result = list_unlocked(dir, prefix, cursor, entries, max_entries);
+    end_read();
+    return result;
+}
+
+int fs_check_integrity() {
+    begin_read();
+    int result = check_integrity_unlocked(NULL);
+    end_read();
+    return result;
+}
+
+// Bütünlük denetimini yap ve sonucu JSON raporu olarak report_file'a da yaz
+int fs_check_integrity_report(const char* report_file) {
+    begin_read();
+    int result = check_integrity_unlocked(report_file);
+    end_read();
+    return result;
+}
 
-    // Log içeriğini oku ve göster
-    char buffer[BLOCK_SIZE];
-    int bytes_read;
+// Yalnızca dosya verisini sağlama toplamlarıyla doğrula; bozuk blok sayısını döner
+int fs_scrub() {
+    begin_read();
+    int result = scrub_unlocked(NULL, NULL);
+    end_read();
+    return result;
+}
 
-    write(STDOUT_FILENO, "\n==============DOSYA SISTEMI ISLEM GUNLUGU==============\n\n", 59);
+// Açık işlemi hemen commit et
+int fs_sync() {
+    begin_update();
+    int result = commit_metadata();
+    end_update();
+    return result;
+}
 
-    while ((bytes_read = (int) read(read_log_fd, buffer, BLOCK_SIZE - 1)) > 0) {
-        buffer[bytes_read] = '\0';
-        write(STDOUT_FILENO, buffer, bytes_read);
+// Açık işlemi commit et, günlüğü boşalt ve diski kapat
+void fs_close() {
+    fs_defragment_stop(NULL);
+    stop_commit_thread();
+    begin_update();
+    if (disk_fd < 0) {
+        end_update();
+        return;
     }
+    commit_metadata();
+    journal_checkpoint(&journal);
+    fdatasync(disk_fd);
+    superblock.state |= FS_STATE_CLEAN;
+    write_superblock_state();
+    save_change_record();
+    unmap_disk();
+    journal_release(&journal);
+    close(disk_fd);
+    disk_fd = -1;
+    end_update();
+}
 
-    write(STDOUT_FILENO, "\n=======================================================\n", 58);
+// Grup commit ayarları: en fazla max_ops işlem ya da max_delay_ms süre biriktirilir.
+// max_ops 1 verilirse her işlem ayrı ayrı commit edilir.
+void fs_set_group_commit(int max_ops, int max_delay_ms) {
+    begin_update();
+    group_commit_ops = max_ops > 0 ? max_ops : 1;
+    group_commit_ms = max_delay_ms >= 0 ? max_delay_ms : 0;
+    end_update();
+}
 
-    close(read_log_fd);
+// Disk erişim modunu seç; disk açıldıktan sonra değiştirilemez
+int fs_set_io_mode(int mode) {
+    begin_update();
+    int result = -1;
+    if (disk_fd < 0 && (mode == FS_IO_FD || mode == FS_IO_MMAP)) {
+        io_mode = mode;
+        result = 0;
+    }
+    end_update();
+    return result;
+}
 
-    // Log dosyasını yeniden yazma için aç
-    log_init();
+// Okumalarda sağlama toplamı doğrulamasını aç ya da kapat
+void fs_set_verify_reads(bool enabled) {
+    begin_update();
+    verify_reads = enabled;
+    end_update();
+}
 
+// fs_copy modunu seç (FS_COPY_DATA ya da FS_COPY_REFLINK)
+int fs_set_copy_mode(int mode) {
+    if (mode != FS_COPY_DATA && mode != FS_COPY_REFLINK) return -1;
+    begin_update();
+    copy_mode = mode;
+    end_update();
     return 0;
 }
 
-// İşlemi logla
-// Log formatı: [ZAMAN] IŞLEM: İŞLEM YAPILAN DOSYA
-void log_operation(const char* operation, const char* details) {
-    if (log_fd >= 0) {
-        time_t now = time(NULL);
-        struct tm time_info_data;
-        struct tm* time_info = &time_info_data;
-        localtime_r(&now, time_info);
-        char time_str[32];
-        strftime(time_str, sizeof(time_str), "%d-%m-%Y %H:%M:%S", time_info);
+// Log dosyalarını (döndürülmüş eski dosyalar dahil, eskiden yeniye) okunur biçimde göster
+int fs_log() {
+    // Tampondaki kayıtlar önce dosyaya yazılır
+    log_flush();
 
-        char log_entry[512];
-        int len;
+    char paths[LOG_ROTATE_KEEP + 1][64];
+    log_file_paths(paths);
+    LogView views[LOG_ROTATE_KEEP + 1];
+    uint64_t total = 0;
+    for (int k = 0; k <= LOG_ROTATE_KEEP; k++) {
+        if (log_open_view(paths[k], &views[k]) < 0) {
+            write(STDOUT_FILENO, "Log dosyasi okunamadi: ", 23);
+            write(STDOUT_FILENO, paths[k], strlen(paths[k]));
+            write(STDOUT_FILENO, "\n", 1);
+        }
+        total += views[k].count;
+    }
+    if (total == 0) {
+        write(STDOUT_FILENO, "Log dosyasi bulunamadi veya okunamadi.\n", 39);
+        return -1;
+    }
 
-        // Detay yoksa sadece işlem loglanır
-        if (details == NULL || details[0] == '\0')
-            len = snprintf(log_entry, sizeof(log_entry), "[%s] %s\n", time_str, operation);
-        else
-            len = snprintf(log_entry, sizeof(log_entry), "[%s] %s: %s\n", time_str, operation, details);
+    write(STDOUT_FILENO, "\n==============DOSYA SISTEMI ISLEM GUNLUGU==============\n\n", 58);
 
-        write(log_fd, log_entry, len);
+    // Satırlar tamponda biriktirilip büyük parçalar halinde yazılır
+    char buffer[STREAM_CHUNK_SIZE];
+    int length = 0;
+    LogTimeCache cache = {.second = -1};
+    for (int k = 0; k <= LOG_ROTATE_KEEP; k++) {
+        for (uint64_t i = 0; i < views[k].count; i++) {
+            if (length > (int) sizeof(buffer) - 256) {
+                write(STDOUT_FILENO, buffer, length);
+                length = 0;
+            }
+            length += log_format_entry(&views[k].entries[i], &cache, buffer + length, sizeof(buffer) - length);
+        }
+        log_close_view(&views[k]);
     }
-}
+    write(STDOUT_FILENO, buffer, length);
 
-static int find_free_block(int required_size) {
-    // Kullanılan blokları işaretle
-    bool used_blocks[DISK_SIZE / BLOCK_SIZE];
-    memset(used_blocks, 0, sizeof(used_blocks));
+    write(STDOUT_FILENO, "\n=======================================================\n", 57);
+    return 0;
+}
 
-    // Metadata alanını kullanılıyor olarak işaretle
-    int metadata_blocks = METADATA_SIZE / BLOCK_SIZE;
-    for (int i = 0; i < metadata_blocks; i++) {
-        used_blocks[i] = true;
+// Blok referans sayılarını extent tablosundan yeniden hesapla
+static void rebuild_block_refs() {
+    memset(block_refs, 0, total_blocks * sizeof(uint16_t));
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (!file_table[i].valid) continue;
+        for (int e = file_table[i].first_extent; e >= 0; e = extent_table[e].next) {
+            if (extent_table[e].start + extent_table[e].length <= (uint32_t) total_blocks) ref_blocks(extent_table[e].start, extent_table[e].length);
+        }
     }
+}
 
-    // Geçerli dosyaların bloklarını işaretle
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (file_table[i].valid) {
-            int start_block = file_table[i].start_block / BLOCK_SIZE;
-            int blocks_count = (file_table[i].size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+// Dosyalara ait tüm blokların sağlama toplamlarını diskteki içerikten yeniden hesapla
+// (dönüştürme ve düzgün kapatılmamış diskin bağlanması sırasında). Değişen kayıt sayısını döner.
+static int rebuild_checksums() {
+    uint32_t* previous = malloc(total_blocks * sizeof(uint32_t));
+    char* buffer = disk_map ? NULL : malloc(STREAM_CHUNK_SIZE);
+    if (!previous || (!disk_map && !buffer)) {
+        free(previous);
+        free(buffer);
+        return -1;
+    }
+    memcpy(previous, block_checksums, total_blocks * sizeof(uint32_t));
 
-            for (int j = 0; j < blocks_count; j++) {
-                if ((start_block + j) < (DISK_SIZE / BLOCK_SIZE)) {
-                    used_blocks[start_block + j] = true;
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (!file_table[i].valid) continue;
+        for (int e = file_table[i].first_extent; e >= 0; e = extent_table[e].next) {
+            off_t position = (off_t) extent_table[e].start * block_size;
+            off_t end = position + (off_t) extent_table[e].length * block_size;
+            if (end > disk_size) continue;
+            while (position < end) {
+                int chunk = end - position < STREAM_CHUNK_SIZE ? end - position : STREAM_CHUNK_SIZE;
+                const char* data = disk_map ? disk_map + position : buffer;
+                if (!disk_map && pread(disk_fd, buffer, chunk, position) != chunk) {
+                    free(previous);
+                    free(buffer);
+                    return -1;
                 }
+                update_checksums(position, chunk, data);
+                position += chunk;
             }
         }
     }
+    free(buffer);
 
-    // Gerekli blok sayısını hesapla
-    int required_blocks = (required_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    if (required_blocks == 0) required_blocks = 1; // Minimum 1 blok
+    int changed = 0;
+    for (int b = 0; b < total_blocks; b++) changed += block_checksums[b] != previous[b];
+    free(previous);
+    return changed;
+}
 
-    // İlk yeterli boş alanı bul
-    int consecutive_free = 0;
-    int start_block = -1;
+// Bitmap'i dosya tablosundan yeniden oluştur (eski imajlar ve defragmentasyon sonrası)
+static void bitmap_rebuild() {
+    bitmap_reset();
+    for (int i = 0; i < (int) superblock.max_files; i++) {
+        if (!file_table[i].valid) continue;
+        for (int e = file_table[i].first_extent; e >= 0; e = extent_table[e].next) {
+            bitmap_mark(extent_table[e].start, extent_table[e].length, true);
+        }
+    }
+}
 
-    for (int i = metadata_blocks; i < (DISK_SIZE / BLOCK_SIZE); i++) {
-        if (!used_blocks[i]) {
-            if (consecutive_free == 0) {
-                start_block = i * BLOCK_SIZE;
-            }
-            consecutive_free++;
+// Gerekli sayıda bloğu tutan ilk boş blok dizisini bul (ilk blok numarası döner).
+// Bitmap kelime kelime taranır: tamamen dolu kelimeler atlanır, boş/dolu bit
+// dizileri ctz ile tek adımda geçilir.
+static int find_free_blocks(int required_blocks) {
+    if (required_blocks > free_block_count) return -1;
 
-            if (consecutive_free >= required_blocks) {
-                return start_block;
+    // İpucundan önceki kelimeler dolu olduğundan arama oradan başlar
+    while (bitmap_hint < bitmap_words && block_bitmap[bitmap_hint] == ~0ULL) bitmap_hint++;
+
+    int run_start = 0;
+    int run_length = 0;
+
+    for (int w = bitmap_hint; w < bitmap_words; w++) {
+        uint64_t word = block_bitmap[w];
+
+        if (word == ~0ULL) {
+            run_length = 0;
+            continue;
+        }
+
+        if (word == 0) {
+            if (run_length == 0) run_start = w * 64;
+            run_length += 64;
+            if (run_length >= required_blocks) return run_start;
+            continue;
+        }
+
+        int bit = 0;
+        while (bit < 64) {
+            uint64_t rest = word >> bit;
+            if (rest & 1) {
+                // Dolu bitleri atla
+                bit += __builtin_ctzll(~rest);
+                run_length = 0;
+            } else {
+                // Boş bitleri say
+                int n = rest ? __builtin_ctzll(rest) : 64 - bit;
+                if (run_length == 0) run_start = w * 64 + bit;
+                run_length += n;
+                if (run_length >= required_blocks) return run_start;
+                bit += n;
             }
-        } else {
-            consecutive_free = 0;
-            start_block = -1;
         }
     }
 
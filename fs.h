@@ -2,32 +2,179 @@
 #define FS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 
 #define DISK_FILE "disk.sim"
 #define LOG_FILE "disk.log"
-#define DISK_SIZE 1048576  // 1 MB
-#define METADATA_SIZE 4096 // 4 KB
-#define BLOCK_SIZE 512
-#define MAX_FILES 64
-#define FILENAME_LEN 32
+#define CHANGES_FILE "disk.sim.changes" // Artımlı yedek için değişen blokların kaydı
+// Disk geometrisi formatlarken seçilir ve superblock'ta saklanır; bunlar yalnızca varsayılanlardır
+#define DEFAULT_DISK_SIZE 1048576 // 1 MB
+#define DEFAULT_BLOCK_SIZE 512
+#define MIN_BLOCK_SIZE 512
+#define MAX_BLOCK_SIZE 65536
+#define DEFAULT_MAX_FILES 64 // Formatlarken kapasite verilmezse kullanılır
+#define FILENAME_LEN 32 // Yol bileşeni (dosya ya da dizin adı) en fazla FILENAME_LEN - 1 karakter
+#define FS_PATH_LEN 256   // '/' ile ayrılmış tam yol
+#define FS_ROOT_DIR -1    // Kök dizin dosya tablosunda yer almaz; kökteki girdilerin üst dizini
+
+// Sürüm 0 (superblock'suz) eski imajlar: 64 girdilik tablo diskin başında, veri 4 KB'den sonra
+#define LEGACY_MAX_FILES 64
+#define LEGACY_METADATA_SIZE 4096 // 4 KB
+#define LEGACY_DISK_SIZE 1048576   // Eski imajlar her zaman 1 MB ve 512 baytlık bloklu
+#define LEGACY_BLOCK_SIZE 512
+
+#define FS_MAGIC 0x5346537F // "\x7fSFS"
+#define FS_VERSION 5
+
+// Grup commit: bu kadar işlem biriktiğinde ya da ilk işlemin üzerinden bu kadar
+// süre geçtiğinde açık işlem tek fsync ile günlüğe yazılır. Süre, arkasından yeni
+// işlem gelmese de arka plandaki bir zamanlayıcıyla uygulanır.
+#define DEFAULT_GROUP_COMMIT_OPS 32
+#define DEFAULT_GROUP_COMMIT_MS 100
+// Günlük alanı diskin 1/32'si kadardır ama büyük disklerde bu boyutla sınırlanır
+#define MAX_JOURNAL_SIZE (64ULL * 1024 * 1024)
+
+// Disk erişim modu: FS_IO_FD lseek/read/write kullanır, FS_IO_MMAP disk.sim dosyasını
+// belleğe eşler. Derlemede -DDEFAULT_IO_MODE=FS_IO_MMAP ile ya da fs_init öncesinde
+// fs_set_io_mode ile seçilir.
+#define FS_IO_FD 0
+#define FS_IO_MMAP 1
+#ifndef DEFAULT_IO_MODE
+#define DEFAULT_IO_MODE FS_IO_FD
+#endif
+
+// fs_copy modu: FS_COPY_DATA içeriği disk.sim içinde kopyalar, FS_COPY_REFLINK yalnızca
+// extent'leri paylaştırır; paylaşılan bloklar ilk yazmada kopyalanır (copy-on-write)
+#define FS_COPY_DATA 0
+#define FS_COPY_REFLINK 1
+#ifndef DEFAULT_COPY_MODE
+#define DEFAULT_COPY_MODE FS_COPY_DATA
+#endif
+
+// Birleştirme adımı başına taşınan en fazla blok sayısı ve arka plan adımları arasındaki bekleme
+#define DEFAULT_DEFRAG_STEP_BLOCKS 256
+#define DEFAULT_DEFRAG_INTERVAL_MS 50
+
+// Birleştirme turunun sonucu
+typedef struct {
+    int files_checked; // İncelenen dosya sayısı
+    int files_moved;   // Taşınan dosya sayısı
+    uint64_t bytes_moved;
+    double elapsed_ms; // Adımların kilit altında geçirdiği toplam süre
+} DefragStats;
+
+// fs_diff_ex'in sonucu
+typedef struct {
+    int64_t first_difference; // İlk farklı baytın ofseti (-1 = dosyalar aynı)
+    int blocks_total;         // Büyük dosyanın blok sayısı
+    int blocks_different;     // Farklı blok sayısı (yalnızca blok özetinde tam sayılır)
+} DiffStats;
+
+// Okumalarda blok sağlama toplamlarını doğrula: derlemede -DDEFAULT_VERIFY_READS=1 ile
+// ya da fs_set_verify_reads ile açılır
+#ifndef DEFAULT_VERIFY_READS
+#define DEFAULT_VERIFY_READS 0
+#endif
+
+// Dizin ağacının düğüm tablosu başlangıçta bu kadar dosya başına bir düğümle ayrılır
+#define FILES_PER_DIR_NODE 16
+
+// Extent tablosu başlangıçta dosya başına bu kadar kayıtla ayrılır, dolunca büyütülür
+#define EXTENTS_PER_FILE 2
+
+// Dosyaya ait ardışık blok dizisi. Bir dosyanın extent'leri extent tablosunda
+// 'next' ile birbirine bağlı bir liste oluşturur.
+typedef struct {
+    uint32_t start;  // İlk blok numarası
+    uint32_t length; // Blok sayısı (0 = boş kayıt)
+    int32_t next;    // Dosyanın sonraki extent'i (-1 = son extent)
+    uint32_t flags;
+} Extent;
+
+// Extent'in blokları fs_copy ile başka dosyalarla paylaşılıyor (yazmada kopyalanır)
+#define EXTENT_SHARED 0x1
 
 typedef struct {
     char name[FILENAME_LEN];
     int size;
-    int start_block;
+    int first_extent; // Extent tablosundaki ilk ve son kayıt (-1 = blok ayrılmamış)
+    int last_extent;
+    int extent_count;
     time_t created_at;
     bool valid;
+    uint8_t type;   // FS_TYPE_FILE ya da FS_TYPE_DIR
+    int32_t parent; // Girdinin bulunduğu dizin (FS_ROOT_DIR = kök)
 } FileEntry;
 
-bool log_init();
+// Dizinler de dosya tablosunda birer girdidir; blokları yoktur, içerikleri dizin ağacındadır
+#define FS_TYPE_FILE 0
+#define FS_TYPE_DIR 1
+
+// fs_list'in döndürdüğü dizin girdisi
+typedef struct {
+    char name[FILENAME_LEN];
+    int size;
+    uint8_t type; // FS_TYPE_FILE ya da FS_TYPE_DIR
+    time_t created_at;
+} FsDirEntry;
+
+// Sayfalı listelemenin kaldığı yer. Sıfırlanmış imleç listenin başını gösterir; konum ada göre
+// tutulduğundan sayfalar arasında girdi eklenip silinse de listeleme kaldığı yerden sürer.
+typedef struct {
+    char last[FILENAME_LEN]; // Son döndürülen girdinin adı
+    bool done;               // Liste sona erdi
+} FsListCursor;
+
+// Diskin ilk bloğunda tutulan superblock: disk düzenini ve metadata alanlarının yerini tanımlar
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t block_size;
+    uint32_t max_files;     // Dosya tablosu kapasitesi (inode sayısı)
+    uint32_t max_extents;   // Extent tablosu kapasitesi
+    uint32_t state;         // FS_STATE_* bayrakları
+    uint64_t disk_size;
+    uint64_t table_offset;  // Dosya tablosunun bayt ofseti
+    uint64_t table_blocks;
+    uint64_t extent_offset; // Extent tablosunun bayt ofseti
+    uint64_t extent_blocks;
+    uint64_t bitmap_offset; // Boş alan bitmap'inin bayt ofseti
+    uint64_t bitmap_blocks;
+    uint64_t journal_offset; // Metadata günlüğünün bayt ofseti
+    uint64_t journal_blocks;
+    uint64_t checksum_offset; // Blok sağlama toplamlarının (CRC32C) bayt ofseti
+    uint64_t checksum_blocks;
+    uint64_t dir_offset;     // Dizin B-ağacı düğüm tablosunun bayt ofseti
+    uint64_t dir_blocks;
+    uint32_t max_dir_nodes;  // Düğüm tablosu kapasitesi
+    int32_t dir_root;        // Kök düğümün indeksi
+} Superblock;
+
+// Disk fs_close ile düzgün kapatıldı; bağlanırken temizlenir. Bayrak yoksa son commit'ten
+// sonra yazılan blokların sağlama toplamları eski olabilir ve yeniden hesaplanır.
+#define FS_STATE_CLEAN 0x1
+
 bool fs_init();
 int fs_create(const char* filename);
 int fs_delete(const char* filename);
 int fs_write(const char* filename, const char* data, int size);
 int fs_read(const char* filename, int offset, int size, char* buffer);
+int fs_read_to_fd(const char* filename, int offset, int size, int out_fd);
+int fs_import(const char* host_path, const char* filename);
+int fs_export(const char* filename, const char* host_path);
 void fs_ls(bool is_called_from_menu);
+int fs_ls_dir(const char* path, const char* prefix); // prefix: NULL ya da "" = tüm girdiler
+// Dizindeki girdilerden imleçten sonraki en fazla max_entries tanesini ada göre sıralı döndür.
+// Dönüş değeri yazılan girdi sayısıdır (0 = liste bitti, -1 = dizin bulunamadı).
+int fs_list(const char* path, const char* prefix, FsListCursor* cursor, FsDirEntry* entries, int max_entries);
+int fs_mkdir(const char* path);
+int fs_rmdir(const char* path);
 int fs_format();
+int fs_format_ex(int max_files);
+int fs_format_geometry(int max_files, uint64_t disk_size, int block_size); // 0 = mevcut değeri koru
+uint64_t fs_disk_size();
+int fs_block_size();
 int fs_rename(const char* old_name, const char* new_name);
 bool fs_exists(const char* filename);
 int fs_size(const char* filename);
@@ -36,13 +183,24 @@ int fs_truncate(const char* filename, int new_size);
 int fs_copy(const char* src, const char* dest);
 int fs_mv(const char* old_path, const char* new_path);
 int fs_defragment();
+int fs_defragment_step(int max_blocks, DefragStats* stats);
+int fs_defragment_start(int step_blocks, int interval_ms);
+void fs_defragment_stop(DefragStats* stats);
 int fs_check_integrity();
+int fs_check_integrity_report(const char* report_file);
+int fs_scrub();
 int fs_backup(const char* filename);
+int fs_backup_incremental(const char* filename);
 int fs_restore(const char* filename);
 int fs_cat(const char* filename);
-int fs_diff(const char* file1, const char* file2);
+int fs_diff(const char* file1, const char* file2); // 0 = aynı, 1 = farklı, -1 = hata
+int fs_diff_ex(const char* file1, const char* file2, bool block_summary, DiffStats* stats);
 int fs_log();
-void log_operation(const char* operation, const char* details);
-static int find_free_block(int required_size);
+int fs_sync();
+void fs_close();
+void fs_set_group_commit(int max_ops, int max_delay_ms);
+int fs_set_io_mode(int mode);
+int fs_set_copy_mode(int mode);
+void fs_set_verify_reads(bool enabled);
 
 #endif
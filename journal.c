@@ -0,0 +1,193 @@
+#include "journal.h"
+#include "crc32c.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// İşlemler 8 bayt hizalı yazılır
+#define ALIGN8(n) (((n) + 7) & ~(uint64_t) 7)
+
+// Başlık bloğundan sonra işlemler için kullanılabilen alan
+static uint64_t journal_space(const Journal* journal) { return journal->size - journal->block_size; }
+
+static off_t journal_data_start(const Journal* journal) { return journal->offset + journal->block_size; }
+
+void journal_attach(Journal* journal, int fd, off_t offset, uint64_t size, uint32_t block_size, uint64_t disk_size) {
+    journal_discard(journal);
+    journal->fd = fd;
+    journal->offset = offset;
+    journal->size = size;
+    journal->block_size = block_size;
+    journal->disk_size = disk_size;
+    journal->sequence = 1;
+    journal->head = 0;
+}
+
+static int write_header(Journal* journal) {
+    JournalHeader header = {JOURNAL_MAGIC, 0, journal->sequence};
+    if (pwrite(journal->fd, &header, sizeof(header), journal->offset) != sizeof(header)) return -1;
+    journal->head = 0;
+    return 0;
+}
+
+// Boş bir günlük başlığı yaz (formatlama sırasında)
+int journal_format(Journal* journal) {
+    journal->sequence = 1;
+    return write_header(journal);
+}
+
+// Kayıtları ev konumlarına uygula
+static int apply_records(Journal* journal, const char* payload, size_t length, uint32_t record_count) {
+    size_t pos = 0;
+    for (uint32_t i = 0; i < record_count; i++) {
+        if (pos + sizeof(JournalRecord) > length) return -1;
+        const JournalRecord* record = (const JournalRecord*) (payload + pos);
+        pos += sizeof(JournalRecord);
+
+        if (pos + record->length > length || record->offset + record->length > journal->disk_size) return -1;
+        if (pwrite(journal->fd, payload + pos, record->length, record->offset) != (ssize_t) record->length) return -1;
+        pos += ALIGN8(record->length);
+    }
+    return 0;
+}
+
+// Başlıktaki sıra numarasından başlayarak geçerli işlemleri sırayla uygula.
+// Sıra numarası tutmayan, yarım kalmış ya da sağlama toplamı bozuk ilk işlemde durulur.
+int journal_replay(Journal* journal, JournalReplayStats* stats) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    memset(stats, 0, sizeof(*stats));
+
+    JournalHeader header;
+    if (pread(journal->fd, &header, sizeof(header), journal->offset) != sizeof(header) || header.magic != JOURNAL_MAGIC) {
+        // Başlık yoksa günlük boş kabul edilir
+        journal->sequence = 1;
+        return write_header(journal);
+    }
+
+    uint64_t sequence = header.sequence;
+    uint64_t pos = 0;
+    char* buffer = NULL;
+
+    while (pos + sizeof(JournalTxnHeader) <= journal_space(journal)) {
+        JournalTxnHeader txn;
+        if (pread(journal->fd, &txn, sizeof(txn), journal_data_start(journal) + pos) != sizeof(txn)) break;
+        if (txn.magic != JOURNAL_TXN_MAGIC || txn.sequence != sequence || txn.length < sizeof(txn) ||
+            pos + txn.length > journal_space(journal)) break;
+
+        char* grown = realloc(buffer, txn.length);
+        if (!grown) break;
+        buffer = grown;
+        if (pread(journal->fd, buffer, txn.length, journal_data_start(journal) + pos) != (ssize_t) txn.length) break;
+
+        uint32_t checksum = txn.checksum;
+        ((JournalTxnHeader*) buffer)->checksum = 0;
+        if (crc32c(0, buffer, txn.length) != checksum) break;
+
+        if (apply_records(journal, buffer + sizeof(txn), txn.length - sizeof(txn), txn.record_count) < 0) break;
+
+        stats->transactions++;
+        stats->records += txn.record_count;
+        stats->bytes += txn.length;
+        sequence++;
+        pos += ALIGN8(txn.length);
+    }
+    free(buffer);
+
+    // Uygulanan işlemler kalıcı olduktan sonra günlük boşaltılır
+    if (fdatasync(journal->fd) != 0) return -1;
+    journal->sequence = sequence;
+    if (write_header(journal) < 0 || fdatasync(journal->fd) != 0) return -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    stats->elapsed_ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    return 0;
+}
+
+// Açık işleme bir kayıt ekle
+int journal_add(Journal* journal, uint64_t offset, const void* data, uint32_t length) {
+    if (journal->length == 0) journal->length = sizeof(JournalTxnHeader);
+
+    size_t needed = journal->length + sizeof(JournalRecord) + ALIGN8(length);
+    if (needed > journal->capacity) {
+        size_t capacity = journal->capacity ? journal->capacity : 4096;
+        while (capacity < needed) capacity *= 2;
+        char* grown = realloc(journal->buffer, capacity);
+        if (!grown) return -1;
+        journal->buffer = grown;
+        journal->capacity = capacity;
+    }
+
+    JournalRecord record = {offset, length, 0};
+    memcpy(journal->buffer + journal->length, &record, sizeof(record));
+    memcpy(journal->buffer + journal->length + sizeof(record), data, length);
+    memset(journal->buffer + journal->length + sizeof(record) + length, 0, ALIGN8(length) - length);
+    journal->length = needed;
+    journal->record_count++;
+    return 0;
+}
+
+// Açık işlem tek parça olarak günlüğe sığıyor mu
+bool journal_fits(const Journal* journal) { return journal->length <= journal_space(journal); }
+
+// Açık işlemi günlüğe yaz ve tek bir fdatasync ile kalıcı yap (bu çağrıya kadar
+// yapılan veri yazmaları da aynı senkronizasyonla diske iner). Ardından kayıtlar
+// ev konumlarına yazılır; bunların kalıcılığı bir sonraki checkpoint'te sağlanır.
+int journal_commit(Journal* journal) {
+    if (journal->record_count == 0) return 0;
+    if (!journal_fits(journal)) return -1;
+
+    if (journal->head + journal->length > journal_space(journal) && journal_checkpoint(journal) < 0) return -1;
+
+    JournalTxnHeader txn = {JOURNAL_TXN_MAGIC, journal->record_count, journal->sequence, journal->length, 0, 0};
+    memcpy(journal->buffer, &txn, sizeof(txn));
+    ((JournalTxnHeader*) journal->buffer)->checksum = crc32c(0, journal->buffer, journal->length);
+
+    if (pwrite(journal->fd, journal->buffer, journal->length, journal_data_start(journal) + journal->head) !=
+        (ssize_t) journal->length) return -1;
+    if (fdatasync(journal->fd) != 0) return -1;
+
+    if (apply_records(journal, journal->buffer + sizeof(txn), journal->length - sizeof(txn), journal->record_count) < 0) {
+        return -1;
+    }
+
+    journal->head += ALIGN8(journal->length);
+    journal->sequence++;
+    journal_discard(journal);
+    return 0;
+}
+
+// Açık işlemi günlüğe yazmadan doğrudan ev konumlarına uygula ve senkronize et.
+// Formatlama ve dönüştürme gibi tüm metadatayı yeniden yazan işlemler ve günlüğe
+// sığmayan işlemler için. Günlükteki eski işlemler önce checkpoint edilir ve başlık
+// kalıcı hale getirilir; aksi halde çökmeden sonraki yeniden oynatma onları bu
+// yazmaların üzerine uygulayıp yeni metadatayı eskisiyle ezerdi.
+int journal_write_direct(Journal* journal) {
+    if (journal_checkpoint(journal) < 0 || fdatasync(journal->fd) != 0) return -1;
+    if (journal->record_count > 0 &&
+        apply_records(journal, journal->buffer + sizeof(JournalTxnHeader), journal->length - sizeof(JournalTxnHeader),
+                      journal->record_count) < 0) return -1;
+    journal_discard(journal);
+    return fdatasync(journal->fd);
+}
+
+// Ev konumlarına yazılmış işlemleri kalıcı yap ve günlüğü boşalt
+int journal_checkpoint(Journal* journal) {
+    if (journal->head == 0) return 0;
+    if (fdatasync(journal->fd) != 0) return -1;
+    return write_header(journal);
+}
+
+// Açık işlemi at
+void journal_discard(Journal* journal) {
+    journal->length = 0;
+    journal->record_count = 0;
+}
+
+void journal_release(Journal* journal) {
+    free(journal->buffer);
+    journal->buffer = NULL;
+    journal->capacity = 0;
+    journal_discard(journal);
+}
@@ -0,0 +1,70 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// disk.sim içindeki yeniden oynatma (redo) günlüğü.
+// Alanın ilk bloğu günlük başlığıdır, işlemler (transaction) ondan sonra arka arkaya yazılır.
+// Her işlem, ev konumlarına (home) yazılacak metadata parçalarının tam kopyasını taşır.
+#define JOURNAL_MAGIC 0x4C4E524A     // "JRNL"
+#define JOURNAL_TXN_MAGIC 0x4E585453 // "STXN"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t sequence; // Alanın başındaki ilk geçerli işlemin sıra numarası
+} JournalHeader;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t record_count;
+    uint64_t sequence;
+    uint64_t length;   // Başlık dahil işlemin toplam boyutu
+    uint32_t checksum; // checksum alanı 0 iken tüm işlemin CRC32C değeri
+    uint32_t reserved;
+} JournalTxnHeader;
+
+typedef struct {
+    uint64_t offset; // Verinin diskteki ev konumu
+    uint32_t length;
+    uint32_t reserved;
+} JournalRecord;
+
+typedef struct {
+    int fd;
+    off_t offset;        // Günlük alanının disk üzerindeki başlangıcı (başlık bloğu)
+    uint64_t size;       // Günlük alanının toplam boyutu
+    uint32_t block_size;
+    uint64_t disk_size;  // Kayıtların ev konumları bu sınırı aşamaz
+
+    uint64_t sequence;   // Sıradaki işlemin numarası
+    uint64_t head;       // Sıradaki işlemin alan içindeki ofseti (başlık bloğundan sonra)
+
+    // Hazırlanmakta olan işlem: başlık + kayıtlar
+    char* buffer;
+    size_t length;
+    size_t capacity;
+    uint32_t record_count;
+} Journal;
+
+typedef struct {
+    uint64_t transactions;
+    uint64_t records;
+    uint64_t bytes;
+    double elapsed_ms;
+} JournalReplayStats;
+
+void journal_attach(Journal* journal, int fd, off_t offset, uint64_t size, uint32_t block_size, uint64_t disk_size);
+int journal_format(Journal* journal);
+int journal_replay(Journal* journal, JournalReplayStats* stats);
+int journal_add(Journal* journal, uint64_t offset, const void* data, uint32_t length);
+bool journal_fits(const Journal* journal);
+int journal_commit(Journal* journal);
+int journal_write_direct(Journal* journal);
+int journal_checkpoint(Journal* journal);
+void journal_discard(Journal* journal);
+void journal_release(Journal* journal);
+
+#endif
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "oplog.h"
+
+// İşlem günlüğü sorgu aracı. Günlük dosyaları belleğe eşlenir ve kayıtlar tek geçişte
+// süzülür; seçilen kayıtlar yazdırılır, son N tanesi gösterilir ya da işlem türüne göre
+// adet, hata, bayt ve süre yüzdelikleri hesaplanır.
+//
+//   logq [-o ISLEM] [-f DOSYA] [-e] [-n N] [-s] [GUNLUK...]
+
+typedef struct {
+    uint64_t count;
+    uint64_t errors;
+    uint64_t bytes;
+    uint64_t* durations;
+    uint64_t capacity;
+} OpStats;
+
+static void usage() {
+    printf("Kullanim: logq [-o ISLEM] [-f DOSYA] [-e] [-n N] [-s] [GUNLUK...]\n");
+    printf("  -o ISLEM  Yalnizca bu islem (ad ya da kod, or. DOSYA_SILINDI)\n");
+    printf("  -f DOSYA  Yalnizca bu dosyayla ilgili kayitlar\n");
+    printf("  -e        Yalnizca basarisiz islemler\n");
+    printf("  -n N      Eslesen son N kaydi goster\n");
+    printf("  -s        Islem turune gore ozet ve sure yuzdelikleri\n");
+    printf("Gunluk verilmezse disk.log ve dondurulmus eski dosyalari okunur.\n");
+}
+
+// Dizideki k. en küçük değeri bul (quickselect, dizi yeniden düzenlenir)
+static uint64_t select_kth(uint64_t* values, uint64_t count, uint64_t k) {
+    uint64_t left = 0, right = count - 1;
+    while (left < right) {
+        uint64_t pivot = values[left + (right - left) / 2];
+        uint64_t i = left, j = right;
+        while (i <= j) {
+            while (values[i] < pivot) i++;
+            while (values[j] > pivot) j--;
+            if (i <= j) {
+                uint64_t t = values[i];
+                values[i] = values[j];
+                values[j] = t;
+                i++;
+                if (j == 0) break;
+                j--;
+            }
+        }
+        if (k <= j) {
+            right = j;
+        } else if (k >= i) {
+            left = i;
+        } else {
+            break;
+        }
+    }
+    return values[k];
+}
+
+static double percentile_us(uint64_t* values, uint64_t count, double p) {
+    uint64_t k = (uint64_t) (p * (count - 1) + 0.5);
+    return select_kth(values, count, k) / 1000.0;
+}
+
+static bool name_matches(const char* field, const char* name) { return strncmp(field, name, FILENAME_LEN) == 0; }
+
+int main(int argc, char* argv[]) {
+    int op_filter = 0;
+    const char* file_filter = NULL;
+    bool errors_only = false;
+    long tail_count = 0;
+    bool summary = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:f:en:sh")) != -1) {
+        switch (opt) {
+            case 'o':
+                op_filter = log_op_from_name(optarg);
+                if (op_filter < 0) {
+                    fprintf(stderr, "Bilinmeyen islem: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'f':
+                file_filter = optarg;
+                break;
+            case 'e':
+                errors_only = true;
+                break;
+            case 'n':
+                tail_count = atol(optarg);
+                if (tail_count <= 0) {
+                    fprintf(stderr, "Gecersiz kayit sayisi: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 's':
+                summary = true;
+                break;
+            default:
+                usage();
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    // Dosyalar eskiden yeniye okunur; böylece kayıtlar zaman sırasındadır
+    char default_paths[LOG_ROTATE_KEEP + 1][64];
+    int path_count = argc - optind;
+    const char** paths = malloc((path_count > 0 ? path_count : LOG_ROTATE_KEEP + 1) * sizeof(char*));
+    if (path_count > 0) {
+        for (int k = 0; k < path_count; k++) paths[k] = argv[optind + k];
+    } else {
+        log_file_paths(default_paths);
+        path_count = LOG_ROTATE_KEEP + 1;
+        for (int k = 0; k < path_count; k++) paths[k] = default_paths[k];
+    }
+    LogView* views = calloc(path_count, sizeof(LogView));
+    for (int k = 0; k < path_count; k++) {
+        if (log_open_view(paths[k], &views[k]) < 0) fprintf(stderr, "Gecersiz gunluk dosyasi: %s\n", paths[k]);
+    }
+
+    OpStats stats[LOG_OP_COUNT];
+    memset(stats, 0, sizeof(stats));
+    const LogEntry** tail = tail_count > 0 ? malloc(tail_count * sizeof(LogEntry*)) : NULL;
+    uint64_t matched = 0, scanned = 0;
+    bool print_all = !summary && tail_count == 0;
+
+    char line[256];
+    LogTimeCache cache = {.second = -1};
+    struct timespec started, finished;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    for (int k = 0; k < path_count; k++) {
+        const LogEntry* entries = views[k].entries;
+        uint64_t count = views[k].count;
+        scanned += count;
+        for (uint64_t i = 0; i < count; i++) {
+            const LogEntry* entry = &entries[i];
+            if (op_filter && entry->op != op_filter) continue;
+            if (errors_only && entry->result >= 0) continue;
+            if (file_filter && !name_matches(entry->name, file_filter) && !name_matches(entry->other, file_filter)) continue;
+
+            if (tail) tail[matched % tail_count] = entry;
+            matched++;
+            if (print_all) {
+                int n = log_format_entry(entry, &cache, line, sizeof(line));
+                fwrite(line, 1, n, stdout);
+            }
+            if (summary && entry->op < LOG_OP_COUNT) {
+                OpStats* s = &stats[entry->op];
+                if (s->count == s->capacity) {
+                    s->capacity = s->capacity ? s->capacity * 2 : 1024;
+                    s->durations = realloc(s->durations, s->capacity * sizeof(uint64_t));
+                    if (!s->durations) {
+                        fprintf(stderr, "Bellek ayirma hatasi.\n");
+                        return 1;
+                    }
+                }
+                s->durations[s->count++] = entry->duration_ns;
+                s->errors += entry->result < 0;
+                s->bytes += entry->bytes > 0 ? entry->bytes : 0;
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+
+    if (tail) {
+        uint64_t shown = matched < (uint64_t) tail_count ? matched : (uint64_t) tail_count;
+        for (uint64_t i = matched - shown; i < matched; i++) {
+            int n = log_format_entry(tail[i % tail_count], &cache, line, sizeof(line));
+            fwrite(line, 1, n, stdout);
+        }
+    }
+
+    if (summary) {
+        printf("%-32s %10s %8s %14s %10s %10s %10s %10s\n", "ISLEM", "ADET", "HATA", "BAYT", "p50 us", "p90 us", "p99 us",
+               "max us");
+        for (int op = 1; op < LOG_OP_COUNT; op++) {
+            OpStats* s = &stats[op];
+            if (s->count == 0) continue;
+            double p50 = percentile_us(s->durations, s->count, 0.50);
+            double p90 = percentile_us(s->durations, s->count, 0.90);
+            double p99 = percentile_us(s->durations, s->count, 0.99);
+            double max = select_kth(s->durations, s->count, s->count - 1) / 1000.0;
+            printf("%-32s %10llu %8llu %14llu %10.1f %10.1f %10.1f %10.1f\n", log_op_name(op), (unsigned long long) s->count,
+                   (unsigned long long) s->errors, (unsigned long long) s->bytes, p50, p90, p99, max);
+            free(s->durations);
+        }
+    }
+
+    double elapsed_ms = (finished.tv_sec - started.tv_sec) * 1000.0 + (finished.tv_nsec - started.tv_nsec) / 1e6;
+    fprintf(stderr, "%llu kayit tarandi, %llu eslesti, %.3f ms (%.1f milyon kayit/sn)\n", (unsigned long long) scanned,
+            (unsigned long long) matched, elapsed_ms, elapsed_ms > 0 ? scanned / elapsed_ms / 1000.0 : 0.0);
+
+    for (int k = 0; k < path_count; k++) log_close_view(&views[k]);
+    free(views);
+    free(paths);
+    free(tail);
+    return 0;
+}
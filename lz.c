@@ -0,0 +1,122 @@
+#include "lz.h"
+#include <string.h>
+
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5 // Son baytlar her zaman değişmez olarak yazılır
+#define LZ_MAX_OFFSET 65535
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hash32(uint32_t value) { return (value * 2654435761u) >> (32 - LZ_HASH_BITS); }
+
+// 15 ve üzeri uzunlukların devamını 255'lik baytlarla yaz
+static int put_length(uint8_t* output, int position, int capacity, int length) {
+    for (; length >= 255; length -= 255) {
+        if (position >= capacity) return -1;
+        output[position++] = 255;
+    }
+    if (position >= capacity) return -1;
+    output[position++] = (uint8_t) length;
+    return position;
+}
+
+// Bir dizi yaz: değişmez baytlar ve (match_length > 0 ise) eşleşme
+static int put_sequence(uint8_t* output, int position, int capacity, const uint8_t* literals, int literal_length,
+                        int offset, int match_length) {
+    if (position >= capacity) return -1;
+    int token = position++;
+    int match_code = match_length > 0 ? match_length - LZ_MIN_MATCH : 0;
+    output[token] = (uint8_t) ((literal_length < 15 ? literal_length : 15) << 4 | (match_code < 15 ? match_code : 15));
+
+    if (literal_length >= 15 && (position = put_length(output, position, capacity, literal_length - 15)) < 0) return -1;
+    if (literal_length > capacity - position) return -1;
+    memcpy(output + position, literals, literal_length);
+    position += literal_length;
+    if (match_length == 0) return position;
+
+    if (capacity - position < 2) return -1;
+    output[position++] = (uint8_t) offset;
+    output[position++] = (uint8_t) (offset >> 8);
+    if (match_code >= 15) position = put_length(output, position, capacity, match_code - 15);
+    return position;
+}
+
+int lz_compress(const uint8_t* input, int size, uint8_t* output, int capacity) {
+    int table[1 << LZ_HASH_BITS];
+    for (int i = 0; i < (1 << LZ_HASH_BITS); i++) table[i] = -1;
+
+    int position = 0;
+    int anchor = 0;
+    int limit = size - LZ_LAST_LITERALS - LZ_MIN_MATCH;
+    int misses = 0;
+
+    for (int cursor = 0; cursor <= limit;) {
+        uint32_t h = hash32(read32(input + cursor));
+        int candidate = table[h];
+        table[h] = cursor;
+
+        if (candidate < 0 || cursor - candidate > LZ_MAX_OFFSET || read32(input + candidate) != read32(input + cursor)) {
+            // Eşleşme bulunamadıkça adım büyür; sıkıştırılamayan veride zaman kaybedilmez
+            cursor += 1 + (misses++ >> 6);
+            continue;
+        }
+        misses = 0;
+
+        int length = LZ_MIN_MATCH;
+        while (cursor + length < size - LZ_LAST_LITERALS && input[candidate + length] == input[cursor + length]) length++;
+
+        position = put_sequence(output, position, capacity, input + anchor, cursor - anchor, cursor - candidate, length);
+        if (position < 0) return -1;
+        cursor += length;
+        anchor = cursor;
+    }
+
+    position = put_sequence(output, position, capacity, input + anchor, size - anchor, 0, 0);
+    return position < 0 || position >= size ? -1 : position;
+}
+
+// Uzunluğun 255'lik devam baytlarını oku
+static int get_length(const uint8_t* input, int size, int* position, int length) {
+    uint8_t byte;
+    do {
+        if (*position >= size) return -1;
+        byte = input[(*position)++];
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+int lz_decompress(const uint8_t* input, int size, uint8_t* output, int capacity) {
+    int in = 0;
+    int out = 0;
+
+    while (in < size) {
+        int token = input[in++];
+        int literal_length = token >> 4;
+        if (literal_length == 15 && (literal_length = get_length(input, size, &in, literal_length)) < 0) return -1;
+        if (literal_length > size - in || literal_length > capacity - out) return -1;
+        memcpy(output + out, input + in, literal_length);
+        in += literal_length;
+        out += literal_length;
+        if (in == size) break; // Son dizi
+
+        if (size - in < 2) return -1;
+        int offset = input[in] | input[in + 1] << 8;
+        in += 2;
+        int match_length = token & 15;
+        if (match_length == 15 && (match_length = get_length(input, size, &in, match_length)) < 0) return -1;
+        match_length += LZ_MIN_MATCH;
+        if (offset == 0 || offset > out || match_length > capacity - out) return -1;
+
+        // Kaynak ve hedef çakışabilir (tekrar eden desenler), bu yüzden bayt bayt kopyalanır
+        const uint8_t* from = output + out - offset;
+        for (int i = 0; i < match_length; i++) output[out + i] = from[i];
+        out += match_length;
+    }
+    return out == capacity ? out : -1;
+}
@@ -0,0 +1,16 @@
+#ifndef LZ_H
+#define LZ_H
+
+#include <stdint.h>
+
+// LZ77 ailesinden basit bir blok sıkıştırıcı (LZ4 blok biçimine benzer).
+// Her dizi bir belirteç baytı, değişmez (literal) baytlar, 2 baytlık geri uzaklık
+// ve eşleşme uzunluğundan oluşur; son dizi yalnızca değişmez bayt taşır.
+
+// Sıkıştırılmış veri 'capacity'ye sığmazsa -1 döner (veri sıkıştırılamıyor)
+int lz_compress(const uint8_t* input, int size, uint8_t* output, int capacity);
+
+// Çözülen veri tam olarak 'size' bayt olmalı; bozuk girdi için -1 döner
+int lz_decompress(const uint8_t* input, int size, uint8_t* output, int capacity);
+
+#endif
@@ -1,20 +1,28 @@
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <termios.h> // Terminal ayarları için
 #include <unistd.h>
+#include "batch.h"
 #include "fs.h"
+#include "oplog.h"
 
+#define INPUT_DATA_SIZE 512 // Menüden tek seferde yazılabilecek en fazla veri
+
+void configure_from_environment();
+int run_batch(int argc, char* argv[]);
 void display_menu();
 int get_user_choice(char input[], int input_size);
 bool get_filename(const char* prompt, char* filename);
+bool get_host_path(const char* prompt, char* path, int path_size);
 int wait_for_user_input();
 void create_file(char* filename);
 void delete_file(char* filename);
 void write_to_file(char* filename, char* data);
 void read_file(char* filename, char* input);
 void read_file_partial(const char* filename, int file_size, char* input);
-void list_files();
+void list_files(char* path);
 void format_disk();
 void rename_file(char* filename, char* filename2);
 void show_file_size(char* filename);
@@ -24,17 +32,25 @@ void copy_file(char* filename, char* filename2);
 void move_file(char* filename, char* filename2);
 void compare_files(char* filename, char* filename2);
 void defragment_disk();
-void backup_disk(char* filename);
+void backup_disk(char* filename, char* input);
 void restore_disk(char* filename);
+void import_host_file(char* filename);
+void export_to_host(char* filename);
+void make_directory(char* filename);
+void remove_directory(char* filename);
 void clear_input_buffer();
 
-int main() {
+int main(int argc, char* argv[]) {
     int choice;
     char input[4];
     bool is_first_run = 1; // İlk çalışma olup olmadığını kontrol etmek için boolean
-    char filename[FILENAME_LEN];
-    char filename2[FILENAME_LEN];
-    char data[BLOCK_SIZE]; // Veri yazmak için kullanılacak buffer
+    char filename[FS_PATH_LEN]; // Dosya adları dizinleriyle birlikte yol olarak girilir ("a/b/dosya")
+    char filename2[FS_PATH_LEN];
+    char data[INPUT_DATA_SIZE]; // Veri yazmak için kullanılacak buffer
+
+    configure_from_environment();
+    // Argüman verilirse menü yerine betik kipi çalışır
+    if (argc > 1) return run_batch(argc, argv);
 
     do {
         if (!is_first_run) { // Eğer ilk çalışma değilse
@@ -43,12 +59,18 @@ int main() {
             printf("\n");
         } else if (fs_init() == false || log_init() == false) {
             return -1;
+        } else if (getenv("SIMPLEFS_DEFRAG") != NULL) {
+            // SIMPLEFS_DEFRAG tanımlıysa disk arka planda adım adım birleştirilir
+            fs_defragment_start(DEFAULT_DEFRAG_STEP_BLOCKS, DEFAULT_DEFRAG_INTERVAL_MS);
         }
 
         display_menu();
         
         choice = get_user_choice(input,sizeof(input));
-        if (choice == -1) return 0;
+        if (choice == -1) {
+            fs_close();
+            return 0;
+        }
         if (choice == 0) {
             is_first_run = 0;
             continue;
@@ -69,7 +91,7 @@ int main() {
                 read_file(filename, input);
                 break;
             case 5:
-                list_files();
+                list_files(filename);
                 break;
             case 6:
                 format_disk();
@@ -99,7 +121,7 @@ int main() {
                 defragment_disk();
                 break;
             case 15:
-                backup_disk(filename);
+                backup_disk(filename, input);
                 break;
             case 16:
                 restore_disk(filename);
@@ -108,18 +130,80 @@ int main() {
                 fs_log();
                 break;
             case 18:
+                import_host_file(filename);
+                break;
+            case 19:
+                export_to_host(filename);
+                break;
+            case 20:
+                make_directory(filename);
+                break;
+            case 21:
+                remove_directory(filename);
+                break;
+            case 22:
                 printf("Cikis yapiliyor...\n");
-                log_operation("CIKIS_YAPILDI", NULL);
+                log_operation(LOG_OP_EXIT, NULL, NULL, 0, log_clock(), 0);
                 break;
             default:
-                printf("Gecersiz secim. Lutfen (1-18) arasi bir secim yapin.\n");
+                printf("Gecersiz secim. Lutfen (1-22) arasi bir secim yapin.\n");
                 break;
         }
         is_first_run = 0;
-    } while (choice != 18);
+    } while (choice != 22);
+    fs_close();
     return 0;
 }
 
+void configure_from_environment() {
+    // SIMPLEFS_MMAP ortam değişkeni tanımlıysa disk belleğe eşlenerek kullanılır
+    if (getenv("SIMPLEFS_MMAP") != NULL) fs_set_io_mode(FS_IO_MMAP);
+    // SIMPLEFS_REFLINK tanımlıysa kopyalar blokları paylaşır (copy-on-write)
+    if (getenv("SIMPLEFS_REFLINK") != NULL) fs_set_copy_mode(FS_COPY_REFLINK);
+    // SIMPLEFS_VERIFY tanımlıysa okunan bloklar sağlama toplamlarıyla doğrulanır
+    if (getenv("SIMPLEFS_VERIFY") != NULL) fs_set_verify_reads(true);
+    // SIMPLEFS_LOG_FLUSH işlem günlüğünün yazma politikasını seçer: "op", "interval" ya da "exit"
+    const char* log_flush = getenv("SIMPLEFS_LOG_FLUSH");
+    if (log_flush != NULL) {
+        if (strcmp(log_flush, "op") == 0) log_set_flush_policy(LOG_FLUSH_PER_OP, 0);
+        else if (strcmp(log_flush, "exit") == 0) log_set_flush_policy(LOG_FLUSH_ON_EXIT, 0);
+        else log_set_flush_policy(LOG_FLUSH_INTERVAL, 0);
+    }
+}
+
+// Betik kipi: "-" stdin'den, "-f DOSYA" betik dosyasından, "-c METIN" metinden, aksi halde
+// argümanlardan komut okunur. Menü, ekran temizleme ve tuş beklemesi yoktur.
+int run_batch(int argc, char* argv[]) {
+    FILE* script = NULL;
+    if (strcmp(argv[1], "-f") == 0 || strcmp(argv[1], "-c") == 0) {
+        if (argc != 3) {
+            fprintf(stderr, "Kullanim: simplefs [-f BETIK | -c KOMUTLAR | - | KOMUT...]\n");
+            return 1;
+        }
+        if (argv[1][1] == 'f' && (script = fopen(argv[2], "r")) == NULL) {
+            fprintf(stderr, "Betik dosyasi acilamadi: %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    if (fs_init() == false || log_init() == false) return 1;
+    if (getenv("SIMPLEFS_DEFRAG") != NULL) fs_defragment_start(DEFAULT_DEFRAG_STEP_BLOCKS, DEFAULT_DEFRAG_INTERVAL_MS);
+
+    int status;
+    if (script != NULL) {
+        status = batch_run_stream(script, argv[2]);
+        fclose(script);
+    } else if (strcmp(argv[1], "-c") == 0) {
+        status = batch_run_text(argv[2], "-c");
+    } else if (strcmp(argv[1], "-") == 0) {
+        status = batch_run_stream(stdin, "stdin");
+    } else {
+        status = batch_run_args(argc - 1, argv + 1);
+    }
+    fs_close();
+    return status;
+}
+
 void display_menu() {
     system("clear");
     printf("             Dosya Sistemi Menusu\n");
@@ -141,9 +225,13 @@ void display_menu() {
     printf("15. Diski yedekle\n");
     printf("16. Varolan disk yedegini geri yukle\n");
     printf("17. Loglari Goruntule\n");
-    printf("18. Cikis\n");
+    printf("18. Host dosyasini ice aktar\n");
+    printf("19. Dosyayi host dosyasina aktar\n");
+    printf("20. Dizin olustur\n");
+    printf("21. Dizin sil\n");
+    printf("22. Cikis\n");
     puts("==============================================");
-    printf("Seciminizi girin(1-18): ");
+    printf("Seciminizi girin(1-22): ");
 }
 
 int get_user_choice(char input[], int input_size) {
@@ -188,7 +276,7 @@ int get_user_choice(char input[], int input_size) {
 bool get_filename(const char* prompt, char* filename) {
     printf("%s", prompt);
 
-    if (fgets(filename, FILENAME_LEN, stdin) == NULL) {
+    if (fgets(filename, FS_PATH_LEN, stdin) == NULL) {
         printf("Dosya adi okunamadi!\n");
         return 0;
     }
@@ -204,6 +292,23 @@ bool get_filename(const char* prompt, char* filename) {
     return 1;
 }
 
+// Host dosya yolunu al (dosya adından uzun olabilir)
+bool get_host_path(const char* prompt, char* path, int path_size) {
+    printf("%s", prompt);
+    if (fgets(path, path_size, stdin) == NULL) {
+        printf("Dosya yolu okunamadi!\n");
+        return 0;
+    }
+
+    size_t len = strlen(path);
+    if (len > 0 && path[len - 1] == '\n') path[len - 1] = '\0';
+    if (strlen(path) == 0) {
+        printf("Gecersiz dosya yolu! Yol bos olamaz.\n");
+        return 0;
+    }
+    return 1;
+}
+
 // Enter'a basmadan tek karakter okumak için fonksiyon
 int wait_for_user_input() {
     struct termios old_terminal;
@@ -222,12 +327,13 @@ int wait_for_user_input() {
 
 void create_file(char* filename) {
     printf("Dosya olusturma secildi.\n");
-    fs_ls(false);
 
     if (!get_filename("Dosya adini girin: ", filename)) return;
 
-    if (fs_create(filename) >= 0) {
-        log_operation("DOSYA_OLUSTURULDU", filename);
+    uint64_t started = log_clock();
+    int result = fs_create(filename);
+    log_operation(LOG_OP_CREATE, filename, NULL, 0, started, result);
+    if (result >= 0) {
         printf("\"%s\" dosyasi basariyla olusturuldu.\n", filename);
     } else {
         printf("\"%s\" dosyasi olusturulamadi!\n", filename);
@@ -236,11 +342,12 @@ void create_file(char* filename) {
 
 void delete_file(char* filename) {
     printf("Dosya silme secildi.\n");
-    fs_ls(false);
 
     if (!get_filename("Silinecek dosya adini girin: ", filename)) return;
-    if (fs_delete(filename) >= 0) {
-        log_operation("DOSYA_SILINDI", filename);
+    uint64_t started = log_clock();
+    int result = fs_delete(filename);
+    log_operation(LOG_OP_DELETE, filename, NULL, 0, started, result);
+    if (result >= 0) {
         printf("\"%s\" dosyasi basariyla silindi.\n", filename);
     } else {
         printf("\"%s\" dosyasi silinemedi!\n", filename);
@@ -249,20 +356,21 @@ void delete_file(char* filename) {
 
 void write_to_file(char* filename, char* data) {
     printf("Dosyaya veri yazma secildi.\n");
-    fs_ls(false);
 
     if (!get_filename("Veri yazilacak dosya adini girin: ", filename)) return;
 
     printf("Yazilacak veriyi girin: ");
-    if (fgets(data, BLOCK_SIZE, stdin) == NULL) {
+    if (fgets(data, INPUT_DATA_SIZE, stdin) == NULL) {
         printf("Veri okunamadi!\n");
         return;
     }
     size_t data_len = strlen(data);
     if (data_len > 0 && data[data_len - 1] == '\n') data[data_len - 1] = '\0';
 
-    if (fs_write(filename, data, (int)strlen(data)) >= 0) {
-        log_operation("DOSYAYA_VERI_YAZILDI", filename);
+    uint64_t started = log_clock();
+    int result = fs_write(filename, data, (int)strlen(data));
+    log_operation(LOG_OP_WRITE, filename, NULL, strlen(data), started, result);
+    if (result >= 0) {
         printf("\"%s\" dosyasina veri basariyla yazildi.\n", filename);
     } else {
         printf("\"%s\" dosyasina veri yazilamadi!\n", filename);
@@ -271,7 +379,6 @@ void write_to_file(char* filename, char* data) {
 
 void read_file(char* filename, char* input) {
     printf("Dosyadan veri okuma secildi.\n");
-    fs_ls(false);
 
     if (!get_filename("Okunacak dosya adini girin: ", filename)) return;
 
@@ -295,9 +402,10 @@ void read_file(char* filename, char* input) {
 
     if (read_choice == 1) {
         // Tüm dosyayı oku
-        if (fs_cat(filename) >= 0) {
-            log_operation("DOSYADAN_VERI_OKUNDU", filename);
-        } else {
+        uint64_t started = log_clock();
+        int result = fs_cat(filename);
+        log_operation(LOG_OP_READ, filename, NULL, file_size, started, result);
+        if (result < 0) {
             printf("\"%s\" dosyasindan veri okunamadi!\n", filename);
         }
     } else if (read_choice == 2) {
@@ -308,7 +416,6 @@ void read_file(char* filename, char* input) {
 }
 
 void read_file_partial(const char* filename, int file_size, char* input) {
-    char buffer[BLOCK_SIZE] = {0};
     printf("Okuma baslangic pozisyonu (0-%d): ", file_size - 1);
     if (fgets(input, 4, stdin) == NULL) {
         printf("Pozisyon okunamadi!\n");
@@ -329,29 +436,65 @@ void read_file_partial(const char* filename, int file_size, char* input) {
         return;
     }
 
-    if (fs_read(filename, offset, read_size, buffer) >= 0) {
-        log_operation("DOSYADAN_VERI_OKUNDU", filename);
-        printf("\"%s\" dosyasindan okunan veri (%d byte):\n", filename, read_size);
-        printf("-------------------------------------------\n");
-        for (int i = 0; i < read_size; i++) {
-            putchar(buffer[i]);
-        }
+    printf("\"%s\" dosyasindan okunan veri (%d byte):\n", filename, read_size);
+    printf("-------------------------------------------\n");
+    fflush(stdout);
+
+    // Veri ara tampon kullanılmadan doğrudan ekrana aktarılır
+    uint64_t started = log_clock();
+    int result = fs_read_to_fd(filename, offset, read_size, STDOUT_FILENO);
+    log_operation(LOG_OP_READ, filename, NULL, read_size, started, result);
+    if (result >= 0) {
         printf("\n-------------------------------------------\n");
     } else {
         printf("\"%s\" dosyasindan veri okunamadi!\n", filename);
     }
 }
 
-void list_files() {
+void list_files(char* path) {
     printf("Dosyaları listeleme secildi.\n");
-    log_operation("DOSYALAR_LISTELENDI", NULL);
-    fs_ls(true);
+
+    // Yol boş bırakılırsa kök dizin listelenir
+    printf("Dizin yolu (kok dizin icin bos birakin): ");
+    if (fgets(path, FS_PATH_LEN, stdin) == NULL) return;
+    size_t len = strlen(path);
+    if (len > 0 && path[len - 1] == '\n') path[len - 1] = '\0';
+    if (strlen(path) == 0) strcpy(path, "/");
+
+    // Önek boş bırakılırsa dizindeki tüm girdiler listelenir
+    char prefix[FS_PATH_LEN];
+    printf("Ad oneki (tum dosyalar icin bos birakin): ");
+    if (fgets(prefix, sizeof(prefix), stdin) == NULL) return;
+    len = strlen(prefix);
+    if (len > 0 && prefix[len - 1] == '\n') prefix[len - 1] = '\0';
+
+    uint64_t started = log_clock();
+    int result = fs_ls_dir(path, prefix);
+    log_operation(LOG_OP_LIST, path, NULL, 0, started, result);
 }
 
 void format_disk() {
+    char input[16];
     printf("Diske format atma secildi.\n");
-    if (fs_format() >= 0) {
-        log_operation("DISK_FORMATLANDI", NULL);
+
+    // Kapasite boş bırakılırsa mevcut dosya tablosu kapasitesi korunur
+    printf("Dosya tablosu kapasitesi (mevcut kapasite icin bos birakin): ");
+    int max_files = 0;
+    if (fgets(input, sizeof(input), stdin) != NULL) max_files = atoi(input);
+
+    // Geometri boş bırakılırsa mevcut disk boyutu ve blok boyutu korunur
+    printf("Disk boyutu MB olarak (mevcut boyut %llu MB, korumak icin bos birakin): ",
+           (unsigned long long) (fs_disk_size() / (1024 * 1024)));
+    uint64_t disk_size = 0;
+    if (fgets(input, sizeof(input), stdin) != NULL) disk_size = strtoull(input, NULL, 10) * 1024 * 1024;
+    printf("Blok boyutu (mevcut %d bytes, korumak icin bos birakin): ", fs_block_size());
+    int block_size = 0;
+    if (fgets(input, sizeof(input), stdin) != NULL) block_size = atoi(input);
+
+    uint64_t started = log_clock();
+    int result = fs_format_geometry(max_files, disk_size, block_size);
+    log_operation(LOG_OP_FORMAT, NULL, NULL, 0, started, result);
+    if (result >= 0) {
         printf("Disk basariyla formatlandi.\n");
     } else {
         printf("Disk formatlama basarisiz oldu!\n");
@@ -360,12 +503,13 @@ void format_disk() {
 
 void rename_file(char* filename, char* filename2) {
     printf("Dosya ismini degistirme secildi.\n");
-    fs_ls(false);
 
     if (!get_filename("Eski dosya adini girin: ", filename)) return;
     if (!get_filename("Yeni dosya adini girin: ", filename2)) return;
-    if (fs_rename(filename, filename2) >= 0) {
-        log_operation("DOSYA_ISMI_DEGISTIRILDI", filename);
+    uint64_t started = log_clock();
+    int result = fs_rename(filename, filename2);
+    log_operation(LOG_OP_RENAME, filename, filename2, 0, started, result);
+    if (result >= 0) {
         printf("\"%s\" dosyasinin ismi \"%s\" olarak basariyla degistirildi.\n", filename, filename2);
     } else {
         printf("\"%s\" dosyasinin ismi degistirilemedi!\n", filename);
@@ -374,12 +518,12 @@ void rename_file(char* filename, char* filename2) {
 
 void show_file_size(char* filename) {
     printf("Dosya boyutunu gosterme secildi.\n");
-    fs_ls(false);
 
     if (!get_filename("Boyutunu gormek istediginiz dosya adini girin: ", filename)) return;
+    uint64_t started = log_clock();
     int size = fs_size(filename);
+    log_operation(LOG_OP_SIZE, filename, NULL, size > 0 ? size : 0, started, size);
     if (size >= 0) {
-        log_operation("DOSYA_BOYUTU_GOSTERILDI", filename);
         printf("\"%s\" dosyasinin boyutu: %d byte\n", filename, size);
     } else {
         printf("\"%s\" dosyasi bulunamadi!\n", filename);
@@ -388,12 +532,11 @@ void show_file_size(char* filename) {
 
 void append_to_file(char* filename, char* data) {
     printf("Dosya sonuna veri ekleme secildi.\n");
-    fs_ls(false);
 
     if (!get_filename("Veri eklenecek dosya adini girin: ", filename)) return;
 
     printf("Eklenecek veriyi girin: ");
-    if (fgets(data, BLOCK_SIZE, stdin) == NULL) {
+    if (fgets(data, INPUT_DATA_SIZE, stdin) == NULL) {
         printf("Veri okunamadi!\n");
         return;
     }
@@ -401,8 +544,10 @@ void append_to_file(char* filename, char* data) {
     size_t data_len = strlen(data);
     if (data_len > 0 && data[data_len - 1] == '\n') data[data_len - 1] = '\0';
 
-    if (fs_append(filename, data, (int)strlen(data)) >= 0) {
-        log_operation("DOSYAYA_VERI_EKLENDI", filename);
+    uint64_t started = log_clock();
+    int result = fs_append(filename, data, (int)strlen(data));
+    log_operation(LOG_OP_APPEND, filename, NULL, strlen(data), started, result);
+    if (result >= 0) {
         printf("\"%s\" dosyasina veri basariyla eklendi.\n", filename);
     } else {
         printf("\"%s\" dosyasina veri eklenemedi!\n", filename);
@@ -411,7 +556,6 @@ void append_to_file(char* filename, char* data) {
 
 void truncate_file(char* filename, char* input) {
     printf("Dosya kirpma secildi\n");
-    fs_ls(false);
 
     if (!get_filename("Kirpma yapilacak dosya adini girin: ", filename)) return;
     printf("Yeni boyutu girin: ");
@@ -420,8 +564,10 @@ void truncate_file(char* filename, char* input) {
         return;
     }
     int new_size = atoi(input);
-    if (fs_truncate(filename, new_size) >= 0) {
-        log_operation("DOSYA_KIRPILDI", filename);
+    uint64_t started = log_clock();
+    int result = fs_truncate(filename, new_size);
+    log_operation(LOG_OP_TRUNCATE, filename, NULL, new_size, started, result);
+    if (result >= 0) {
         printf("\"%s\" dosyasi basariyla %d byte'a kirpildi.\n", filename, new_size);
     } else {
         printf("\"%s\" dosyasi kirpilamadi!\n", filename);
@@ -430,12 +576,13 @@ void truncate_file(char* filename, char* input) {
 
 void copy_file(char* filename, char* filename2) {
     printf("Dosya kopyalama secildi.\n");
-    fs_ls(false);
 
     if (!get_filename("Kopyalanacak dosya adini girin: ", filename)) return;
     if (!get_filename("Yeni dosya adini girin: ", filename2)) return;
-    if (fs_copy(filename, filename2) >= 0) {
-        log_operation("DOSYA_KOPYALANDI", filename);
+    uint64_t started = log_clock();
+    int result = fs_copy(filename, filename2);
+    log_operation(LOG_OP_COPY, filename, filename2, 0, started, result);
+    if (result >= 0) {
         printf("\"%s\" dosyasi \"%s\" olarak basariyla kopyalandi.\n", filename, filename2);
     } else {
         printf("\"%s\" dosyasi kopyalanamadi!\n", filename);
@@ -448,8 +595,10 @@ void move_file(char* filename, char* filename2) {
     if (!get_filename("Tasinacak dosya adini girin: ", filename)) return;
     if (!get_filename("Hedef dosya adini girin: ", filename2)) return;
 
-    if (fs_mv(filename, filename2) >= 0) {
-        log_operation("DOSYA_TASINDI", filename);
+    uint64_t started = log_clock();
+    int result = fs_mv(filename, filename2);
+    log_operation(LOG_OP_MOVE, filename, filename2, 0, started, result);
+    if (result >= 0) {
         printf("\"%s\" dosyasi \"%s\" olarak basariyla tasindi.\n", filename, filename2);
     } else {
         printf("\"%s\" dosyasi tasinamadi!\n", filename);
@@ -458,48 +607,143 @@ void move_file(char* filename, char* filename2) {
 
 void compare_files(char* filename, char* filename2) {
     printf("Dosya karsilastirma secildi.\n");
-    fs_ls(false);
 
     if (!get_filename("Birinci dosya adini girin: ", filename)) return;
     if (!get_filename("Ikinci dosya adini girin: ", filename2)) return;
 
-    int result = fs_diff(filename, filename2);
-    if (result >= 0) {
-        char details[FILENAME_LEN * 2 + 5];
-        snprintf(details, sizeof(details), "%s ve %s", filename, filename2);
-        log_operation("DOSYALAR_KARSILASTIRILDI", details);
-    } else {
+    char input[4];
+    printf("Karsilastirma secenegi:\n");
+    printf("1. Ilk farkta dur\n");
+    printf("2. Farkli bloklarin ozetini goster\n");
+    printf("Seciminiz (1-2): ");
+    if (fgets(input, sizeof(input), stdin) == NULL) {
+        printf("Secim okunamadi!\n");
+        return;
+    }
+
+    uint64_t started = log_clock();
+    int result = fs_diff_ex(filename, filename2, atoi(input) == 2, NULL);
+    log_operation(LOG_OP_DIFF, filename, filename2, 0, started, result);
+    if (result < 0) {
         printf("Dosya karsilastirma islemi basarisiz oldu!\n");
     }
 }
 
 void defragment_disk() {
     printf("Disk uzerindeki bos alanlari birlestirme secildi.\n");
-    if (!(fs_defragment() >= 0)) {
+    uint64_t started = log_clock();
+    int result = fs_defragment();
+    log_operation(LOG_OP_DEFRAG, NULL, NULL, 0, started, result);
+    if (!(result >= 0)) {
         printf("Disk uzerindeki bos alanlar birlestirilemedi!\n");
-    } else {
-        log_operation("DISK_BIRLESTIRILDI", NULL);
     }
 }
 
-void backup_disk(char* filename) {
+void backup_disk(char* filename, char* input) {
     printf("Disk yedekleme secildi.\n");
     if (!get_filename("Yedek dosya adini girin: ", filename)) return;
 
-    if (!(fs_backup(filename) >= 0)) {
-        printf("Disk yedeklenemedi!\n");
+    printf("Yedekleme secenegi:\n");
+    printf("1. Tam yedek\n");
+    printf("2. Artimli yedek (son yedekten sonra degisen bloklar)\n");
+    printf("Seciminiz (1-2): ");
+
+    if (fgets(input, 4, stdin) == NULL) {
+        printf("Secim okunamadi!\n");
+        return;
+    }
+
+    int backup_choice = atoi(input);
+    uint64_t started = log_clock();
+    int result;
+    if (backup_choice == 1) {
+        result = fs_backup(filename);
+    } else if (backup_choice == 2) {
+        result = fs_backup_incremental(filename);
     } else {
-        log_operation("DISK_YEDEKLENDI", NULL);
+        printf("Gecersiz secim!\n");
+        return;
+    }
+
+    log_operation(backup_choice == 2 ? LOG_OP_BACKUP_INCREMENTAL : LOG_OP_BACKUP, filename, NULL, 0, started, result);
+    if (!(result >= 0)) {
+        printf("Disk yedeklenemedi!\n");
     }
 }
 
 void restore_disk(char* filename) {
     printf("Disk yedegini geri yukleme secildi.\n");
     if (!get_filename("Geri yuklenecek yedek dosya adini girin: ", filename)) return;
-    if (!(fs_restore(filename) >= 0)) {
+    uint64_t started = log_clock();
+    int result = fs_restore(filename);
+    log_operation(LOG_OP_RESTORE, filename, NULL, 0, started, result);
+    if (!(result >= 0)) {
         printf("Disk geri yuklenemedi!\n");
+    }
+}
+
+// Host dosya sisteminden bir dosyayı (ikili veri dahil, boyut sınırı olmadan) diske aktar
+void import_host_file(char* filename) {
+    char host_path[PATH_MAX];
+    printf("Host dosyasini ice aktarma secildi.\n");
+    if (!get_host_path("Host dosyasinin yolunu girin: ", host_path, sizeof(host_path))) return;
+    if (!get_filename("Hedef dosya adini girin: ", filename)) return;
+
+    uint64_t started = log_clock();
+    int result = fs_import(host_path, filename);
+    log_operation(LOG_OP_IMPORT, filename, host_path, result > 0 ? result : 0, started, result);
+    if (result >= 0) {
+        printf("\"%s\" dosyasi \"%s\" olarak ice aktarildi (%d byte).\n", host_path, filename, result);
+    } else {
+        printf("\"%s\" dosyasi ice aktarilamadi!\n", host_path);
+    }
+}
+
+void export_to_host(char* filename) {
+    char host_path[PATH_MAX];
+    printf("Dosyayi host dosyasina aktarma secildi.\n");
+
+    if (!get_filename("Aktarilacak dosya adini girin: ", filename)) return;
+    if (!get_host_path("Host dosyasinin yolunu girin: ", host_path, sizeof(host_path))) return;
+
+    uint64_t started = log_clock();
+    int result = fs_export(filename, host_path);
+    log_operation(LOG_OP_EXPORT, filename, host_path, result > 0 ? result : 0, started, result);
+    if (result >= 0) {
+        printf("\"%s\" dosyasi \"%s\" olarak disari aktarildi (%d byte).\n", filename, host_path, result);
+    } else {
+        printf("\"%s\" dosyasi disari aktarilamadi!\n", filename);
+    }
+}
+
+void make_directory(char* filename) {
+    printf("Dizin olusturma secildi.\n");
+
+    if (!get_filename("Dizin yolunu girin: ", filename)) return;
+
+    uint64_t started = log_clock();
+    int result = fs_mkdir(filename);
+    log_operation(LOG_OP_MKDIR, filename, NULL, 0, started, result);
+    if (result >= 0) {
+        printf("\"%s\" dizini basariyla olusturuldu.\n", filename);
+    } else {
+        printf("\"%s\" dizini olusturulamadi!\n", filename);
+    }
+}
+
+// Yalnızca boş dizinler silinebilir
+void remove_directory(char* filename) {
+    printf("Dizin silme secildi.\n");
+
+    if (!get_filename("Silinecek dizinin yolunu girin: ", filename)) return;
+
+    uint64_t started = log_clock();
+    int result = fs_rmdir(filename);
+    log_operation(LOG_OP_RMDIR, filename, NULL, 0, started, result);
+    if (result >= 0) {
+        printf("\"%s\" dizini basariyla silindi.\n", filename);
     } else {
-        log_operation("DISK_GERI_YUKLENDI", NULL);
+        printf("\"%s\" dizini silinemedi!\n", filename);
     }
 }
 
@@ -0,0 +1,98 @@
+#include "memdiff.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+static pthread_once_t impl_once = PTHREAD_ONCE_INIT;
+static size_t (*memdiff_run)(const unsigned char* a, const unsigned char* b, size_t length);
+
+// 8 baytlık kelimelerle karşılaştır; farklı kelimede ilk farklı bayt XOR'un en düşük
+// anlamlı bitinden bulunur (küçük sonlu sıralama)
+static size_t memdiff_word(const unsigned char* a, const unsigned char* b, size_t length) {
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + i, sizeof(y));
+        if (x != y) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            return i + __builtin_ctzll(x ^ y) / 8;
+#else
+            return i + __builtin_clzll(x ^ y) / 8;
+#endif
+        }
+    }
+    for (; i < length; i++) {
+        if (a[i] != b[i]) return i;
+    }
+    return length;
+}
+
+#if defined(__x86_64__)
+// SSE2 x86-64'te her zaman vardır: 64 baytlık adımlarda dört karşılaştırmanın maskesi
+// birlikte sınanır, fark bulunduğunda 16 baytlık bloklarda konumu aranır
+static size_t memdiff_sse2(const unsigned char* a, const unsigned char* b, size_t length) {
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        __m128i e0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (a + i)), _mm_loadu_si128((const __m128i*) (b + i)));
+        __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (a + i + 16)), _mm_loadu_si128((const __m128i*) (b + i + 16)));
+        __m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (a + i + 32)), _mm_loadu_si128((const __m128i*) (b + i + 32)));
+        __m128i e3 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (a + i + 48)), _mm_loadu_si128((const __m128i*) (b + i + 48)));
+        __m128i all = _mm_and_si128(_mm_and_si128(e0, e1), _mm_and_si128(e2, e3));
+        if (_mm_movemask_epi8(all) != 0xFFFF) break;
+    }
+    for (; i + 16 <= length; i += 16) {
+        __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (a + i)), _mm_loadu_si128((const __m128i*) (b + i)));
+        unsigned mask = ~(unsigned) _mm_movemask_epi8(equal) & 0xFFFF;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + memdiff_word(a + i, b + i, length - i);
+}
+
+// AVX2: 128 baytlık adımlar, fark bulunduğunda 32 baytlık bloklarda konum aranır
+__attribute__((target("avx2"))) static size_t memdiff_avx2(const unsigned char* a, const unsigned char* b, size_t length) {
+    size_t i = 0;
+    for (; i + 128 <= length; i += 128) {
+        __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (a + i)), _mm256_loadu_si256((const __m256i*) (b + i)));
+        __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (a + i + 32)), _mm256_loadu_si256((const __m256i*) (b + i + 32)));
+        __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (a + i + 64)), _mm256_loadu_si256((const __m256i*) (b + i + 64)));
+        __m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (a + i + 96)), _mm256_loadu_si256((const __m256i*) (b + i + 96)));
+        __m256i all = _mm256_and_si256(_mm256_and_si256(e0, e1), _mm256_and_si256(e2, e3));
+        if ((unsigned) _mm256_movemask_epi8(all) != 0xFFFFFFFFu) break;
+    }
+    for (; i + 32 <= length; i += 32) {
+        __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (a + i)), _mm256_loadu_si256((const __m256i*) (b + i)));
+        unsigned mask = ~(unsigned) _mm256_movemask_epi8(equal);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + memdiff_sse2(a + i, b + i, length - i);
+}
+#endif
+
+// İşlemcinin desteklediği en geniş yol ilk kullanımda seçilir
+static void select_impl() {
+#if defined(__x86_64__)
+    memdiff_run = __builtin_cpu_supports("avx2") ? memdiff_avx2 : memdiff_sse2;
+#else
+    memdiff_run = memdiff_word;
+#endif
+}
+
+size_t memdiff(const void* a, const void* b, size_t length) {
+    pthread_once(&impl_once, select_impl);
+    return memdiff_run(a, b, length);
+}
+
+const char* memdiff_impl() {
+    pthread_once(&impl_once, select_impl);
+#if defined(__x86_64__)
+    if (memdiff_run == memdiff_avx2) return "avx2";
+    return "sse2";
+#else
+    return "word";
+#endif
+}
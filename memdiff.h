@@ -0,0 +1,14 @@
+#ifndef MEMDIFF_H
+#define MEMDIFF_H
+
+#include <stddef.h>
+
+// İki bellek bölgesinde ilk farklı baytın konumu; bölgeler aynıysa length döner.
+// x86-64'te işlemci destekliyorsa AVX2, aksi halde SSE2 ile 16/32 baytlık bloklar
+// karşılaştırılır; diğer mimarilerde 8 baytlık kelimeler kullanılır.
+size_t memdiff(const void* a, const void* b, size_t length);
+
+// Seçilen karşılaştırma yolunun adı ("avx2", "sse2" ya da "word")
+const char* memdiff_impl();
+
+#endif
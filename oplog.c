@@ -0,0 +1,385 @@
+#include "oplog.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(LogEntry) == 104, "LogEntry boyutu disk bicimiyle uyumlu olmali");
+
+static const char* op_names[LOG_OP_COUNT] = {
+    [LOG_OP_CREATE] = "DOSYA_OLUSTURULDU",
+    [LOG_OP_DELETE] = "DOSYA_SILINDI",
+    [LOG_OP_WRITE] = "DOSYAYA_VERI_YAZILDI",
+    [LOG_OP_READ] = "DOSYADAN_VERI_OKUNDU",
+    [LOG_OP_LIST] = "DOSYALAR_LISTELENDI",
+    [LOG_OP_FORMAT] = "DISK_FORMATLANDI",
+    [LOG_OP_RENAME] = "DOSYA_ISMI_DEGISTIRILDI",
+    [LOG_OP_SIZE] = "DOSYA_BOYUTU_GOSTERILDI",
+    [LOG_OP_APPEND] = "DOSYAYA_VERI_EKLENDI",
+    [LOG_OP_TRUNCATE] = "DOSYA_KIRPILDI",
+    [LOG_OP_COPY] = "DOSYA_KOPYALANDI",
+    [LOG_OP_MOVE] = "DOSYA_TASINDI",
+    [LOG_OP_DIFF] = "DOSYALAR_KARSILASTIRILDI",
+    [LOG_OP_DEFRAG] = "DISK_BIRLESTIRILDI",
+    [LOG_OP_DEFRAG_BACKGROUND] = "DISK_ARKA_PLANDA_BIRLESTIRILDI",
+    [LOG_OP_BACKUP] = "DISK_YEDEKLENDI",
+    [LOG_OP_BACKUP_INCREMENTAL] = "DISK_ARTIMLI_YEDEKLENDI",
+    [LOG_OP_RESTORE] = "DISK_GERI_YUKLENDI",
+    [LOG_OP_EXIT] = "CIKIS_YAPILDI",
+    [LOG_OP_IMPORT] = "HOST_DOSYASI_ICE_AKTARILDI",
+    [LOG_OP_EXPORT] = "DOSYA_HOSTA_AKTARILDI",
+    [LOG_OP_MKDIR] = "DIZIN_OLUSTURULDU",
+    [LOG_OP_RMDIR] = "DIZIN_SILINDI",
+};
+
+// Halka tampon: [ring_tail, ring_head) aralığındaki kayıtlar yazılmayı bekler. Yazıcı bir
+// grubu kilidi bırakarak yazarken üreticiler yalnızca boş yuvalara yazar; tampon dolarsa
+// yer açılana kadar beklerler (kayıt kaybolmaz).
+static LogEntry ring[LOG_RING_SLOTS];
+static uint64_t ring_head = 0;
+static uint64_t ring_tail = 0;
+static uint64_t flush_target = 0; // Bu sıraya kadar olan kayıtlar hemen yazılmalı
+
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_wakeup = PTHREAD_COND_INITIALIZER; // Yazıcıyı uyandırır
+static pthread_cond_t log_written = PTHREAD_COND_INITIALIZER; // Bir grup yazıldı
+static pthread_t log_thread;
+static bool log_running = false;
+static bool log_stopping = false;
+static struct timespec pending_since; // İlk bekleyen kaydın eklendiği an (aralıklı yazmada)
+
+static int flush_policy = DEFAULT_LOG_FLUSH_POLICY;
+static int flush_interval_ms = DEFAULT_LOG_FLUSH_INTERVAL_MS;
+
+// Yalnızca yazıcı iş parçacığı kullanır
+static int log_fd = -1;
+static off_t log_size = 0;
+
+uint64_t log_clock() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+const char* log_op_name(int op) { return op > 0 && op < LOG_OP_COUNT && op_names[op] ? op_names[op] : "BILINMEYEN_ISLEM"; }
+
+int log_op_from_name(const char* name) {
+    char* end;
+    long code = strtol(name, &end, 10);
+    if (*name != '\0' && *end == '\0') return code > 0 && code < LOG_OP_COUNT ? (int) code : -1;
+    for (int op = 1; op < LOG_OP_COUNT; op++) {
+        if (strcmp(op_names[op], name) == 0) return op;
+    }
+    return -1;
+}
+
+void log_file_paths(char paths[][64]) {
+    for (int k = LOG_ROTATE_KEEP; k >= 1; k--) snprintf(paths[LOG_ROTATE_KEEP - k], 64, "%s.%d", LOG_FILE, k);
+    snprintf(paths[LOG_ROTATE_KEEP], 64, "%s", LOG_FILE);
+}
+
+static void copy_name(char* dest, const char* src) {
+    size_t length = src ? strnlen(src, FILENAME_LEN - 1) : 0;
+    memcpy(dest, src ? src : "", length);
+    memset(dest + length, 0, FILENAME_LEN - length);
+}
+
+// Bekleyen kayıtlar politikaya göre şimdi yazılmalı mı (log_mutex tutulurken)
+static bool flush_due() {
+    if (log_stopping || flush_target > ring_tail || flush_policy == LOG_FLUSH_PER_OP) return true;
+    // Tampon yarıdan fazla doluysa üreticiler beklemeden yazılır
+    if (ring_head - ring_tail >= LOG_RING_SLOTS / 2) return true;
+    if (flush_policy != LOG_FLUSH_INTERVAL) return false;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long elapsed_ms = (now.tv_sec - pending_since.tv_sec) * 1000 + (now.tv_nsec - pending_since.tv_nsec) / 1000000;
+    return elapsed_ms >= flush_interval_ms;
+}
+
+static int write_all(int fd, const void* data, size_t size) {
+    for (size_t done = 0; done < size;) {
+        ssize_t n = write(fd, (const char*) data + done, size - done);
+        if (n <= 0) return -1;
+        done += n;
+    }
+    return 0;
+}
+
+// Günlük dosyasını yazma için aç; yeni dosyaya başlık yazılır. Başlığı olmayan (eski
+// metin biçimindeki) dosya LOG_LEGACY_FILE adıyla kenara alınır.
+static int open_log_file() {
+    log_fd = open(LOG_FILE, O_RDWR | O_CREAT | O_APPEND, 0666);
+    if (log_fd < 0) return -1;
+
+    struct stat st;
+    LogFileHeader header;
+    if (fstat(log_fd, &st) != 0) return -1;
+    if (st.st_size > 0) {
+        if (pread(log_fd, &header, sizeof(header), 0) == sizeof(header) && header.magic == LOG_MAGIC &&
+            header.version == LOG_VERSION && header.entry_size == sizeof(LogEntry)) {
+            // Yarım kalmış son kayıt atılır; yeni kayıtlar kayıt sınırından başlar
+            off_t whole = sizeof(header) + (st.st_size - sizeof(header)) / sizeof(LogEntry) * sizeof(LogEntry);
+            if (whole != st.st_size && ftruncate(log_fd, whole) != 0) return -1;
+            log_size = whole;
+            return 0;
+        }
+        close(log_fd);
+        rename(LOG_FILE, LOG_LEGACY_FILE);
+        write(STDOUT_FILENO, "Eski metin log dosyasi disk.log.txt olarak saklandi.\n", 53);
+        log_fd = open(LOG_FILE, O_RDWR | O_CREAT | O_APPEND | O_TRUNC, 0666);
+        if (log_fd < 0) return -1;
+    }
+
+    header = (LogFileHeader) {.magic = LOG_MAGIC, .version = LOG_VERSION, .entry_size = sizeof(LogEntry)};
+    if (write_all(log_fd, &header, sizeof(header)) < 0) return -1;
+    log_size = sizeof(header);
+    return 0;
+}
+
+// disk.log dosyasını disk.log.1'e, eskileri bir sonrakine kaydır (en eskisi silinir)
+static void rotate_logs() {
+    char from[64], to[64];
+    close(log_fd);
+    for (int k = LOG_ROTATE_KEEP - 1; k >= 1; k--) {
+        snprintf(from, sizeof(from), "%s.%d", LOG_FILE, k);
+        snprintf(to, sizeof(to), "%s.%d", LOG_FILE, k + 1);
+        rename(from, to);
+    }
+    snprintf(to, sizeof(to), "%s.1", LOG_FILE);
+    rename(LOG_FILE, to);
+    if (open_log_file() < 0 && log_fd >= 0) {
+        close(log_fd);
+        log_fd = -1;
+    }
+}
+
+// [first, last) aralığındaki kayıtları tek write ile dosyaya ekle (halka başa sarıyorsa iki)
+static void write_batch(uint64_t first, uint64_t last) {
+    off_t length = (off_t) (last - first) * sizeof(LogEntry);
+    if (log_size > (off_t) sizeof(LogFileHeader) && log_size + length > LOG_MAX_SIZE) rotate_logs();
+    if (log_fd < 0) return;
+
+    uint64_t start = first % LOG_RING_SLOTS;
+    uint64_t count = last - first;
+    uint64_t until_end = LOG_RING_SLOTS - start < count ? LOG_RING_SLOTS - start : count;
+    if (write_all(log_fd, &ring[start], until_end * sizeof(LogEntry)) < 0 ||
+        (count > until_end && write_all(log_fd, &ring[0], (count - until_end) * sizeof(LogEntry)) < 0)) {
+        return;
+    }
+    log_size += length;
+}
+
+static void* log_writer(void* arg) {
+    (void) arg;
+    pthread_mutex_lock(&log_mutex);
+    for (;;) {
+        while (ring_tail == ring_head ? !log_stopping : !flush_due()) {
+            if (ring_tail != ring_head && flush_policy == LOG_FLUSH_INTERVAL) {
+                // İlk bekleyen kaydın üzerinden aralık dolunca yazılır (CLOCK_MONOTONIC'ten çevrilir)
+                struct timespec now, deadline;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                long remaining_ns = (long) flush_interval_ms * 1000000 - ((now.tv_sec - pending_since.tv_sec) * 1000000000L +
+                                                                          (now.tv_nsec - pending_since.tv_nsec));
+                if (remaining_ns <= 0) break;
+                deadline.tv_sec += remaining_ns / 1000000000L;
+                deadline.tv_nsec += remaining_ns % 1000000000L;
+                if (deadline.tv_nsec >= 1000000000L) {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000L;
+                }
+                pthread_cond_timedwait(&log_wakeup, &log_mutex, &deadline);
+            } else {
+                pthread_cond_wait(&log_wakeup, &log_mutex);
+            }
+        }
+        if (ring_tail == ring_head) break; // Durduruluyor ve yazılacak kayıt kalmadı
+
+        uint64_t first = ring_tail, last = ring_head;
+        pthread_mutex_unlock(&log_mutex);
+        write_batch(first, last);
+        pthread_mutex_lock(&log_mutex);
+
+        ring_tail = last;
+        clock_gettime(CLOCK_MONOTONIC, &pending_since);
+        pthread_cond_broadcast(&log_written);
+    }
+    pthread_mutex_unlock(&log_mutex);
+    return NULL;
+}
+
+bool log_init() {
+    pthread_mutex_lock(&log_mutex);
+    if (log_running) {
+        pthread_mutex_unlock(&log_mutex);
+        return true;
+    }
+
+    if (open_log_file() < 0) {
+        if (log_fd >= 0) close(log_fd);
+        log_fd = -1;
+        pthread_mutex_unlock(&log_mutex);
+        write(STDOUT_FILENO, "Log dosyasi acilamadi veya olusturulamadi\n", 42);
+        return false;
+    }
+
+    log_stopping = false;
+    if (pthread_create(&log_thread, NULL, log_writer, NULL) != 0) {
+        close(log_fd);
+        log_fd = -1;
+        pthread_mutex_unlock(&log_mutex);
+        write(STDOUT_FILENO, "Log yazicisi baslatilamadi\n", 27);
+        return false;
+    }
+    log_running = true;
+    pthread_mutex_unlock(&log_mutex);
+
+    // Program nasıl biterse bitsin tampondaki kayıtlar yazılır
+    static bool registered = false;
+    if (!registered) {
+        atexit(log_close);
+        registered = true;
+    }
+    return true;
+}
+
+void log_operation(int op, const char* name, const char* other, int64_t bytes, uint64_t started, int result) {
+    uint64_t now = log_clock();
+    time_t wall = time(NULL);
+    pthread_mutex_lock(&log_mutex);
+    if (!log_running || log_stopping) {
+        pthread_mutex_unlock(&log_mutex);
+        return;
+    }
+
+    // Tampon doluysa yazıcının yer açması beklenir
+    while (ring_head - ring_tail >= LOG_RING_SLOTS) {
+        if (flush_target < ring_head) flush_target = ring_head;
+        pthread_cond_signal(&log_wakeup);
+        pthread_cond_wait(&log_written, &log_mutex);
+    }
+
+    LogEntry* entry = &ring[ring_head % LOG_RING_SLOTS];
+    entry->op = op;
+    entry->reserved = 0;
+    entry->result = result;
+    entry->bytes = bytes;
+    entry->start_ns = started;
+    entry->duration_ns = now > started ? now - started : 0;
+    entry->time = wall - (int64_t) (entry->duration_ns / 1000000000ULL);
+    copy_name(entry->name, name);
+    copy_name(entry->other, other);
+    if (ring_head == ring_tail) clock_gettime(CLOCK_MONOTONIC, &pending_since);
+    uint64_t sequence = ++ring_head;
+
+    if (flush_policy == LOG_FLUSH_PER_OP) {
+        pthread_cond_signal(&log_wakeup);
+        while (ring_tail < sequence && log_running) pthread_cond_wait(&log_written, &log_mutex);
+    } else if (sequence - ring_tail == 1 || flush_due()) {
+        // Zamanlayıcıyı başlatmak ya da dolmaya yaklaşan tamponu boşaltmak için uyandırılır
+        pthread_cond_signal(&log_wakeup);
+    }
+    pthread_mutex_unlock(&log_mutex);
+}
+
+int log_set_flush_policy(int policy, int interval_ms) {
+    if (policy != LOG_FLUSH_PER_OP && policy != LOG_FLUSH_INTERVAL && policy != LOG_FLUSH_ON_EXIT) return -1;
+    pthread_mutex_lock(&log_mutex);
+    flush_policy = policy;
+    if (interval_ms > 0) flush_interval_ms = interval_ms;
+    pthread_cond_signal(&log_wakeup);
+    pthread_mutex_unlock(&log_mutex);
+    return 0;
+}
+
+void log_flush() {
+    pthread_mutex_lock(&log_mutex);
+    if (log_running) {
+        uint64_t target = ring_head;
+        if (flush_target < target) flush_target = target;
+        pthread_cond_signal(&log_wakeup);
+        while (ring_tail < target) pthread_cond_wait(&log_written, &log_mutex);
+    }
+    pthread_mutex_unlock(&log_mutex);
+}
+
+void log_close() {
+    pthread_mutex_lock(&log_mutex);
+    if (!log_running) {
+        pthread_mutex_unlock(&log_mutex);
+        return;
+    }
+    log_stopping = true;
+    pthread_cond_signal(&log_wakeup);
+    pthread_mutex_unlock(&log_mutex);
+
+    pthread_join(log_thread, NULL);
+
+    pthread_mutex_lock(&log_mutex);
+    log_running = false;
+    pthread_cond_broadcast(&log_written);
+    pthread_mutex_unlock(&log_mutex);
+    if (log_fd >= 0) close(log_fd);
+    log_fd = -1;
+}
+
+// Günlük dosyasını salt okunur eşle. Dosya yoksa ya da boşsa 0 kayıtlı görünüm döner;
+// başlığı geçersizse -1 döner. Yarım kalmış son kayıt sayılmaz.
+int log_open_view(const char* path, LogView* view) {
+    memset(view, 0, sizeof(*view));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    void* map = st.st_size >= (off_t) sizeof(LogFileHeader) ? mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const LogFileHeader* header = map;
+    if (header->magic != LOG_MAGIC || header->version != LOG_VERSION || header->entry_size != sizeof(LogEntry)) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+    // Kayıtlar baştan sona sırayla okunur
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    view->map = map;
+    view->size = st.st_size;
+    view->entries = (const LogEntry*) (header + 1);
+    view->count = (st.st_size - sizeof(LogFileHeader)) / sizeof(LogEntry);
+    return 0;
+}
+
+void log_close_view(LogView* view) {
+    if (view->map) munmap(view->map, view->size);
+    memset(view, 0, sizeof(*view));
+}
+
+// Kaydı eski metin günlüğüne benzer tek bir satır olarak biçimlendir:
+// [ZAMAN] ISLEM: DOSYA[ -> DIGER] (BAYT bytes, SURE us)[ HATA=SONUC]
+int log_format_entry(const LogEntry* entry, LogTimeCache* cache, char* out, int capacity) {
+    if (entry->time != cache->second) {
+        time_t seconds = entry->time;
+        struct tm time_info;
+        localtime_r(&seconds, &time_info);
+        strftime(cache->text, sizeof(cache->text), "%d-%m-%Y %H:%M:%S", &time_info);
+        cache->second = entry->time;
+    }
+
+    int n = snprintf(out, capacity, "[%s] %s", cache->text, log_op_name(entry->op));
+    if (entry->name[0] != '\0') n += snprintf(out + n, capacity - n, ": %.*s", FILENAME_LEN, entry->name);
+    if (entry->other[0] != '\0') n += snprintf(out + n, capacity - n, " -> %.*s", FILENAME_LEN, entry->other);
+    n += snprintf(out + n, capacity - n, " (%lld bytes, %.1f us)", (long long) entry->bytes, entry->duration_ns / 1000.0);
+    if (entry->result < 0) n += snprintf(out + n, capacity - n, " HATA=%d", entry->result);
+    n += snprintf(out + n, capacity - n, "\n");
+    return n;
+}
@@ -0,0 +1,113 @@
+#ifndef OPLOG_H
+#define OPLOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "fs.h"
+
+// İşlem günlüğü (disk.log). Dosya bir LogFileHeader ve ardından sabit boyutlu LogEntry
+// kayıtlarından oluşur; sabit boyut sayesinde okuyucular dosyayı belleğe eşleyip kayıtlara
+// doğrudan erişir. log_operation kaydı yalnızca bellekteki halka tampona koyar; dosyaya
+// yazma arka plandaki yazıcı iş parçacığında toplu olarak yapılır. Dosya LOG_MAX_SIZE'ı
+// aşınca disk.log.1, disk.log.2 ... adlarıyla döndürülür.
+#define LOG_MAGIC 0x474F4C53 // "SLOG"
+#define LOG_VERSION 1
+#define LOG_RING_SLOTS 1024
+#define LOG_MAX_SIZE (1024 * 1024)
+#define LOG_ROTATE_KEEP 3 // Saklanan eski günlük dosyası sayısı
+#define LOG_LEGACY_FILE LOG_FILE ".txt" // Eski metin biçimindeki günlük buraya taşınır
+
+// Yazma politikası: her işlemden sonra (çağıran kayıt yazılana kadar bekler), belirli
+// aralıklarla ya da yalnızca tampon dolunca, fs_log'da ve çıkışta
+#define LOG_FLUSH_PER_OP 0
+#define LOG_FLUSH_INTERVAL 1
+#define LOG_FLUSH_ON_EXIT 2
+
+#ifndef DEFAULT_LOG_FLUSH_POLICY
+#define DEFAULT_LOG_FLUSH_POLICY LOG_FLUSH_INTERVAL
+#endif
+#ifndef DEFAULT_LOG_FLUSH_INTERVAL_MS
+#define DEFAULT_LOG_FLUSH_INTERVAL_MS 200
+#endif
+
+// İşlem kodları; log_op_name ile gösterimdeki adlarına çevrilir
+enum {
+    LOG_OP_CREATE = 1,
+    LOG_OP_DELETE,
+    LOG_OP_WRITE,
+    LOG_OP_READ,
+    LOG_OP_LIST,
+    LOG_OP_FORMAT,
+    LOG_OP_RENAME,
+    LOG_OP_SIZE,
+    LOG_OP_APPEND,
+    LOG_OP_TRUNCATE,
+    LOG_OP_COPY,
+    LOG_OP_MOVE,
+    LOG_OP_DIFF,
+    LOG_OP_DEFRAG,
+    LOG_OP_DEFRAG_BACKGROUND,
+    LOG_OP_BACKUP,
+    LOG_OP_BACKUP_INCREMENTAL,
+    LOG_OP_RESTORE,
+    LOG_OP_EXIT,
+    LOG_OP_IMPORT,
+    LOG_OP_EXPORT,
+    LOG_OP_MKDIR,
+    LOG_OP_RMDIR,
+    LOG_OP_COUNT
+};
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_size; // sizeof(LogEntry)
+    uint32_t reserved;
+} LogFileHeader;
+
+typedef struct {
+    uint16_t op;
+    uint16_t reserved;
+    int32_t result;       // İşlemin dönüş değeri (negatif = başarısız)
+    int64_t bytes;        // İşlenen bayt sayısı (yoksa 0)
+    int64_t time;         // Başlangıcın duvar saati (Unix saniyesi), gösterim için
+    uint64_t start_ns;    // Başlangıç (CLOCK_MONOTONIC)
+    uint64_t duration_ns;
+    char name[FILENAME_LEN];
+    char other[FILENAME_LEN]; // İkinci dosya (kopyalama, taşıma, karşılaştırma, yeniden adlandırma)
+} LogEntry;
+
+// Belleğe eşlenmiş bir günlük dosyası
+typedef struct {
+    void* map;
+    size_t size;
+    const LogEntry* entries;
+    uint64_t count;
+} LogView;
+
+// Zaman damgası biçimlendirmesi saniyede bir yapılır
+typedef struct {
+    int64_t second;
+    char text[32];
+} LogTimeCache;
+
+bool log_init();
+// İşlemi logla. 'started' log_clock() ile işlemden önce alınır; süre buradan hesaplanır.
+void log_operation(int op, const char* name, const char* other, int64_t bytes, uint64_t started, int result);
+uint64_t log_clock();
+int log_set_flush_policy(int policy, int interval_ms);
+// Tampondaki tüm kayıtları dosyaya yaz ve bitmesini bekle
+void log_flush();
+// Kalan kayıtları yaz, yazıcıyı durdur ve dosyayı kapat (çıkışta otomatik çağrılır)
+void log_close();
+
+const char* log_op_name(int op);
+int log_op_from_name(const char* name); // Ad ya da sayı kabul eder; bilinmiyorsa -1
+// Günlük dosyalarının adları, en eskisinden en yenisine (path_count = LOG_ROTATE_KEEP + 1)
+void log_file_paths(char paths[][64]);
+int log_open_view(const char* path, LogView* view);
+void log_close_view(LogView* view);
+int log_format_entry(const LogEntry* entry, LogTimeCache* cache, char* out, int capacity);
+
+#endif
@@ -0,0 +1,272 @@
+#define _GNU_SOURCE // mkdtemp için
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "fs.h"
+
+// Eşzamanlı okuyucu/yazıcı dayanıklılık testi. Yazıcılar kendilerine ait dosyaların
+// tamamını nesil numarasıyla türetilen bir desenle yeniden yazar, ayrıca geçici dosyalar
+// oluşturup silerek metadatayı değiştirir. Okuyucular tüm dosyaları okuyup her okumanın
+// tek bir neslin eksiksiz deseni olduğunu doğrular. Aynı test artan okuyucu sayılarıyla
+// tekrarlanır ve okuma hızının ölçeklenmesi raporlanır. Her turdan sonra bütünlük denetimi
+// yapılır ve dosyaların son nesilleri kontrol edilir. Bozuk veri görülürse 1 ile çıkar.
+// Test geçici bir dizinde yapılır; çalışma dizinindeki disk.sim'e dokunulmaz.
+//
+//   fsstress [-t EN_FAZLA_OKUYUCU] [-w YAZICI] [-n DOSYA] [-z BOYUT] [-s SANIYE]
+
+#define DEFAULT_MAX_READERS 8
+#define DEFAULT_WRITERS 2
+#define DEFAULT_FILES 16
+#define DEFAULT_FILE_SIZE 65536
+#define DEFAULT_SECONDS 2
+
+typedef struct {
+    int files;
+    int size;
+    int writers;
+    atomic_bool stop;
+    atomic_ullong reads;
+    atomic_ullong read_bytes;
+    atomic_ullong writes;
+    atomic_ullong errors;
+    atomic_uint* generations; // Her dosyanın son tamamlanan yazısının nesli
+} StressState;
+
+typedef struct {
+    StressState* state;
+    int id;
+} Worker;
+
+static void file_name(char* out, int index) { snprintf(out, FILENAME_LEN, "s%d", index); }
+
+// Deseni üret: ilk 4 bayt nesil, kalanı dosya ve nesilden türetilen baytlar
+static void fill_pattern(char* buffer, int size, int file, uint32_t generation) {
+    memcpy(buffer, &generation, sizeof(generation));
+    uint32_t x = (uint32_t) file * 2654435761u ^ generation * 40503u;
+    for (int i = sizeof(generation); i < size; i++) {
+        x = x * 1103515245u + 12345u;
+        buffer[i] = (char) (x >> 16);
+    }
+}
+
+// Okunan içerik tek bir neslin eksiksiz deseni mi; öyleyse nesli döner (-1 = bozuk)
+static int64_t check_pattern(const char* data, char* expected, int size, int file) {
+    uint32_t generation;
+    memcpy(&generation, data, sizeof(generation));
+    fill_pattern(expected, size, file, generation);
+    return memcmp(data, expected, size) == 0 ? (int64_t) generation : -1;
+}
+
+static void* writer_main(void* arg) {
+    Worker* worker = arg;
+    StressState* state = worker->state;
+    char* buffer = malloc(state->size);
+    char name[FILENAME_LEN];
+    char scratch[FILENAME_LEN];
+    snprintf(scratch, sizeof(scratch), "tmp%d", worker->id);
+
+    for (uint64_t round = 0; buffer && !atomic_load(&state->stop); round++) {
+        // Her yazıcı yalnızca kendi dosyalarını (file % writers == id) yazar
+        for (int file = worker->id; file < state->files && !atomic_load(&state->stop); file += state->writers) {
+            uint32_t generation = atomic_load(&state->generations[file]) + 1;
+            fill_pattern(buffer, state->size, file, generation);
+            file_name(name, file);
+            if (fs_write(name, buffer, state->size) < 0) {
+                atomic_fetch_add(&state->errors, 1);
+                continue;
+            }
+            atomic_store(&state->generations[file], generation);
+            atomic_fetch_add(&state->writes, 1);
+        }
+        if (round % 4 == 0 && (fs_create(scratch) < 0 || fs_write(scratch, buffer, 512) < 0 || fs_delete(scratch) < 0)) {
+            atomic_fetch_add(&state->errors, 1);
+        }
+    }
+    free(buffer);
+    return NULL;
+}
+
+static void* reader_main(void* arg) {
+    Worker* worker = arg;
+    StressState* state = worker->state;
+    char* data = malloc(state->size);
+    char* expected = malloc(state->size);
+    char name[FILENAME_LEN];
+
+    for (int file = worker->id % state->files; data && expected && !atomic_load(&state->stop); file = (file + 1) % state->files) {
+        // Okumadan önce görülen nesil, okunan neslin alt sınırıdır
+        uint32_t floor = atomic_load(&state->generations[file]);
+        file_name(name, file);
+        int64_t generation = fs_read(name, 0, state->size, data) == state->size ? check_pattern(data, expected, state->size, file) : -1;
+        if (generation < 0 || (uint32_t) generation < floor) {
+            atomic_fetch_add(&state->errors, 1);
+            fprintf(stderr, "Bozuk okuma: %s (nesil %lld, en az %u bekleniyordu)\n", name, (long long) generation, floor);
+            continue;
+        }
+        atomic_fetch_add(&state->reads, 1);
+        atomic_fetch_add(&state->read_bytes, state->size);
+    }
+    free(data);
+    free(expected);
+    return NULL;
+}
+
+// Dosyaları ilk nesilleriyle oluştur
+static int prepare_files(StressState* state) {
+    if (fs_format_ex(state->files + state->writers + 16) < 0) return -1;
+    char* buffer = malloc(state->size);
+    if (!buffer) return -1;
+    char name[FILENAME_LEN];
+    int result = 0;
+    for (int file = 0; file < state->files && result == 0; file++) {
+        file_name(name, file);
+        fill_pattern(buffer, state->size, file, 0);
+        atomic_store(&state->generations[file], 0);
+        if (fs_create(name) < 0 || fs_write(name, buffer, state->size) < 0) result = -1;
+    }
+    free(buffer);
+    return result < 0 ? -1 : fs_sync();
+}
+
+// Son nesiller diskte olmalı ve disk bütün olmalı
+static int verify_files(StressState* state) {
+    char* data = malloc(state->size);
+    char* expected = malloc(state->size);
+    char name[FILENAME_LEN];
+    int errors = 0;
+    for (int file = 0; file < state->files && data && expected; file++) {
+        file_name(name, file);
+        int64_t generation = fs_read(name, 0, state->size, data) == state->size ? check_pattern(data, expected, state->size, file) : -1;
+        if (generation != (int64_t) atomic_load(&state->generations[file])) {
+            fprintf(stderr, "Son nesil uyusmuyor: %s\n", name);
+            errors++;
+        }
+    }
+    free(data);
+    free(expected);
+    if (fs_check_integrity() != 0) errors++;
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    int max_readers = DEFAULT_MAX_READERS;
+    int seconds = DEFAULT_SECONDS;
+    StressState state = {.files = DEFAULT_FILES, .size = DEFAULT_FILE_SIZE, .writers = DEFAULT_WRITERS};
+
+    int opt;
+    while ((opt = getopt(argc, argv, "t:w:n:z:s:h")) != -1) {
+        switch (opt) {
+            case 't':
+                max_readers = atoi(optarg);
+                break;
+            case 'w':
+                state.writers = atoi(optarg);
+                break;
+            case 'n':
+                state.files = atoi(optarg);
+                break;
+            case 'z':
+                state.size = atoi(optarg);
+                break;
+            case 's':
+                seconds = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Kullanim: fsstress [-t EN_FAZLA_OKUYUCU] [-w YAZICI] [-n DOSYA] [-z BOYUT] [-s SANIYE]\n");
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (max_readers <= 0 || state.writers < 0 || state.files <= 0 || state.size < 8 || seconds <= 0) {
+        fprintf(stderr, "Gecersiz arguman.\n");
+        return 1;
+    }
+
+    char directory[] = "/tmp/simplefs-stress-XXXXXX";
+    if (!mkdtemp(directory) || chdir(directory) != 0) {
+        fprintf(stderr, "Gecici dizin olusturulamadi.\n");
+        return 1;
+    }
+
+    // Dosya sisteminin mesajları sonuç tablosunu bozmasın diye stdout kapatılır
+    int saved_stdout = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+    FILE* out = fdopen(saved_stdout, "w");
+
+    state.generations = calloc(state.files, sizeof(atomic_uint));
+    uint64_t needed = (uint64_t) (state.files + state.writers) * state.size * 4;
+    if (!out || !state.generations || !fs_init() || fs_format_geometry(0, needed > (64ULL << 20) ? needed : (64ULL << 20), 4096) < 0) {
+        fprintf(stderr, "Disk baslatilamadi.\n");
+        return 1;
+    }
+
+    fprintf(out, "okuyucu  yazici  okuma/sn   MB/sn     yazma/sn  olcek\n");
+    double base_rate = 0;
+    int failures = 0;
+    for (int readers = 1; readers <= max_readers; readers *= 2) {
+        if (prepare_files(&state) < 0) {
+            fprintf(stderr, "Dosyalar hazirlanamadi.\n");
+            failures++;
+            break;
+        }
+        atomic_store(&state.stop, false);
+        atomic_store(&state.reads, 0);
+        atomic_store(&state.read_bytes, 0);
+        atomic_store(&state.writes, 0);
+        atomic_store(&state.errors, 0);
+
+        int count = readers + state.writers;
+        pthread_t* threads = malloc(count * sizeof(pthread_t));
+        Worker* workers = malloc(count * sizeof(Worker));
+        struct timespec started, finished;
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        int running = 0;
+        for (int k = 0; threads && workers && k < count; k++) {
+            workers[k].state = &state;
+            workers[k].id = k < state.writers ? k : k - state.writers;
+            if (pthread_create(&threads[k], NULL, k < state.writers ? writer_main : reader_main, &workers[k]) != 0) break;
+            running++;
+        }
+        sleep(seconds);
+        atomic_store(&state.stop, true);
+        for (int k = 0; k < running; k++) pthread_join(threads[k], NULL);
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+        free(threads);
+        free(workers);
+
+        double elapsed = (finished.tv_sec - started.tv_sec) + (finished.tv_nsec - started.tv_nsec) / 1e9;
+        double rate = atomic_load(&state.reads) / elapsed;
+        if (readers == 1) base_rate = rate;
+        fprintf(out, "%-8d  %-6d  %-9.0f  %-8.1f  %-8.0f  %.2fx\n", readers, state.writers, rate,
+                atomic_load(&state.read_bytes) / elapsed / (1024 * 1024), atomic_load(&state.writes) / elapsed,
+                base_rate > 0 ? rate / base_rate : 0.0);
+        fflush(out);
+
+        int errors = (int) atomic_load(&state.errors) + verify_files(&state);
+        if (running != count) {
+            fprintf(stderr, "Is parcaciklari baslatilamadi.\n");
+            errors++;
+        }
+        if (errors > 0) {
+            fprintf(stderr, "%d okuyucu ile %d hata.\n", readers, errors);
+            failures++;
+        }
+    }
+
+    fs_close();
+    free(state.generations);
+    unlink("disk.sim");
+    unlink("disk.sim.changes");
+    rmdir(directory);
+    fprintf(out, failures ? "BASARISIZ\n" : "TAMAM\n");
+    fclose(out);
+    return failures > 0;
+}